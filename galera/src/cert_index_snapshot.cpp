@@ -0,0 +1,233 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+#include "cert_index_snapshot.hpp"
+
+#include "gu_digest.hpp"
+#include "gu_serialize.hpp"
+#include "gu_throw.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <unistd.h>
+
+static const char     SNAPSHOT_MAGIC[] = "GCERTIDX";
+static size_t const   MAGIC_SIZE       = sizeof(SNAPSHOT_MAGIC) - 1;
+static uint32_t const FORMAT_VERSION   = 1;
+
+/* magic, format version, cert version, GTID, lowest seqno, record count */
+static size_t const HEADER_SIZE = MAGIC_SIZE + 4 + 4 +
+    gu::GTID::serial_size() + 8 + 8;
+/* header followed by checksum */
+static size_t const PREAMBLE_SIZE = HEADER_SIZE + 8;
+/* seqno, write set size */
+static size_t const RECORD_HEADER_SIZE = 8 + 8;
+
+static inline size_t
+padded(size_t const size)
+{
+    return ((size + 7) & ~size_t(7));
+}
+
+static void
+write_buf(FILE* const file, const std::string& name,
+          const void* const buf, size_t const size)
+{
+    if (size > 0 && fwrite(buf, size, 1, file) != 1)
+    {
+        gu_throw_error(errno) << "Failed to write " << size << " bytes to '"
+                              << name << '\'';
+    }
+}
+
+void
+galera::CertIndexSnapshot::write(const std::string& file_name,
+                                 const gu::GTID&    gtid,
+                                 wsrep_seqno_t const lowest,
+                                 int const          version,
+                                 const Records&     records)
+{
+    gu::byte_t header[PREAMBLE_SIZE];
+    size_t off(0);
+
+    ::memcpy(header, SNAPSHOT_MAGIC, MAGIC_SIZE);
+    off += MAGIC_SIZE;
+    off = gu::serialize4(FORMAT_VERSION, header, off);
+    off = gu::serialize4(uint32_t(version), header, off);
+    off = gtid.serialize(header, off);
+    off = gu::serialize8(int64_t(lowest), header, off);
+    off = gu::serialize8(uint64_t(records.size()), header, off);
+    assert(HEADER_SIZE == off);
+
+    static gu::byte_t const pad[8] = { 0, };
+    gu::byte_t rec_header[RECORD_HEADER_SIZE];
+
+    /* checksum has to be placed in front of the records, so calculate it
+     * in a separate pass: the buffers are in memory anyways. */
+    gu::MMH3 cs;
+    cs.append(header, HEADER_SIZE);
+    for (Records::const_iterator r(records.begin()); r != records.end(); ++r)
+    {
+        size_t o(gu::serialize8(int64_t(r->seqno), rec_header, 0));
+        gu::serialize8(uint64_t(r->size), rec_header, o);
+        cs.append(rec_header, sizeof(rec_header));
+        if (r->size > 0) cs.append(r->ptr, r->size);
+        cs.append(pad, padded(r->size) - r->size);
+    }
+    gu::serialize8(cs.gather8(), header, HEADER_SIZE);
+
+    std::string const tmp(file_name + ".tmp");
+    FILE* const file(fopen(tmp.c_str(), "w"));
+
+    if (!file)
+    {
+        gu_throw_error(errno) << "Failed to open '" << tmp << "' for writing";
+    }
+
+    try
+    {
+        write_buf(file, tmp, header, sizeof(header));
+
+        for (Records::const_iterator r(records.begin()); r != records.end();
+             ++r)
+        {
+            size_t o(gu::serialize8(int64_t(r->seqno), rec_header, 0));
+            gu::serialize8(uint64_t(r->size), rec_header, o);
+            write_buf(file, tmp, rec_header, sizeof(rec_header));
+            write_buf(file, tmp, r->ptr, r->size);
+            write_buf(file, tmp, pad, padded(r->size) - r->size);
+        }
+
+        if (fflush(file) != 0 || fsync(fileno(file)) != 0)
+        {
+            gu_throw_error(errno) << "Failed to sync '" << tmp << '\'';
+        }
+    }
+    catch (...)
+    {
+        fclose(file);
+        ::unlink(tmp.c_str());
+        throw;
+    }
+
+    if (fclose(file) != 0)
+    {
+        int const err(errno);
+        ::unlink(tmp.c_str());
+        gu_throw_error(err) << "Failed to close '" << tmp << '\'';
+    }
+
+    if (rename(tmp.c_str(), file_name.c_str()) != 0)
+    {
+        int const err(errno);
+        ::unlink(tmp.c_str());
+        gu_throw_error(err) << "Failed to rename '" << tmp << "' to '"
+                            << file_name << '\'';
+    }
+}
+
+galera::CertIndexSnapshot::CertIndexSnapshot(const std::string& file_name)
+    :
+    fd_     (file_name, false),
+    mmap_   (fd_, true),
+    gtid_   (),
+    lowest_ (WSREP_SEQNO_UNDEFINED),
+    version_(-1),
+    records_()
+{
+    const gu::byte_t* const buf(static_cast<const gu::byte_t*>(mmap_.ptr));
+    size_t const size(mmap_.size);
+
+    if (size < PREAMBLE_SIZE || ::memcmp(buf, SNAPSHOT_MAGIC, MAGIC_SIZE))
+    {
+        gu_throw_error(EINVAL) << "'" << file_name
+                               << "' is not a certification index snapshot";
+    }
+
+    uint32_t format;
+    uint32_t version;
+    int64_t  lowest;
+    uint64_t count;
+    uint64_t checksum;
+
+    size_t off(MAGIC_SIZE);
+    off = gu::unserialize4(buf, off, format);
+
+    if (format != FORMAT_VERSION)
+    {
+        gu_throw_error(EPROTO) << "Unsupported certification index snapshot "
+                               << "format " << format << " in '" << file_name
+                               << "', expected " << FORMAT_VERSION;
+    }
+
+    off = gu::unserialize4(buf, off, version);
+    off = gtid_.unserialize(buf, off);
+    off = gu::unserialize8(buf, off, lowest);
+    off = gu::unserialize8(buf, off, count);
+    assert(HEADER_SIZE == off);
+    off = gu::unserialize8(buf, off, checksum);
+
+    gu::MMH3 cs;
+    cs.append(buf, HEADER_SIZE);
+    cs.append(buf + PREAMBLE_SIZE, size - PREAMBLE_SIZE);
+
+    if (cs.gather8() != checksum)
+    {
+        gu_throw_error(EINVAL) << "Checksum mismatch in certification index "
+                               << "snapshot '" << file_name << '\'';
+    }
+
+    version_ = version;
+    lowest_  = lowest;
+
+    if (count > (size - off) / RECORD_HEADER_SIZE)
+    {
+        gu_throw_error(EINVAL) << "Bogus record count " << count << " in '"
+                               << file_name << '\'';
+    }
+
+    records_.reserve(count);
+
+    wsrep_seqno_t prev(lowest_ - 1);
+
+    for (uint64_t i(0); i < count; ++i)
+    {
+        Record r;
+        int64_t  seqno;
+        uint64_t rsize;
+
+        if (off + RECORD_HEADER_SIZE > size)
+        {
+            gu_throw_error(EINVAL) << "Truncated record " << i << " in '"
+                                   << file_name << '\'';
+        }
+
+        off = gu::unserialize8(buf, off, seqno);
+        off = gu::unserialize8(buf, off, rsize);
+
+        if (seqno != prev + 1 || seqno > gtid_.seqno() || rsize > size - off)
+        {
+            gu_throw_error(EINVAL) << "Bogus record " << i << " (seqno: "
+                                   << seqno << ", size: " << rsize << ") in '"
+                                   << file_name << '\'';
+        }
+
+        r.seqno = seqno;
+        r.ptr   = rsize ? buf + off : NULL;
+        r.size  = rsize;
+        records_.push_back(r);
+
+        prev = seqno;
+        off += std::min(padded(rsize), size - off);
+    }
+
+    if (off != size)
+    {
+        gu_throw_error(EINVAL) << "Trailing garbage in '" << file_name << '\'';
+    }
+}
@@ -0,0 +1,94 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+//!
+// @file cert_index_snapshot.hpp
+//
+// Certification index snapshot file.
+//
+// On graceful shutdown the write sets which make up certification index
+// are saved to a file next to grastate.dat, so that on restart the index
+// can be rebuilt locally instead of being preloaded through IST.
+//
+// File layout (all integers are little endian):
+//
+//   header:  8 bytes  magic "GCERTIDX"
+//            4 bytes  file format version
+//            4 bytes  certification (trx protocol) version
+//           24 bytes  GTID of the state the index corresponds to, its seqno
+//                     is the certification position
+//            8 bytes  lowest seqno covered by the index
+//            8 bytes  number of records
+//            8 bytes  checksum of the header fields above and the records
+//   records: 8 bytes  global seqno
+//            8 bytes  write set size, 0 for a failed, dummy or NBO trx
+//                     which is not in the index and only keeps its seqno
+//                     occupied in the trx map
+//            write set buffer padded to 8 bytes
+//
+// There is a record for every seqno from the lowest one on.
+//
+
+#ifndef GALERA_CERT_INDEX_SNAPSHOT_HPP
+#define GALERA_CERT_INDEX_SNAPSHOT_HPP
+
+#include "gu_gtid.hpp"
+#include "gu_fdesc.hpp"
+#include "gu_mmap.hpp"
+
+#include "wsrep_api.h"
+
+#include <string>
+#include <vector>
+
+namespace galera
+{
+    class CertIndexSnapshot
+    {
+    public:
+
+        struct Record
+        {
+            wsrep_seqno_t seqno;
+            const void*   ptr;
+            size_t        size;
+        };
+
+        typedef std::vector<Record> Records;
+
+        /* Writes snapshot of the index at gtid atomically: via temporary
+         * file which is synced and renamed to file_name. Records must
+         * cover every seqno starting from lowest. Throws on failure. */
+        static void write(const std::string& file_name,
+                          const gu::GTID&    gtid,
+                          wsrep_seqno_t      lowest,
+                          int                version,
+                          const Records&     records);
+
+        /* Maps the snapshot file into memory and validates its contents.
+         * Record buffers point to the mapped file and are valid for the
+         * lifetime of the object. Throws if the file is not a valid
+         * snapshot. */
+        explicit CertIndexSnapshot(const std::string& file_name);
+
+        const gu::GTID& gtid()    const { return gtid_;    }
+        wsrep_seqno_t   lowest()  const { return lowest_;  }
+        int             version() const { return version_; }
+        const Records&  records() const { return records_; }
+
+    private:
+
+        CertIndexSnapshot(const CertIndexSnapshot&);
+        CertIndexSnapshot& operator=(const CertIndexSnapshot&);
+
+        gu::FileDescriptor fd_;
+        gu::MMap           mmap_;
+        gu::GTID           gtid_;
+        wsrep_seqno_t      lowest_;
+        int                version_;
+        Records            records_;
+    };
+}
+
+#endif // GALERA_CERT_INDEX_SNAPSHOT_HPP
@@ -3,6 +3,7 @@
 //
 
 #include "certification.hpp"
+#include "cert_index_snapshot.hpp"
 
 #include "gu_lock.hpp"
 #include "gu_throw.hpp"
@@ -25,6 +26,14 @@ static std::string const CERT_PARAM_PREFIX("cert.");
 std::string const CERT_PARAM_LOG_CONFLICTS(CERT_PARAM_PREFIX + "log_conflicts");
 std::string const CERT_PARAM_OPTIMISTIC_PA(CERT_PARAM_PREFIX + "optimistic_pa");
 
+static std::string const CERT_PARAM_SNAPSHOT     (CERT_PARAM_PREFIX +
+                                                  "snapshot");
+static std::string const CERT_PARAM_EXPLICIT_DEPS(CERT_PARAM_PREFIX +
+                                                  "explicit_deps");
+static std::string const CERT_PARAM_HOTSPOTS     (CERT_PARAM_PREFIX +
+                                                  "hotspots");
+static std::string const CERT_PARAM_HOTSPOTS_DUMP(CERT_PARAM_PREFIX +
+                                                  "hotspots_dump");
 static std::string const CERT_PARAM_MAX_LENGTH   (CERT_PARAM_PREFIX +
                                                   "max_length");
 static std::string const CERT_PARAM_LENGTH_CHECK (CERT_PARAM_PREFIX +
@@ -32,6 +41,9 @@ static std::string const CERT_PARAM_LENGTH_CHECK (CERT_PARAM_PREFIX +
 
 static std::string const CERT_PARAM_LOG_CONFLICTS_DEFAULT("no");
 static std::string const CERT_PARAM_OPTIMISTIC_PA_DEFAULT("yes");
+static std::string const CERT_PARAM_EXPLICIT_DEPS_DEFAULT("no");
+static std::string const CERT_PARAM_SNAPSHOT_DEFAULT("no");
+static std::string const CERT_PARAM_HOTSPOTS_DEFAULT("0");
 
 /*** It is EXTREMELY important that these constants are the same on all nodes.
  *** Don't change them ever!!! ***/
@@ -44,12 +56,40 @@ galera::Certification::register_params(gu::Config& cnf)
     const int flags(gu::Config::Flag::type_bool);
     cnf.add(CERT_PARAM_LOG_CONFLICTS, CERT_PARAM_LOG_CONFLICTS_DEFAULT, flags);
     cnf.add(CERT_PARAM_OPTIMISTIC_PA, CERT_PARAM_OPTIMISTIC_PA_DEFAULT, flags);
+    cnf.add(CERT_PARAM_EXPLICIT_DEPS, CERT_PARAM_EXPLICIT_DEPS_DEFAULT, flags);
+    cnf.add(CERT_PARAM_SNAPSHOT, CERT_PARAM_SNAPSHOT_DEFAULT, flags);
+    cnf.add(CERT_PARAM_HOTSPOTS, CERT_PARAM_HOTSPOTS_DEFAULT,
+            gu::Config::Flag::type_integer);
+    /* a trigger to log current hot spots, has no value */
+    cnf.add(CERT_PARAM_HOTSPOTS_DUMP, gu::Config::Flag::hidden);
     /* The defaults below are deliberately not reflected in conf: people
      * should not know about these dangerous setting unless they read RTFM. */
     cnf.add(CERT_PARAM_MAX_LENGTH, gu::Config::Flag::hidden);
     cnf.add(CERT_PARAM_LENGTH_CHECK, gu::Config::Flag::hidden);
 }
 
+static size_t
+hotspots_size(const std::string& value)
+{
+    long long const max(galera::KeyHotspots::MAX_SIZE);
+    long long size(-1);
+
+    try
+    {
+        size = gu::Config::from_config<long long>(value);
+    }
+    catch (gu::NotFound&) {}
+
+    if (size < 0 || size > max)
+    {
+        gu_throw_error(EINVAL) << "Bad value '" << value << "' for '"
+                               << CERT_PARAM_HOTSPOTS << "': should be in "
+                               << "range [0, " << max << ']';
+    }
+
+    return size;
+}
+
 /* a function to get around unset defaults in ctor initialization list */
 static int
 max_length(const gu::Config& conf)
@@ -74,7 +114,7 @@ static void
 report_stale_entry(const galera::Certification::CertIndexNG::value_type& ke,
                    const galera::KeySetIn& key_set)
 {
-    std::cerr << "Found stale entry for key: " << ke->key() << "\n";
+    std::cerr << "Found stale entry for key: " << ke.key() << "\n";
     key_set.rewind();
     std::cerr << "Key set\n";
     for (long i = 0; i < key_set.count(); ++i)
@@ -99,7 +139,7 @@ check_purge_complete(const galera::Certification::CertIndexNG& cert_index,
         cert_index.begin(), cert_index.end(),
         [&key_set, ts]
         (const galera::Certification::CertIndexNG::value_type& ke) {
-            ke->for_each_ref([&ke, &key_set, ts](const TrxHandleSlave* ref) {
+            ke.for_each_ref([&ke, &key_set, ts](const TrxHandleSlave* ref) {
                 if (ts == ref)
                 {
                     report_stale_entry(ke, key_set);
@@ -118,15 +158,15 @@ static void purge_key_set(galera::Certification::CertIndexNG& cert_index,
     for (long i(0); i < count; ++i)
     {
         const galera::KeySet::KeyPart& kp(key_set.next());
-        galera::KeyEntryNG ke(kp);
-        galera::Certification::CertIndexNG::iterator ci(cert_index.find(&ke));
-        assert(ci != cert_index.end());
-        if (ci == cert_index.end())
+        if (kp.repeat()) continue; // was not referenced
+
+        galera::KeyEntryNG* const kep(cert_index.find(kp));
+        assert(kep != nullptr);
+        if (kep == nullptr)
         {
             log_warn << "Could not find key from index";
             continue;
         }
-        galera::KeyEntryNG* const kep(*ci);
         assert(kep->referenced() == true);
 
         wsrep_key_type_t const p(kp.wsrep_type(ts->version()));
@@ -136,8 +176,7 @@ static void purge_key_set(galera::Certification::CertIndexNG& cert_index,
             kep->unref(p, ts);
             if (kep->referenced() == false)
             {
-                cert_index.erase(ci);
-                delete kep;
+                cert_index.erase(kep);
             }
         }
     }
@@ -165,6 +204,8 @@ check_against(const galera::KeyEntryNG*   const found,
               wsrep_key_type_t            const key_type,
               galera::TrxHandleSlave*     const trx,
               bool                        const log_conflict,
+              galera::KeyHotspots*        const hotspots,
+              bool                        const explicit_deps,
               wsrep_seqno_t&                    depends_seqno)
 {
     enum CheckType
@@ -231,7 +272,28 @@ check_against(const galera::KeyEntryNG*   const found,
             }
             /* fall through */
         case DEPENDENCY:
-            depends_seqno = std::max(ref_trx->global_seqno(), depends_seqno);
+            if (explicit_deps && (REF_KEY_TYPE == WSREP_KEY_EXCLUSIVE ||
+                                  REF_KEY_TYPE == WSREP_KEY_UPDATE))
+            {
+                // All previous references to the key are dependencies of
+                // ref_trx, so it is enough to wait for ref_trx only.
+                // Shared and reference keys can have several references
+                // of which only the latest is known, so those still make
+                // trx to wait for everything preceding ref_trx.
+                trx->add_pa_dep(ref_trx->global_seqno());
+            }
+            else
+            {
+                depends_seqno = std::max(ref_trx->global_seqno(),
+                                         depends_seqno);
+            }
+
+            // Already certified trxs are being added to rebuilt index.
+            if (gu_unlikely(hotspots != 0 && trx->certified() == false))
+            {
+                hotspots->record(conflict ? galera::KeyHotspots::CONFLICT :
+                                 galera::KeyHotspots::DEPENDENCY, key);
+            }
             /* fall through */
         case NOTHING:;
         }
@@ -245,10 +307,12 @@ static inline bool
 certify_and_depend_v3to6(const galera::KeyEntryNG*   const found,
                          const galera::KeySet::KeyPart&    key,
                          galera::TrxHandleSlave*     const trx,
-                         bool                        const log_conflict)
+                         bool                        const log_conflict,
+                         galera::KeyHotspots*        const hotspots,
+                         bool                        const explicit_deps)
 {
     bool ret(false);
-    wsrep_seqno_t depends_seqno(trx->depends_seqno());
+    wsrep_seqno_t depends_seqno(trx->pa_barrier());
     wsrep_key_type_t const key_type(key.wsrep_type(trx->version()));
 
     /*
@@ -269,21 +333,24 @@ certify_and_depend_v3to6(const galera::KeyEntryNG*   const found,
      * step.
      */
     if (check_against<WSREP_KEY_EXCLUSIVE>
-        (found, key, key_type, trx, log_conflict, depends_seqno) ||
+        (found, key, key_type, trx, log_conflict, hotspots, explicit_deps,
+         depends_seqno) ||
         check_against<WSREP_KEY_UPDATE>
-        (found, key, key_type, trx, log_conflict, depends_seqno) ||
+        (found, key, key_type, trx, log_conflict, hotspots, explicit_deps,
+         depends_seqno) ||
         (key_type >= WSREP_KEY_UPDATE &&
          /* exclusive and update keys must be checked against shared */
          (check_against<WSREP_KEY_REFERENCE>
-          (found, key, key_type, trx, log_conflict, depends_seqno) ||
+          (found, key, key_type, trx, log_conflict, hotspots, explicit_deps,
+           depends_seqno) ||
           check_against<WSREP_KEY_SHARED>
-          (found, key, key_type, trx, log_conflict, depends_seqno))))
+          (found, key, key_type, trx, log_conflict, hotspots, explicit_deps,
+           depends_seqno))))
     {
         ret = true;
     }
 
-    if (depends_seqno > trx->depends_seqno())
-        trx->set_depends_seqno(depends_seqno);
+    trx->raise_pa_barrier(depends_seqno);
 
     return ret;
 }
@@ -293,23 +360,24 @@ static bool
 certify_v3to6(const galera::Certification::CertIndexNG& cert_index_ng,
               const galera::KeySet::KeyPart&      key,
               galera::TrxHandleSlave*     const   trx,
-              bool                        const   log_conflicts)
+              bool                        const   log_conflicts,
+              galera::KeyHotspots*        const   hotspots,
+              bool                        const   explicit_deps)
 {
-    galera::KeyEntryNG ke(key);
-    galera::Certification::CertIndexNG::const_iterator ci(cert_index_ng.find(&ke));
+    const galera::KeyEntryNG* const kep(cert_index_ng.find(key));
 
-    if (cert_index_ng.end() == ci)
+    if (kep == nullptr)
     {
         return false; // No match
     }
 
     cert_debug << "found existing entry";
 
-    galera::KeyEntryNG* const kep(*ci);
     // Note: For we skip certification for isolated trxs, only
     // cert index and key_list is populated.
     return (!trx->is_toi() &&
-            certify_and_depend_v3to6(kep, key, trx, log_conflicts));
+            certify_and_depend_v3to6(kep, key, trx, log_conflicts, hotspots,
+                                     explicit_deps));
 }
 
 // Add key to trx references for trx that passed certification.
@@ -326,17 +394,15 @@ static void do_ref_keys(galera::Certification::CertIndexNG& cert_index,
     for (long i(0); i < key_count; ++i)
     {
         const galera::KeySet::KeyPart& k(key_set.next());
-        galera::KeyEntryNG ke(k);
-        galera::Certification::CertIndexNG::const_iterator
-            ci(cert_index.find(&ke));
+        if (k.repeat()) continue; // referenced by the preceding equal part
 
-        if (ci == cert_index.end())
+        std::pair<galera::KeyEntryNG*, bool> const ret(cert_index.insert(k));
+
+        if (ret.second)
         {
-            galera::KeyEntryNG* const kep(new galera::KeyEntryNG(ke));
-            ci = cert_index.insert(kep).first;
             cert_debug << "created new entry";
         }
-        (*ci)->ref(k.wsrep_type(trx->version()), k, trx);
+        ret.first->ref(k.wsrep_type(trx->version()), k, trx);
     }
 }
 
@@ -354,6 +420,7 @@ galera::Certification::do_test_v3to6(TrxHandleSlave* trx)
     const KeySetIn& key_set(trx->write_set().keyset());
     long const      key_count(key_set.count());
     long            processed(0);
+    KeyHotspots* const hotspots(hotspots_.enabled() ? &hotspots_ : 0);
 
     key_set.rewind();
 
@@ -361,14 +428,17 @@ galera::Certification::do_test_v3to6(TrxHandleSlave* trx)
     {
         const KeySet::KeyPart& key(key_set.next());
 
-        if (certify_v3to6(cert_index_ng_, key, trx, log_conflicts_))
+        if (key.repeat()) continue; // certified with the preceding equal part
+
+        if (certify_v3to6(cert_index_ng_, key, trx, log_conflicts_, hotspots,
+                          explicit_deps_))
         {
-            trx->set_depends_seqno(std::max(trx->depends_seqno(), last_pa_unsafe_));
+            trx->raise_pa_barrier(last_pa_unsafe_);
             goto cert_fail;
         }
     }
 
-    trx->set_depends_seqno(std::max(trx->depends_seqno(), last_pa_unsafe_));
+    trx->raise_pa_barrier(last_pa_unsafe_);
 
     assert (key_count == processed);
     key_set.rewind();
@@ -410,7 +480,7 @@ trx_cert_version_match(int const trx_version, int const cert_version)
 }
 
 galera::Certification::TestResult
-galera::Certification::do_test(const TrxHandleSlavePtr& trx)
+galera::Certification::do_test(const TrxHandleSlavePtr& trx, Stats& stats)
 {
     assert(mutex_.owned());
     assert(trx->source_id() != WSREP_UUID_UNDEFINED);
@@ -454,7 +524,7 @@ galera::Certification::do_test(const TrxHandleSlavePtr& trx)
             trx->last_seen_seqno() > trx->depends_seqno())
             trx->set_depends_seqno(trx->last_seen_seqno());
 
-        wsrep_seqno_t const ds(trx_map_.begin()->first - 1);
+        wsrep_seqno_t const ds(trx_map_.index_begin() - 1);
         if (ds > trx->depends_seqno()) trx->set_depends_seqno(ds);
     }
 
@@ -477,11 +547,9 @@ galera::Certification::do_test(const TrxHandleSlavePtr& trx)
     if (res == TEST_OK)
     {
         ++trx_count_;
-        gu::Lock lock(stats_mutex_);
-        ++n_certified_;
-        deps_dist_ += (trx->global_seqno() - trx->depends_seqno());
-        cert_interval_ += (trx->global_seqno() - trx->last_seen_seqno() - 1);
-        index_size_ = cert_index_ng_.size();
+        ++stats.n_certified;
+        stats.deps_dist += (trx->global_seqno() - trx->depends_seqno());
+        stats.cert_interval += (trx->global_seqno() - trx->last_seen_seqno()-1);
     }
 
     // Additional NBO certification.
@@ -605,6 +673,8 @@ static void purge_key_set_nbo(galera::Certification::CertIndexNBO& cert_index,
     for (long i(0); i < count; ++i)
     {
         KeyEntryNG ke(key_set.next());
+        if (ke.key().repeat()) continue; // was not referenced
+
         std::pair<Certification::CertIndexNBO::iterator,
                   Certification::CertIndexNBO::iterator>
             ci_range(cert_index.equal_range(&ke));
@@ -754,6 +824,8 @@ do_ref_keys_nbo(galera::Certification::CertIndexNBO& index,
     for (long i(0); i < key_count; ++i)
     {
         const KeySet::KeyPart& key(key_set.next());
+        if (key.repeat()) continue; // referenced by the preceding equal part
+
         wsrep_key_type_t const type(key.wsrep_type(trx->version()));
         KeyEntryNG* kep (new KeyEntryNG(key));
         Certification::CertIndexNBO::iterator it;
@@ -917,21 +989,24 @@ galera::Certification::Certification(gu::Config&     conf,
     version_               (-1),
     conf_                  (conf),
     gcache_                (cache),
-    trx_map_               (),
+    trx_map_               (0),
+    purge_queue_           (),
     cert_index_ng_         (),
     nbo_map_               (),
     nbo_ctx_map_           (),
     nbo_index_             (),
     nbo_pool_              (sizeof(TrxHandleSlave)),
-    deps_set_              (),
+    deps_set_              (0),
     current_view_          (),
     service_thd_           (thd),
     mutex_                 (gu::get_mutex_key(gu::GU_MUTEX_KEY_CERTIFICATION)),
+    hotspots_              (hotspots_size(conf.get(CERT_PARAM_HOTSPOTS))),
     trx_size_warn_count_   (0),
     initial_position_      (-1),
     position_              (-1),
     nbo_position_          (-1),
     safe_to_discard_seqno_ (-1),
+    purge_release_seqno_   (-1),
     last_pa_unsafe_        (-1),
     last_preordered_seqno_ (position_),
     last_preordered_id_    (0),
@@ -948,12 +1023,16 @@ galera::Certification::Certification(gu::Config&     conf,
     max_length_check_      (length_check(conf)),
     inconsistent_          (false),
     log_conflicts_         (conf.get<bool>(CERT_PARAM_LOG_CONFLICTS)),
-    optimistic_pa_         (conf.get<bool>(CERT_PARAM_OPTIMISTIC_PA))
+    optimistic_pa_         (conf.get<bool>(CERT_PARAM_OPTIMISTIC_PA)),
+    explicit_deps_         (conf.get<bool>(CERT_PARAM_EXPLICIT_DEPS)),
+    snapshot_              (conf.get<bool>(CERT_PARAM_SNAPSHOT))
 {}
 
 
 galera::Certification::~Certification()
 {
+    if (service_thd_) service_thd_->cancel_purge_index();
+
     log_info << "cert index usage at exit "   << cert_index_ng_.size();
     log_info << "cert trx map usage at exit " << trx_map_.size();
     log_info << "deps set usage at exit "     << deps_set_.size();
@@ -968,8 +1047,9 @@ galera::Certification::~Certification()
 
     gu::Lock lock(mutex_);
 
+    purge_queued_all_();
     for_each(trx_map_.begin(), trx_map_.end(), PurgeAndDiscard(*this));
-    trx_map_.clear();
+    trx_map_.clear(position_ + 1);
     nbo_map_.clear();
     std::for_each(nbo_index_.begin(), nbo_index_.end(),
                   [](CertIndexNBO::value_type key_entry)
@@ -1017,6 +1097,7 @@ void galera::Certification::assign_initial_position(const gu::GTID& gtid,
     wsrep_seqno_t const seqno(gtid.seqno());
     gu::Lock lock(mutex_);
 
+    purge_queued_all_();
     std::for_each(trx_map_.begin(), trx_map_.end(), PurgeAndDiscard(*this));
 
     if (seqno >= position_)
@@ -1031,12 +1112,10 @@ void galera::Certification::assign_initial_position(const gu::GTID& gtid,
                      << seqno;
         }
 
-        std::for_each(cert_index_ng_.begin(), cert_index_ng_.end(),
-                      gu::DeleteObject());
         cert_index_ng_.clear();
     }
 
-    trx_map_.clear();
+    trx_map_.clear(seqno + 1);
     assert(cert_index_ng_.empty());
 
     if (service_thd_)
@@ -1076,9 +1155,10 @@ galera::Certification::adjust_position(const View&         view,
 
     if (version != version_)
     {
+        purge_queued_all_();
         std::for_each(trx_map_.begin(), trx_map_.end(), PurgeAndDiscard(*this));
-        assert(trx_map_.empty() || trx_map_.rbegin()->first + 1 == position_);
-        trx_map_.clear();
+        assert(trx_map_.empty() || trx_map_.index_end() == position_);
+        trx_map_.clear(gtid.seqno() + 1);
         assert(cert_index_ng_.empty());
         if (service_thd_)
         {
@@ -1107,13 +1187,13 @@ galera::Certification::adjust_position(const View&         view,
 }
 
 galera::Certification::TestResult
-galera::Certification::test(const TrxHandleSlavePtr& trx)
+galera::Certification::test(const TrxHandleSlavePtr& trx, Stats& stats)
 {
     assert(mutex_.owned());
     assert(trx->global_seqno() >= 0 /* && trx->local_seqno() >= 0 */);
 
     const TestResult ret(trx->preordered() ? do_test_preordered(trx.get())
-                                           : do_test(trx));
+                                           : do_test(trx, stats));
 
     if (gu_unlikely(ret != TEST_OK))
     {
@@ -1133,7 +1213,7 @@ wsrep_seqno_t galera::Certification::get_safe_to_discard_seqno_() const
     }
     else
     {
-        retval = (*deps_set_.begin()) - 1;
+        retval = deps_set_.index_begin() - 1;
     }
     return retval;
 }
@@ -1146,100 +1226,199 @@ galera::Certification::purge_trxs_upto_(wsrep_seqno_t const seqno,
     assert (seqno > 0);
     assert(mutex_.owned());
 
-    TrxMap::iterator purge_bound(trx_map_.upper_bound(seqno));
+    TrxMap::iterator const purge_bound(seqno < trx_map_.index_begin() ?
+                                       trx_map_.begin() :
+                                       trx_map_.find(seqno + 1));
 
     cert_debug << "purging index up to " << seqno << ", safe to discard seqno " << get_safe_to_discard_seqno_();
 
     assert(purge_bound == trx_map_.end() ||
-           purge_bound->first <= get_safe_to_discard_seqno_() + 1);
+           trx_map_.index(purge_bound) <= get_safe_to_discard_seqno_() + 1);
 
-    for_each(trx_map_.begin(), purge_bound, PurgeAndDiscard(*this));
+    /* Only detach trxs here, their keys are purged from the index in
+     * bounded steps by the service thread, so that a large purge does not
+     * stall certification of incoming write sets. */
+    for (TrxMap::iterator i(trx_map_.begin()); i != purge_bound; ++i)
+    {
+        // Dummy preload events insert only seqno
+        if (i->trx) purge_queue_.push_back(std::move(i->trx));
+    }
     trx_map_.erase(trx_map_.begin(), purge_bound);
 
-    if (handle_gcache && service_thd_) service_thd_->release_seqno(seqno);
+    if (handle_gcache && service_thd_)
+    {
+        purge_release_seqno_ = std::max(purge_release_seqno_, seqno);
+    }
+
+    if (service_thd_)
+    {
+        if (!purge_queue_.empty() || purge_release_seqno_ >= 0)
+        {
+            service_thd_->purge_index(*this);
+        }
+    }
+    else
+    {
+        purge_queued_(PURGE_STEP_KEYS);
+    }
 
     if (0 == ((trx_map_.size() + 1) % 10000))
     {
         log_debug << "trx map after purge: length: " << trx_map_.size()
                   << ", requested purge seqno: " << seqno
-                  << ", real purge seqno: " << trx_map_.begin()->first - 1;
+                  << ", real purge seqno: " << trx_map_.index_begin() - 1;
     }
 
     return seqno;
 }
 
 
+bool
+galera::Certification::purge_step()
+{
+    gu::Lock lock(mutex_);
+    purge_queued_(PURGE_STEP_KEYS);
+    return !purge_queue_.empty();
+}
+
+
+void
+galera::Certification::purge_queued_(size_t const max_keys)
+{
+    assert(mutex_.owned());
+
+    PurgeAndDiscard const purge(*this);
+    size_t keys(0);
+
+    while (!purge_queue_.empty() && keys < max_keys)
+    {
+        const TrxHandleSlavePtr& ts(purge_queue_.front());
+        keys += 1 + ts->write_set().keyset().count();
+        purge(ts);
+        purge_queue_.pop_front();
+    }
+
+    if (purge_release_seqno_ < 0) return;
+
+    assert(service_thd_);
+
+    // Key parts of queued trxs still point to write set buffers in gcache
+    if (purge_queue_.empty())
+    {
+        service_thd_->release_seqno(purge_release_seqno_);
+        purge_release_seqno_ = -1;
+    }
+    else if (keys > 0)
+    {
+        service_thd_->release_seqno(std::min(purge_release_seqno_,
+                                    purge_queue_.front()->global_seqno() - 1));
+    }
+}
+
+
 galera::Certification::TestResult
-galera::Certification::append_trx(const TrxHandleSlavePtr& trx)
+galera::Certification::append_trx_(const TrxHandleSlavePtr& trx,
+                                   Stats&                   stats)
 {
+    assert(mutex_.owned());
 // explicit ROLLBACK is dummy()    assert(!trx->is_dummy());
     assert(trx->global_seqno() > 0 /* && trx->local_seqno() >= 0 */);
     assert(trx->global_seqno() > position_);
 
-#ifndef NDEBUG
-    bool const explicit_rollback(trx->explicit_rollback());
-#endif /* NDEBUG */
-    TestResult retval = TEST_FAILED;
+    if (gu_unlikely(trx->global_seqno() != position_ + 1))
     {
-        gu::Lock lock(mutex_);
+        // this is perfectly normal if trx is rolled back just after
+        // replication, keeping the log though
+        log_debug << "seqno gap, position: " << position_
+                  << " trx seqno " << trx->global_seqno();
+    }
 
-        if (gu_unlikely(trx->global_seqno() != position_ + 1))
+    if (gu_unlikely((trx->last_seen_seqno() + 1) < trx_map_.index_begin()))
+    {
+        /* See #733 - for now it is false positive */
+        cert_debug
+            << "WARNING: last_seen_seqno is below certification index: "
+            << trx_map_.index_begin() << " > " << trx->last_seen_seqno();
+    }
+
+    position_ = trx->global_seqno();
+
+    if (gu_unlikely(!(position_ & max_length_check_) &&
+                    (trx_map_.size() > static_cast<size_t>(max_length_))))
+    {
+        log_debug << "trx map size: " << trx_map_.size()
+                  << " - check if status.last_committed is incrementing";
+
+        wsrep_seqno_t       trim_seqno(position_ - max_length_);
+        wsrep_seqno_t const stds      (get_safe_to_discard_seqno_());
+
+        if (trim_seqno > stds)
         {
-            // this is perfectly normal if trx is rolled back just after
-            // replication, keeping the log though
-            log_debug << "seqno gap, position: " << position_
-                      << " trx seqno " << trx->global_seqno();
+            log_warn << "Attempt to trim certification index at "
+                     << trim_seqno << ", above safe-to-discard: " << stds;
+            trim_seqno = stds;
         }
-
-        if (gu_unlikely((trx->last_seen_seqno() + 1) < trx_map_.begin()->first))
+        else
         {
-            /* See #733 - for now it is false positive */
-            cert_debug
-                << "WARNING: last_seen_seqno is below certification index: "
-                << trx_map_.begin()->first << " > " << trx->last_seen_seqno();
+            cert_debug << "append_trx: purging index up to " << trim_seqno;
         }
 
-        position_ = trx->global_seqno();
+        purge_trxs_upto_(trim_seqno, true);
+    }
 
-        if (gu_unlikely(!(position_ & max_length_check_) &&
-                        (trx_map_.size() > static_cast<size_t>(max_length_))))
-        {
-            log_debug << "trx map size: " << trx_map_.size()
-                      << " - check if status.last_committed is incrementing";
+    TestResult const retval(test(trx, stats));
 
-            wsrep_seqno_t       trim_seqno(position_ - max_length_);
-            wsrep_seqno_t const stds      (get_safe_to_discard_seqno_());
+    TrxMap::iterator const i(trx_map_.find(trx->global_seqno()));
+    if (i != trx_map_.end() && !TrxMap::not_set(*i))
+        gu_throw_fatal << "duplicate trx entry " << *trx;
 
-            if (trim_seqno > stds)
-            {
-                log_warn << "Attempt to trim certification index at "
-                         << trim_seqno << ", above safe-to-discard: " << stds;
-                trim_seqno = stds;
-            }
-            else
-            {
-                cert_debug << "append_trx: purging index up to " << trim_seqno;
-            }
+    trx_map_.insert(trx->global_seqno(), TrxMapEntry(trx));
 
-            purge_trxs_upto_(trim_seqno, true);
-        }
+    // trx with local seqno WSREP_SEQNO_UNDEFINED originates from
+    // IST so deps set tracking should not be done
+    if (trx->local_seqno() != WSREP_SEQNO_UNDEFINED)
+    {
+        assert(trx->last_seen_seqno() != WSREP_SEQNO_UNDEFINED);
+        DepsSet::iterator const d(deps_set_.find(trx->last_seen_seqno()));
+        if (d != deps_set_.end())
+            ++(*d); // also turns a hole into a set element
+        else
+            deps_set_.insert(trx->last_seen_seqno(), 1);
+    }
 
-        retval = test(trx);
+    return retval;
+}
 
-        if (trx_map_.insert(
-                std::make_pair(trx->global_seqno(), trx)).second == false)
-            gu_throw_fatal << "duplicate trx entry " << *trx;
+void
+galera::Certification::stats_update(const Stats& stats,
+                                    size_t const index_size)
+{
+    if (stats.n_certified == 0) return;
 
-        // trx with local seqno WSREP_SEQNO_UNDEFINED originates from
-        // IST so deps set tracking should not be done
-        if (trx->local_seqno() != WSREP_SEQNO_UNDEFINED)
-        {
-            assert(trx->last_seen_seqno() != WSREP_SEQNO_UNDEFINED);
-            deps_set_.insert(trx->last_seen_seqno());
-            assert(deps_set_.size() <= trx_map_.size());
-        }
+    gu::Lock lock(stats_mutex_);
+    n_certified_   += stats.n_certified;
+    deps_dist_     += stats.deps_dist;
+    cert_interval_ += stats.cert_interval;
+    index_size_     = index_size;
+}
+
+galera::Certification::TestResult
+galera::Certification::append_trx(const TrxHandleSlavePtr& trx)
+{
+#ifndef NDEBUG
+    bool const explicit_rollback(trx->explicit_rollback());
+#endif /* NDEBUG */
+    TestResult retval;
+    Stats      stats;
+    size_t     index_size;
+    {
+        gu::Lock lock(mutex_);
+        retval = append_trx_(trx, stats);
+        index_size = cert_index_ng_.size();
     }
 
+    stats_update(stats, index_size);
+
     if (!trx->certified()) trx->mark_certified();
 
 #ifndef NDEBUG
@@ -1262,12 +1441,13 @@ void galera::Certification::append_dummy_preload(const TrxHandleSlavePtr& trx)
     gu::Lock lock(mutex_);
     /* Dummy preloads have only meta data available, not the whole write set,
        so modifying or accessing the trx object causes problems later on.
-       Insert nullptr as a placeholder for seqno. */
-    if (not trx_map_.insert(std::make_pair(trx->global_seqno(), nullptr))
-                .second)
+       Insert a preload placeholder for seqno. */
+    TrxMap::iterator const i(trx_map_.find(trx->global_seqno()));
+    if (i != trx_map_.end() && !TrxMap::not_set(*i))
     {
         gu_throw_fatal << "duplicate trx entry in dummy preload";
     }
+    trx_map_.insert(trx->global_seqno(), TrxMapEntry(TrxHandleSlavePtr()));
     position_ = trx->global_seqno();
 }
 
@@ -1288,12 +1468,16 @@ wsrep_seqno_t galera::Certification::set_trx_committed(TrxHandleSlave& trx)
             !trx.cert_bypass())
         {
             assert(trx.last_seen_seqno() != WSREP_SEQNO_UNDEFINED);
-            DepsSet::iterator i(deps_set_.find(trx.last_seen_seqno()));
-            assert(i != deps_set_.end());
+            wsrep_seqno_t const last_seen(trx.last_seen_seqno());
+            DepsSet::iterator const i(deps_set_.find(last_seen));
+            assert(i != deps_set_.end() && *i > 0);
 
-            if (deps_set_.size() == 1) safe_to_discard_seqno_ = *i;
+            if (--(*i) == 0)
+            {
+                deps_set_.erase(last_seen);
 
-            deps_set_.erase(i);
+                if (deps_set_.empty()) safe_to_discard_seqno_ = last_seen;
+            }
         }
 
         if (gu_unlikely(index_purge_required()))
@@ -1344,6 +1528,41 @@ galera::Certification::param_set(const std::string& key,
         set_boolean_parameter(optimistic_pa_, value, CERT_PARAM_OPTIMISTIC_PA,
                               "\"optimistic\" parallel applying.");
     }
+    else if (key == CERT_PARAM_EXPLICIT_DEPS)
+    {
+        set_boolean_parameter(explicit_deps_, value, CERT_PARAM_EXPLICIT_DEPS,
+                              "explicit parallel applying dependencies.");
+    }
+    else if (key == CERT_PARAM_HOTSPOTS)
+    {
+        size_t const size(hotspots_size(value));
+
+        gu::Lock lock(mutex_);
+        if (size != hotspots_.size())
+        {
+            hotspots_.resize(size);
+            log_info << "Set certification hot spot tracking top size to "
+                     << size << (size ? "" : " (disabled)");
+        }
+    }
+    else if (key == CERT_PARAM_HOTSPOTS_DUMP)
+    {
+        gu::Lock lock(mutex_);
+        if (hotspots_.enabled())
+        {
+            log_info << "Certification conflict hot spots: "
+                     << hotspots_.str(KeyHotspots::CONFLICT);
+            log_info << "Certification dependency hot spots: "
+                     << hotspots_.str(KeyHotspots::DEPENDENCY);
+        }
+        else
+        {
+            log_info << "Tracking of certification hot spots is disabled, "
+                     << "set '" << CERT_PARAM_HOTSPOTS << "' to enable it.";
+        }
+
+        return; // trigger, value is not stored
+    }
     else
     {
         throw gu::NotFound();
@@ -1352,6 +1571,20 @@ galera::Certification::param_set(const std::string& key,
     conf_.set(key, value);
 }
 
+void
+galera::Certification::hotspots_status(gu::Status& status) const
+{
+    gu::Lock lock(mutex_);
+
+    if (hotspots_.enabled())
+    {
+        status.insert("cert_conflict_hotspots",
+                      hotspots_.str(KeyHotspots::CONFLICT));
+        status.insert("cert_dependency_hotspots",
+                      hotspots_.str(KeyHotspots::DEPENDENCY));
+    }
+}
+
 void
 galera::Certification::mark_inconsistent()
 {
@@ -1359,3 +1592,179 @@ galera::Certification::mark_inconsistent()
     assert(!inconsistent_);
     inconsistent_ = true;
 }
+
+bool
+galera::Certification::write_snapshot(const std::string& file_name,
+                                      const gu::GTID&    gtid)
+{
+    if (gcache_.encrypted())
+    {
+        /* write sets would be saved in plaintext */
+        log_info << "Not saving certification index: cache is encrypted";
+        return false;
+    }
+
+    CertIndexSnapshot::Records records;
+    wsrep_seqno_t lowest;
+    int           version;
+    bool          locked(false);
+
+    {
+        gu::Lock lock(mutex_);
+
+        if (inconsistent_ || version_ < 0 || position_ != gtid.seqno() ||
+            !nbo_map_.empty())
+        {
+            log_info << "Not saving certification index: position "
+                     << position_ << ", state " << gtid << ", version "
+                     << version_ << ", NBOs in progress " << nbo_map_.size()
+                     << ", inconsistent " << inconsistent_;
+            return false;
+        }
+
+        records.reserve(trx_map_.size());
+
+        for (wsrep_seqno_t s(trx_map_.index_begin());
+             s < trx_map_.index_end(); ++s)
+        {
+            const TrxHandleSlavePtr& ts(trx_map_[s].trx);
+
+            /* Same as in IST preload: failed and NBO write sets don't make
+             * it to the index, but they still need a placeholder to keep
+             * trx map continuous for purge. */
+            if (!ts || ts->is_dummy() || ts->nbo_start() || ts->nbo_end())
+            {
+                CertIndexSnapshot::Record const r = { s, 0, 0 };
+                records.push_back(r);
+                continue;
+            }
+
+            if (!ts->is_committed())
+            {
+                log_info << "Not saving certification index: uncommitted trx "
+                         << *ts;
+                if (locked) gcache_.seqno_unlock();
+                return false;
+            }
+
+            assert(ts->action().first && ts->action().second > 0);
+
+            if (!locked)
+            {
+                /* keep write set buffers in cache while the file is being
+                 * written without mutex_ */
+                try
+                {
+                    gcache_.seqno_lock(s);
+                    locked = true;
+                }
+                catch (gu::NotFound&)
+                {
+                    log_info << "Not saving certification index: seqno " << s
+                             << " is not in cache";
+                    return false;
+                }
+            }
+
+            CertIndexSnapshot::Record const r =
+                { s, ts->action().first, size_t(ts->action().second) };
+            records.push_back(r);
+        }
+
+        lowest  = lowest_trx_seqno();
+        version = version_;
+    }
+
+    try
+    {
+        CertIndexSnapshot::write(file_name, gtid, lowest, version, records);
+    }
+    catch (...)
+    {
+        if (locked) gcache_.seqno_unlock();
+        throw;
+    }
+
+    if (locked) gcache_.seqno_unlock();
+
+    log_info << "Saved certification index at " << gtid << ": "
+             << records.size() << " entries from seqno " << lowest;
+
+    return true;
+}
+
+void
+galera::Certification::restore_snapshot(const CertIndexSnapshot& snapshot,
+                                        TrxHandleSlave::Pool&    pool)
+{
+    wsrep_seqno_t const start(std::max<wsrep_seqno_t>(snapshot.lowest() - 1,
+                                                       0));
+    assign_initial_position(gu::GTID(snapshot.gtid().uuid(), start),
+                            snapshot.version());
+
+    const CertIndexSnapshot::Records& records(snapshot.records());
+
+    for (CertIndexSnapshot::Records::const_iterator r(records.begin());
+         r != records.end(); ++r)
+    {
+        TrxHandleSlavePtr ts(TrxHandleSlave::New(false, pool),
+                             TrxHandleSlaveDeleter());
+
+        if (0 == r->size)
+        {
+            ts->set_global_seqno(r->seqno);
+            append_dummy_preload(ts);
+            continue;
+        }
+
+        const void* buf;
+        ssize_t     size;
+
+        try
+        {
+            buf = gcache_.seqno_get_ptr(r->seqno, size);
+            /* increment ref count to match that of uncached events below */
+            gcache_.get_ro_plaintext(buf);
+        }
+        catch (gu::NotFound&)
+        {
+            size = r->size;
+            void* ptx;
+            void* const ptr(gcache_.malloc(size, ptx));
+            ::memcpy(ptx, r->ptr, size);
+            gcache_.seqno_assign(ptr, r->seqno, GCS_ACT_WRITESET, false);
+            buf = ptr;
+        }
+
+        gu_trace(ts->unserialize<false>(
+                     gcache_, gcs_action{r->seqno, WSREP_SEQNO_UNDEFINED,
+                             buf, int32_t(size), GCS_ACT_WRITESET}));
+        gcache_.drop_plaintext(buf);
+        ts->set_local(false);
+        ts->verify_checksum();
+        assert(ts->global_seqno() == r->seqno);
+
+        ts->set_state(TrxHandleSlave::S_CERTIFYING);
+
+        TestResult const result(append_trx(ts));
+        if (result != TEST_OK)
+        {
+            gu_throw_fatal << "Certification index restore returned "
+                           << "unexpected certification result " << result
+                           << ", expected " << TEST_OK << ", ts: " << *ts;
+        }
+
+        set_trx_committed(*ts);
+    }
+
+    gu::Lock lock(mutex_);
+
+    /* snapshot may end with events which are not in trx map, e.g.
+     * configuration changes */
+    assert(position_ <= snapshot.gtid().seqno());
+    if (position_ < snapshot.gtid().seqno())
+    {
+        position_       = snapshot.gtid().seqno();
+        last_pa_unsafe_ = position_;
+    }
+}
@@ -9,6 +9,8 @@
 #include "nbo.hpp"
 #include "trx_handle.hpp"
 #include "key_entry_ng.hpp"
+#include "key_entry_table_ng.hpp"
+#include "key_hotspots.hpp"
 #include "galera_service_thd.hpp"
 #include "galera_view.hpp"
 
@@ -19,12 +21,16 @@
 #include <gu_lock.hpp>
 #include <gu_config.hpp>
 #include <gu_gtid.hpp>
+#include <gu_deqmap.hpp>
+#include <gu_status.hpp>
 
-#include <map>
 #include <list>
+#include <deque>
 
 namespace galera
 {
+    class CertIndexSnapshot;
+
     class Certification
     {
     public:
@@ -37,9 +43,7 @@ namespace galera
         typedef gu::UnorderedSet<KeyEntryOS*,
                                  KeyEntryPtrHash, KeyEntryPtrEqual> CertIndex;
 
-        typedef gu::UnorderedSet<KeyEntryNG*,
-                                 KeyEntryPtrHashNG, KeyEntryPtrEqualNG>
-        CertIndexNG;
+        typedef KeyEntryTableNG CertIndexNG;
 
         typedef gu::UnorderedMultiset<KeyEntryNG*,
                                       KeyEntryPtrHashNG, KeyEntryPtrEqualNG>
@@ -47,9 +51,39 @@ namespace galera
 
     private:
 
-        typedef std::multiset<wsrep_seqno_t>             DepsSet;
+        /* Number of certified trxs per last seen seqno */
+        typedef gu::DeqMap<wsrep_seqno_t, size_t>       DepsSet;
+
+        /* Dummy preload events insert only seqno, which is marked by the
+         * preload flag. Default constructed entry is a hole in the map. */
+        struct TrxMapEntry
+        {
+            TrxHandleSlavePtr trx;
+            bool              preload;
+
+            TrxMapEntry() : trx(), preload(false) {}
+
+            explicit TrxMapEntry(const TrxHandleSlavePtr& ts)
+                : trx(ts), preload(!ts)
+            {}
+
+            bool operator==(const TrxMapEntry& other) const
+            {
+                return trx == other.trx && preload == other.preload;
+            }
+
+            friend std::ostream&
+            operator<<(std::ostream& os, const TrxMapEntry& e)
+            {
+                return os << e.trx.get() << (e.preload ? " (preload)" : "");
+            }
+        };
+
+        typedef gu::DeqMap<wsrep_seqno_t, TrxMapEntry>  TrxMap;
 
-        typedef std::map<wsrep_seqno_t, TrxHandleSlavePtr> TrxMap;
+        /* Trxs removed from trx_map_ whose keys are yet to be purged from
+         * the index */
+        typedef std::deque<TrxHandleSlavePtr>           PurgeQueue;
 
     public:
 
@@ -90,6 +124,12 @@ namespace galera
             return purge_trxs_upto_(std::min(seqno, stds), handle_gcache);
         }
 
+        /* Purges a bounded step of trxs detached by purge_trxs_upto() from
+         * the index. Called by the service thread, which purges the index
+         * without blocking certification for the whole purge. Returns true
+         * if more trxs remain queued. */
+        bool purge_step();
+
         // Set trx corresponding to handle committed. Return purge seqno if
         // index purge is required, -1 otherwise.
         wsrep_seqno_t set_trx_committed(TrxHandleSlave&);
@@ -112,18 +152,27 @@ namespace galera
 
         void stats_reset()
         {
-            gu::Lock lock(stats_mutex_);
-            cert_interval_ = 0;
-            deps_dist_ = 0;
-            n_certified_ = 0;
-            index_size_ = 0;
+            {
+                gu::Lock lock(stats_mutex_);
+                cert_interval_ = 0;
+                deps_dist_ = 0;
+                n_certified_ = 0;
+                index_size_ = 0;
+            }
+
+            gu::Lock lock(mutex_);
+            hotspots_.clear();
         }
 
+        /* Adds top conflict and dependency key parts to status if hot spot
+         * tracking is enabled. */
+        void hotspots_status(gu::Status& status) const;
+
         void param_set(const std::string& key, const std::string& value);
 
         wsrep_seqno_t lowest_trx_seqno() const
         {
-            return (trx_map_.empty() ? position_ : trx_map_.begin()->first);
+            return (trx_map_.empty() ? position_ : trx_map_.index_begin());
         }
 
         //
@@ -141,14 +190,42 @@ namespace galera
         void mark_inconsistent();
         bool is_inconsistent() const { return inconsistent_; }
 
+        /* Whether index snapshot should be saved on shutdown and used to
+         * rebuild the index on startup. */
+        bool snapshot() const { return snapshot_; }
+
+        /* Saves write sets which make up the index at gtid to a snapshot
+         * file. Returns false if the index is not in a state which can
+         * be saved. Throws if writing the file fails. */
+        bool write_snapshot(const std::string& file_name,
+                            const gu::GTID&    gtid);
+
+        /* Rebuilds the index from snapshot: write sets are stored in gcache
+         * and appended like pure preload events, position is set to the
+         * snapshot seqno. Slave trxs are allocated from pool. */
+        void restore_snapshot(const CertIndexSnapshot& snapshot,
+                              TrxHandleSlave::Pool&    pool);
+
     private:
 
         // Non-copyable
         Certification(const Certification&);
         Certification& operator=(const Certification&);
 
-        TestResult test(const TrxHandleSlavePtr&);
-        TestResult do_test(const TrxHandleSlavePtr&);
+        /* Certification statistics accumulated under mutex_ and added
+         * to the totals under stats_mutex_ once per append. */
+        struct Stats
+        {
+            Stats() : n_certified(0), deps_dist(0), cert_interval(0) {}
+            size_t        n_certified;
+            wsrep_seqno_t deps_dist;
+            wsrep_seqno_t cert_interval;
+        };
+
+        TestResult append_trx_(const TrxHandleSlavePtr&, Stats&);
+        void stats_update(const Stats&, size_t index_size);
+        TestResult test(const TrxHandleSlavePtr&, Stats&);
+        TestResult do_test(const TrxHandleSlavePtr&, Stats&);
         TestResult do_test_v3to6(TrxHandleSlave*);
         TestResult do_test_preordered(TrxHandleSlave*);
         TestResult do_test_nbo(const TrxHandleSlavePtr&);
@@ -158,6 +235,11 @@ namespace galera
         wsrep_seqno_t get_safe_to_discard_seqno_() const;
         wsrep_seqno_t purge_trxs_upto_(wsrep_seqno_t, bool sync);
 
+        /* Purges queued trxs from the index until at least max_keys keys
+         * were processed and releases purged seqnos in gcache. */
+        void purge_queued_(size_t max_keys);
+        void purge_queued_all_() { purge_queued_(size_t(-1)); }
+
         gu::shared_ptr<NBOCtx>::type nbo_ctx_unlocked(wsrep_seqno_t);
 
         bool index_purge_required()
@@ -175,21 +257,31 @@ namespace galera
                      (key_count_ = 0, byte_count_ = 0, trx_count_ = 0, true));
         }
 
+        /* How many keys to purge from the index under one mutex_
+         * acquisition. */
+        static size_t const PURGE_STEP_KEYS = 1 << 10; // 1K
+
         class PurgeAndDiscard
         {
         public:
 
             PurgeAndDiscard(Certification& cert) : cert_(cert) { }
 
-            void operator()(TrxMap::value_type& vt) const
+            void operator()(const TrxMap::value_type& vt) const
             {
-                if (not vt.second)
+                if (not vt.trx)
                 {
                     // Dummy preload events insert only seqno
                     return;
                 }
+
+                operator()(vt.trx);
+            }
+
+            void operator()(const TrxHandleSlavePtr& ts) const
+            {
                 {
-                    TrxHandleSlave* trx(vt.second.get());
+                    TrxHandleSlave* trx(ts.get());
                     // Trying to lock trx mutex here may cause deadlock
                     // with streaming replication. Locking can be skipped
                     // because trx is only read here and refcount uses atomics.
@@ -235,6 +327,7 @@ namespace galera
         gu::Config&   conf_;
         gcache::GCache& gcache_;
         TrxMap        trx_map_;
+        PurgeQueue    purge_queue_;
         CertIndexNG   cert_index_ng_;
         NBOMap        nbo_map_;
         NBOCtxMap     nbo_ctx_map_;
@@ -244,11 +337,13 @@ namespace galera
         View          current_view_;
         ServiceThd*   service_thd_;
         gu::Mutex     mutex_;
+        KeyHotspots   hotspots_;
         size_t        trx_size_warn_count_;
         wsrep_seqno_t initial_position_;
         wsrep_seqno_t position_;
         wsrep_seqno_t nbo_position_;
         wsrep_seqno_t safe_to_discard_seqno_;
+        wsrep_seqno_t purge_release_seqno_; // release in gcache when purged
         wsrep_seqno_t last_pa_unsafe_;
         wsrep_seqno_t last_preordered_seqno_;
         wsrep_trx_id_t last_preordered_id_;
@@ -274,6 +369,8 @@ namespace galera
         bool               inconsistent_;
         bool               log_conflicts_;
         bool               optimistic_pa_;
+        bool               explicit_deps_;
+        bool         const snapshot_;
     };
 }
 
@@ -0,0 +1,178 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+#include "checksum_pool.hpp"
+
+#include <gu_thread_keys.hpp>
+#include <gu_logger.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <cstring>   // strerror()
+#include <unistd.h>  // sysconf()
+
+namespace galera
+{
+
+/* serializes starting and stopping of the workers */
+static std::mutex ref_mtx;
+
+ChecksumPool::ChecksumPool()
+    :
+    mtx_      (gu::get_mutex_key(gu::GU_MUTEX_KEY_WRITE_SET_CHECK)),
+    work_cond_(gu::get_cond_key(gu::GU_COND_KEY_WRITE_SET_CHECK)),
+    done_cond_(gu::get_cond_key(gu::GU_COND_KEY_WRITE_SET_CHECK_DONE)),
+    queue_    (),
+    workers_  (),
+    refs_     (0),
+    stop_     (false)
+{}
+
+ChecksumPool&
+ChecksumPool::instance()
+{
+    /* deliberately leaked: jobs may be waited for from static destructors */
+    static ChecksumPool* const pool(new ChecksumPool);
+    return *pool;
+}
+
+int
+ChecksumPool::default_threads()
+{
+    long const cpus(sysconf(_SC_NPROCESSORS_ONLN));
+    return std::max(1L, std::min(cpus, 4L));
+}
+
+bool
+ChecksumPool::submit(Job& job)
+{
+    ChecksumPool& pool(instance());
+    gu::Lock lock(pool.mtx_);
+
+    if (gu_unlikely(pool.workers_.empty())) return false;
+
+    job.done_ = false;
+    job.ok_   = false;
+    pool.queue_.push_back(&job);
+    pool.work_cond_.signal();
+
+    return true;
+}
+
+void
+ChecksumPool::wait(Job& job)
+{
+    ChecksumPool& pool(instance());
+    gu::Lock lock(pool.mtx_);
+
+    while (!job.done_) lock.wait(pool.done_cond_);
+}
+
+void*
+ChecksumPool::worker_func(void* arg)
+{
+    static_cast<ChecksumPool*>(arg)->work();
+    return NULL;
+}
+
+void
+ChecksumPool::work()
+{
+    gu::Lock lock(mtx_);
+
+    while (true)
+    {
+        while (queue_.empty() && !stop_) lock.wait(work_cond_);
+
+        if (queue_.empty()) break; // stop_ and nothing left to do
+
+        Job* const job(queue_.front());
+        queue_.pop_front();
+
+        bool ok(false);
+
+        mtx_.unlock();
+        try
+        {
+            job->run();
+            ok = true;
+        }
+        catch (std::exception& e)
+        {
+            log_error << e.what();
+        }
+        catch (...)
+        {
+            log_error << "Non-standard exception in checksum job";
+        }
+        mtx_.lock();
+
+        job->ok_   = ok;
+        job->done_ = true;
+        done_cond_.broadcast();
+    }
+}
+
+void
+ChecksumPool::start(int const threads)
+{
+    std::lock_guard<std::mutex> ref_lock(ref_mtx);
+    gu::Lock lock(mtx_);
+
+    if (refs_++ > 0) return;
+
+    assert(workers_.empty());
+    stop_ = false;
+
+    for (int i(0); i < threads; ++i)
+    {
+        gu_thread_t thd;
+        int const err(gu_thread_create(
+                          gu::get_thread_key(gu::GU_THREAD_KEY_WRITE_SET_CHECK),
+                          &thd, worker_func, this));
+        if (gu_unlikely(0 != err))
+        {
+            log_warn << "Starting checksum thread failed: " << err
+                     << '(' << ::strerror(err) << ')';
+            break;
+        }
+
+        workers_.push_back(thd);
+    }
+}
+
+void
+ChecksumPool::stop()
+{
+    std::lock_guard<std::mutex> ref_lock(ref_mtx);
+    std::vector<gu_thread_t> workers;
+    {
+        gu::Lock lock(mtx_);
+
+        assert(refs_ > 0);
+        if (--refs_ > 0) return;
+
+        /* no new jobs will be accepted, queued ones will be completed */
+        stop_ = true;
+        work_cond_.broadcast();
+        workers.swap(workers_);
+    }
+
+    for (size_t i(0); i < workers.size(); ++i)
+    {
+        gu_thread_join(workers[i], NULL);
+    }
+}
+
+ChecksumPool::Ref::Ref(int const threads)
+{
+    instance().start(threads);
+}
+
+ChecksumPool::Ref::~Ref()
+{
+    instance().stop();
+}
+
+} /* namespace galera */
@@ -0,0 +1,97 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+#ifndef GALERA_CHECKSUM_POOL_HPP
+#define GALERA_CHECKSUM_POOL_HPP
+
+#include <gu_lock.hpp> // gu::Mutex and gu::Cond
+#include <gu_threads.h>
+
+#include <deque>
+#include <vector>
+
+namespace galera
+{
+    /*!
+     * Process-wide pool of threads to verify checksums of big writesets
+     * in the background. Worker threads are started while there is at least
+     * one ChecksumPool::Ref alive (normally held by the replicator), so that
+     * no threads are created on the replication path.
+     */
+    class ChecksumPool
+    {
+    public:
+
+        class Job
+        {
+        public:
+
+            Job() : done_(true), ok_(true) {}
+            virtual ~Job() {}
+
+            /*! performs the check, throws on failure */
+            virtual void run() = 0;
+
+            /*! valid only after ChecksumPool::wait() */
+            bool ok() const { return ok_; }
+
+        private:
+
+            friend class ChecksumPool;
+
+            bool done_;
+            bool ok_;
+        };
+
+        /*!
+         * Queues the job for execution.
+         *
+         * @return false if the pool is not running, the caller should run
+         *         the job itself then
+         */
+        static bool submit(Job& job);
+
+        /*! waits for the submitted job to complete */
+        static void wait(Job& job);
+
+        /*! keeps the worker threads running for the lifetime of the object */
+        class Ref
+        {
+        public:
+            explicit Ref(int threads = default_threads());
+            ~Ref();
+        private:
+            Ref(const Ref&);
+            Ref& operator=(const Ref&);
+        };
+
+        static int default_threads();
+
+    private:
+
+        ChecksumPool();
+        ~ChecksumPool(); // never called, the pool outlives all its users
+
+        static ChecksumPool& instance();
+
+        void start(int threads);
+        void stop();
+
+        static void* worker_func(void*);
+        void         work();
+
+        gu::Mutex                mtx_;
+        gu::Cond                 work_cond_; // queue is not empty or stop
+        gu::Cond                 done_cond_; // some job has completed
+        std::deque<Job*>         queue_;
+        std::vector<gu_thread_t> workers_;
+        int                      refs_;
+        bool                     stop_;
+
+        ChecksumPool(const ChecksumPool&);
+        ChecksumPool& operator=(const ChecksumPool&);
+    };
+}
+
+#endif /* GALERA_CHECKSUM_POOL_HPP */
@@ -1,6 +1,140 @@
 //
-// Copyright (C) 2013 Codership Oy <info@codership.com>
+// Copyright (C) 2013-2026 Codership Oy <info@codership.com>
 //
 
 #include "data_set.hpp"
 
+#include "gu_lz.hpp"
+#include "gu_serialize.hpp"
+
+namespace galera
+{
+
+/*
+ * VER2 data set is a record set with a single record:
+ *
+ *  0-7: uncompressed size of the inner record set, 0 - not compressed
+ *  8- : inner record set, compressed if its size is given above
+ *
+ * The inner record set is an ordinary unchecksummed data set.
+ * This makes it possible to compress it as a whole after all appends,
+ * without copying the payload when compression is not applied.
+ */
+static size_t const VER2_RAW_SIZE_LEN = 8;
+
+ssize_t
+DataSetOut::gather (GatherVector& out)
+{
+    typedef gu::RecordSetOut<DataSet::RecordOut> Base;
+
+    if (gu_likely(DataSet::VER2 != version_)) return Base::gather(out);
+
+    if (0 == count()) return 0;
+
+    if (NULL == packed_)
+    {
+        GatherVector raw;
+        size_t const raw_size(Base::gather(raw));
+        size_t lz_size(0);
+
+        if (compress_threshold_ > 0 && raw_size >= compress_threshold_)
+        {
+            const gu::byte_t* src(static_cast<const gu::byte_t*>(raw[0].ptr));
+
+            if (raw->size() > 1)
+            {
+                raw_buf_.resize(raw_size);
+                size_t off(0);
+                for (size_t i(0); i < raw->size(); ++i)
+                {
+                    ::memcpy(&raw_buf_[off], raw[i].ptr, raw[i].size);
+                    off += raw[i].size;
+                }
+                assert(off == raw_size);
+                src = &raw_buf_[0];
+            }
+
+            /* don't bother the appliers unless it saves at least 1/8 */
+            lz_buf_.resize(raw_size - raw_size/8);
+            lz_size = gu::lz_compress(src, raw_size,
+                                      &lz_buf_[0], lz_buf_.size());
+
+            std::vector<gu::byte_t>().swap(raw_buf_);
+        }
+
+        packed_ = new Base(NULL, 0, *base_name_,
+                           payload_check_type(gu::RecordSet::version()),
+                           gu::RecordSet::version());
+
+        gu::byte_t hdr[VER2_RAW_SIZE_LEN];
+        gu::serialize8(uint64_t(lz_size > 0 ? raw_size : 0), hdr, 0);
+        packed_->append(hdr, sizeof(hdr), true, false);
+
+        if (lz_size > 0)
+        {
+            packed_->append(&lz_buf_[0], lz_size, false, false);
+        }
+        else
+        {
+            for (size_t i(0); i < raw->size(); ++i)
+            {
+                if (raw[i].size > 0)
+                    packed_->append(raw[i].ptr, raw[i].size, false, false);
+            }
+        }
+    }
+
+    return packed_->gather(out);
+}
+
+
+void
+DataSetIn::unpack () const
+{
+    assert(DataSet::VER2 == version_);
+    assert(!unpacked_);
+
+    if (Base::count() > 0)
+    {
+        Base::rewind();
+        gu::Buf const rec(Base::next().buf());
+        const gu::byte_t* const ptr(static_cast<const gu::byte_t*>(rec.ptr));
+
+        uint64_t raw_size;
+        gu::unserialize8(ptr, rec.size, 0, raw_size);
+
+        const gu::byte_t* const payload(ptr + VER2_RAW_SIZE_LEN);
+        size_t const payload_size(rec.size - VER2_RAW_SIZE_LEN);
+
+        if (raw_size > 0)
+        {
+            if (gu_unlikely(raw_size > gu::lz_max_decompressed(payload_size)))
+            {
+                gu_throw_error(EINVAL) << "Bogus uncompressed data set size "
+                                       << raw_size << " for " << payload_size
+                                       << " bytes of compressed payload";
+            }
+
+            inner_buf_.resize(raw_size);
+
+            size_t const size(gu::lz_decompress(payload, payload_size,
+                                                &inner_buf_[0], raw_size));
+            if (gu_unlikely(size != raw_size))
+            {
+                gu_throw_error(EINVAL) << "Decompressed data set size "
+                                       << size << " does not match expected "
+                                       << raw_size;
+            }
+
+            inner_.init(&inner_buf_[0], raw_size, false);
+        }
+        else
+        {
+            inner_.init(payload, payload_size, false);
+        }
+    }
+
+    unpacked_ = true;
+}
+
+} /* namespace galera */
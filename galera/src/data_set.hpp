@@ -1,5 +1,5 @@
 //
-// Copyright (C) 2013 Codership Oy <info@codership.com>
+// Copyright (C) 2013-2026 Codership Oy <info@codership.com>
 //
 
 
@@ -9,6 +9,8 @@
 #include "gu_rset.hpp"
 #include "gu_vlq.hpp"
 
+#include <vector>
+
 
 namespace galera
 {
@@ -19,10 +21,11 @@ namespace galera
         enum Version
         {
             EMPTY = 0,
-            VER1
+            VER1,
+            VER2  /* payload may be LZ-compressed, see DataSetOut::gather() */
         };
 
-        static Version const MAX_VERSION = VER1;
+        static Version const MAX_VERSION = VER2;
 
         static Version version (unsigned int ver)
         {
@@ -80,27 +83,41 @@ namespace galera
 
         DataSetOut () // empty ctor for slave TrxHandle
             :
-            gu::RecordSetOut<DataSet::RecordOut>(), version_()
+            gu::RecordSetOut<DataSet::RecordOut>(), version_(),
+            base_name_(NULL), compress_threshold_(0), packed_(NULL),
+            raw_buf_(), lz_buf_()
         {}
 
+        /*
+         * @param compress_threshold VER2 payloads of at least that size are
+         *                           compressed, 0 - never compress
+         */
         DataSetOut (gu::byte_t*             reserved,
                     size_t                  reserved_size,
                     const BaseName&         base_name,
                     DataSet::Version        version,
-                    gu::RecordSet::Version  rsv)
+                    gu::RecordSet::Version  rsv,
+                    size_t                  compress_threshold = 0)
             :
             gu::RecordSetOut<DataSet::RecordOut> (
                 reserved,
                 reserved_size,
                 base_name,
-                check_type(version),
+                check_type(version, rsv),
                 rsv
                 ),
-            version_(version)
+            version_(version),
+            base_name_(&base_name),
+            compress_threshold_(compress_threshold),
+            packed_(NULL),
+            raw_buf_(),
+            lz_buf_()
         {
             assert((uintptr_t(reserved) % GU_WORD_BYTES) == 0);
         }
 
+        ~DataSetOut() { delete packed_; }
+
         size_t
         append (const void* const src, size_t const size, bool const store)
         {
@@ -117,24 +134,42 @@ namespace galera
         DataSet::Version
         version () const { return count() ? version_ : DataSet::EMPTY; }
 
+        /* version the set was created with, regardless of its contents */
+        DataSet::Version
+        configured_version () const { return version_; }
+
         typedef gu::RecordSet::GatherVector GatherVector;
 
+        /* VER2 set is wrapped into an outer record set carrying either the
+         * compressed serialized inner set or a reference to it */
+        ssize_t gather (GatherVector& out);
+
     private:
 
         // depending on version we may pack data differently
         DataSet::Version const version_;
+        const BaseName*        base_name_;
+        size_t const           compress_threshold_;
+        gu::RecordSetOut<DataSet::RecordOut>* packed_;
+        std::vector<gu::byte_t> raw_buf_; // contiguous copy of the inner set
+        std::vector<gu::byte_t> lz_buf_;  // compressed inner set
 
         static gu::RecordSet::CheckType
-        check_type (DataSet::Version ver)
+        check_type (DataSet::Version ver, gu::RecordSet::Version rsv)
         {
             switch (ver)
             {
             case DataSet::EMPTY: break; /* Can't create EMPTY DataSetOut */
-            case DataSet::VER1:  return gu::RecordSet::CHECK_MMH128;
+            case DataSet::VER1:  return gu::RecordSet::payload_check_type(rsv);
+            /* VER2 inner set is checksummed by the outer one */
+            case DataSet::VER2:  return gu::RecordSet::CHECK_NONE;
             }
             throw;
         }
 
+        DataSetOut (const DataSetOut&);
+        DataSetOut& operator= (const DataSetOut&);
+
     }; /* class DataSetOut */
 
 
@@ -142,31 +177,71 @@ namespace galera
     {
     public:
 
+        typedef gu::RecordSetIn<DataSet::RecordIn> Base;
+
         DataSetIn (DataSet::Version ver, const gu::byte_t* buf, size_t size)
             :
-            gu::RecordSetIn<DataSet::RecordIn>(buf, size, false),
-            version_(ver)
+            Base(buf, size, false),
+            version_(ver),
+            inner_(),
+            inner_buf_(),
+            unpacked_(false)
         {}
 
-        DataSetIn () : gu::RecordSetIn<DataSet::RecordIn>(),
-                       version_(DataSet::EMPTY)
+        DataSetIn () : Base(),
+                       version_(DataSet::EMPTY),
+                       inner_(),
+                       inner_buf_(),
+                       unpacked_(false)
         {}
 
         void init (DataSet::Version ver, const gu::byte_t* buf, size_t size)
         {
-            gu::RecordSetIn<DataSet::RecordIn>::init(buf, size, false);
+            Base::init(buf, size, false);
             version_ = ver;
         }
 
+        /* size(), serial_size(), buf(), checksum() and get_checksum()
+         * refer to the set as it was received, while the methods below
+         * iterate over the original, uncompressed records. VER2 payload is
+         * unpacked on the first access. */
+
+        int count () const
+        {
+            return gu_likely(DataSet::VER2 != version_) ?
+                Base::count() : records().count();
+        }
+
+        void rewind () const
+        {
+            if (gu_likely(DataSet::VER2 != version_))
+                Base::rewind();
+            else
+                records().rewind();
+        }
+
         gu::Buf next () const
         {
-            return gu::RecordSetIn<DataSet::RecordIn>::next().buf();
+            return (gu_likely(DataSet::VER2 != version_) ?
+                    Base::next() : records().next()).buf();
         }
 
     private:
 
         DataSet::Version version_;
 
+        Base mutable                    inner_;
+        std::vector<gu::byte_t> mutable inner_buf_;
+        bool mutable                    unpacked_;
+
+        const Base& records () const
+        {
+            if (gu_unlikely(!unpacked_)) unpack();
+            return inner_;
+        }
+
+        void unpack () const;
+
     }; /* class DataSetIn */
 
 #if defined(__GNUG__)
@@ -42,6 +42,8 @@ namespace galera
     static std::string const GALERA_STATE_FILE("grastate.dat");
     static std::string const VIEW_STATE_FILE("gvwstate.dat");
 #endif
+
+    static std::string const CERT_INDEX_FILE("gcertidx.dat");
 }
 
 #endif /* GALERA_COMMON_HPP */
@@ -6,15 +6,20 @@
  */
 
 #include "galera_service_thd.hpp"
+#include "certification.hpp"
 #include "gu_thread_keys.hpp"
 
 const uint32_t galera::ServiceThd::A_NONE = 0;
 
 static const uint32_t A_LAST_COMMITTED = 1U <<  0;
 static const uint32_t A_RELEASE_SEQNO  = 1U <<  1;
+static const uint32_t A_PURGE_INDEX    = 1U <<  2;
 static const uint32_t A_FLUSH          = 1U << 30;
 static const uint32_t A_EXIT           = 1U << 31;
 
+// index purge steps per pass before other actions are looked at again
+static const int PURGE_STEPS_PER_PASS = 16;
+
 void*
 galera::ServiceThd::thd_func (void* arg)
 {
@@ -32,6 +37,7 @@ galera::ServiceThd::thd_func (void* arg)
 
             data = st->data_;
             st->data_.act_ = A_NONE; // clear pending actions
+            st->purging_ = (0 != (data.act_ & A_PURGE_INDEX));
 
             if (data.act_ & A_FLUSH)
             {
@@ -79,6 +85,28 @@ galera::ServiceThd::thd_func (void* arg)
                              << data.release_seqno_ << ": " << e.what();
                 }
             }
+
+            if (data.act_ & A_PURGE_INDEX)
+            {
+                // certification gets in between the steps, and other
+                // actions between the passes
+                bool more(true);
+                for (int i(0); more && i < PURGE_STEPS_PER_PASS; ++i)
+                {
+                    more = data.cert_->purge_step();
+                }
+
+                gu::Lock lock(st->mtx_);
+
+                // unless canceled in the meantime
+                if (more && st->data_.cert_ == data.cert_)
+                {
+                    st->data_.act_ |= A_PURGE_INDEX;
+                }
+
+                st->purging_ = false;
+                st->flush_.broadcast();
+            }
         }
     }
 
@@ -92,7 +120,8 @@ galera::ServiceThd::ServiceThd (GcsI& gcs, gcache::GCache& gcache) :
     mtx_    (gu::get_mutex_key(gu::GU_MUTEX_KEY_SERVICE_THREAD)),
     cond_   (gu::get_cond_key(gu::GU_COND_KEY_SERVICE_THREAD)),
     flush_  (gu::get_cond_key(gu::GU_COND_KEY_SERVICE_THREAD_FLUSH)),
-    data_   ()
+    data_   (),
+    purging_(false)
 {
     gu_thread_create (gu::get_thread_key(gu::GU_THREAD_KEY_SERVICE), &thd_,
                       thd_func, this);
@@ -166,3 +195,26 @@ galera::ServiceThd::release_seqno(gcs_seqno_t seqno)
         data_.act_ |= A_RELEASE_SEQNO;
     }
 }
+
+void
+galera::ServiceThd::purge_index(Certification& cert)
+{
+    gu::Lock lock(mtx_);
+
+    data_.cert_ = &cert;
+
+    if (data_.act_ == A_NONE) cond_.signal();
+
+    data_.act_ |= A_PURGE_INDEX;
+}
+
+void
+galera::ServiceThd::cancel_purge_index()
+{
+    gu::Lock lock(mtx_);
+
+    data_.act_ &= ~A_PURGE_INDEX;
+    data_.cert_ = NULL;
+
+    while (purging_) lock.wait(flush_);
+}
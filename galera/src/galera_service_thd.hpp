@@ -12,6 +12,8 @@
 
 namespace galera
 {
+    class Certification;
+
     class ServiceThd
     {
     public:
@@ -41,19 +43,28 @@ namespace galera
         /*! release write sets up to and including seqno */
         void release_seqno (gcs_seqno_t seqno);
 
+        /*! purge trxs queued for purge from certification index */
+        void purge_index (Certification& cert);
+
+        /*! cancel scheduled index purge and wait for the ongoing one
+         *  to finish (before certification object is destroyed) */
+        void cancel_purge_index ();
+
     private:
 
         static const uint32_t A_NONE;
 
         struct Data
         {
-            gu::GTID    last_committed_;
-            gcs_seqno_t release_seqno_;
-            uint32_t    act_;
+            gu::GTID       last_committed_;
+            gcs_seqno_t    release_seqno_;
+            Certification* cert_;
+            uint32_t       act_;
 
             Data() :
                 last_committed_(),
                 release_seqno_ (0),
+                cert_          (NULL),
                 act_           (A_NONE)
             {}
         };
@@ -65,6 +76,7 @@ namespace galera
         gu::Cond        cond_;  // service request condition
         gu::Cond        flush_; // flush condition
         Data            data_;
+        bool            purging_; // index purge in progress
 
         static void* thd_func (void*);
 
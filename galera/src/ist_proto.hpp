@@ -533,7 +533,7 @@ namespace galera
 
                 if (gu_likely(payload_size))
                 {
-                    sent = gu::write(socket, cbs);
+                    sent = write_ordered(socket, buffer, cbs);
                 }
                 else
                 {
@@ -764,6 +764,46 @@ namespace galera
             int      version_;
             bool     keep_keys_;
 
+            /* Writes message header and payload. Payload parts that are
+             * large enough and are stored in a gcache file are sent straight
+             * from the file, sparing the copy to socket buffers. */
+            template <class ConstBufferSequence>
+            size_t write_ordered(gu::AsioSocket&               socket,
+                                 const gcache::GCache::Buffer& buffer,
+                                 const ConstBufferSequence&    cbs)
+            {
+                static size_t const SENDFILE_MIN(1 << 16);
+
+                if (buffer.fd() < 0) return gu::write(socket, cbs);
+
+                const gu::byte_t* const begin(buffer.ptr());
+                const gu::byte_t* const end(begin + buffer.size());
+
+                size_t sent(0);
+                for (auto b(cbs.begin()); b != cbs.end(); ++b)
+                {
+                    if (b->size() == 0) continue;
+
+                    const gu::byte_t* const data
+                        (static_cast<const gu::byte_t*>(b->data()));
+                    size_t n(0);
+
+                    if (b->size() >= SENDFILE_MIN && data >= begin &&
+                        data + b->size() <= end)
+                    {
+                        n = socket.sendfile(buffer.fd(),
+                                            buffer.offset() + (data - begin),
+                                            b->size());
+                    }
+
+                    if (0 == n) n = socket.write(*b);
+
+                    sent += n;
+                }
+
+                return sent;
+            }
+
             Message::Type ordered_type(const gcache::GCache::Buffer& buf)
             {
                 assert(buf.type() == GCS_ACT_WRITESET ||
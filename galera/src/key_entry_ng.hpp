@@ -15,27 +15,63 @@ namespace galera
     {
     public:
         KeyEntryNG(const KeySet::KeyPart& key)
-            : refs_{nullptr, nullptr, nullptr, nullptr},
+            : hash_{0, 0},
+              refs_{nullptr, nullptr, nullptr, nullptr},
 #ifndef NDEBUG
               seqnos_{0, 0, 0, 0},
 #endif // NDEBUG
-              key_(key)
+              key_(key),
+              wide_(key.hash_words(hash_[0], hash_[1])),
+              tree_(KeySet::TREE8 == key.version())
+        {
+        }
+
+        /* Constructs an empty entry which does not refer to any key. */
+        KeyEntryNG()
+            : hash_{0, 0},
+              refs_{nullptr, nullptr, nullptr, nullptr},
+#ifndef NDEBUG
+              seqnos_{0, 0, 0, 0},
+#endif // NDEBUG
+              key_(),
+              wide_(false),
+              tree_(false)
         {
         }
 
         KeyEntryNG(const KeyEntryNG& other)
-            : refs_(other.refs_)
+            : hash_(other.hash_)
+            , refs_(other.refs_)
             ,
 #ifndef NDEBUG
             seqnos_(other.seqnos_)
             ,
 #endif /* NDEBUG */
             key_(other.key_)
+            , wide_(other.wide_)
+            , tree_(other.tree_)
         {
         }
 
         const KeySet::KeyPart& key() const { return key_; }
 
+        bool empty() const { return key_.ptr() == nullptr; }
+
+        /* Hash of the key, does not touch the key buffer */
+        size_t hash() const { return hash_[0]; }
+
+        /* Equivalent to key().matches(other.key()), but compares inline
+         * hashes first, so that the key buffers are touched only when both
+         * keys carry values to compare (TREE8) and the hashes match. */
+        bool matches(const KeyEntryNG& other) const
+        {
+            assert(!empty());
+            assert(!other.empty());
+            return (hash_[0] == other.hash_[0] &&
+                    (!(wide_ && other.wide_) || hash_[1] == other.hash_[1]) &&
+                    (!(tree_ && other.tree_) || key_.matches(other.key_)));
+        }
+
         void ref(wsrep_key_type_t p, const KeySet::KeyPart& k,
                  TrxHandleSlave* trx)
         {
@@ -47,7 +83,9 @@ namespace galera
 #ifndef NDEBUG
             seqnos_[p] = trx->global_seqno();
 #endif // NDEBUG
-            key_ = k;
+            key_  = k;
+            wide_ = k.hash_words(hash_[0], hash_[1]);
+            tree_ = (KeySet::TREE8 == k.version());
         }
 
         void unref(wsrep_key_type_t p, const TrxHandleSlave* trx)
@@ -97,11 +135,14 @@ namespace galera
 
         void swap(KeyEntryNG& other) throw()
         {
+            std::swap(hash_, other.hash_);
             std::swap(refs_, other.refs_);
 #ifndef NDEBUG
             std::swap(seqnos_, other.seqnos_);
 #endif /* NDEBUG */
             std::swap(key_,  other.key_);
+            std::swap(wide_, other.wide_);
+            std::swap(tree_, other.tree_);
         }
 
         KeyEntryNG& operator=(KeyEntryNG ke)
@@ -116,12 +157,15 @@ namespace galera
         }
 
     private:
+        /* Hash is kept inline to avoid dereferencing key_ on lookups */
+        std::array<uint64_t, 2> hash_;
         std::array<TrxHandleSlave*, KeySet::Key::TYPE_MAX + 1> refs_;
 #ifndef NDEBUG
         std::array<wsrep_seqno_t, KeySet::Key::TYPE_MAX + 1> seqnos_;
 #endif // NDEBUG
         KeySet::KeyPart key_;
-
+        bool            wide_;
+        bool            tree_; /* key carries part value */
     };
 
     inline void swap(KeyEntryNG& a, KeyEntryNG& b) { a.swap(b); }
@@ -131,7 +175,7 @@ namespace galera
     public:
         size_t operator()(const KeyEntryNG& ke) const
         {
-            return ke.key().hash();
+            return ke.hash();
         }
     };
 
@@ -140,7 +184,7 @@ namespace galera
     public:
         size_t operator()(const KeyEntryNG* const ke) const
         {
-            return ke->key().hash();
+            return ke->hash();
         }
     };
 
@@ -151,7 +195,7 @@ namespace galera
                         const KeyEntryNG& right)
             const
         {
-            return left.key().matches(right.key());
+            return left.matches(right);
         }
     };
 
@@ -162,7 +206,7 @@ namespace galera
                         const KeyEntryNG* const right)
             const
         {
-            return left->key().matches(right->key());
+            return left->matches(*right);
         }
     };
 }
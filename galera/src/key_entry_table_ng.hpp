@@ -0,0 +1,300 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+//!
+// @file key_entry_table_ng.hpp
+//
+// Flat open addressing hash table of KeyEntryNG objects for the
+// certification index.
+//
+// Entries are stored by value in a single cache line aligned array, so
+// a lookup touches only the probed slots: the key hash is kept inline
+// in KeyEntryNG next to the reference slots. Collisions are resolved by
+// linear probing, and erase() shifts subsequent entries backwards to
+// fill the gap, so the table never contains tombstones.
+//
+// Note that insert() and erase() may move entries around, so the
+// pointers returned by find() and insert() are valid only until the next
+// table modification.
+//
+
+#ifndef GALERA_KEY_ENTRY_TABLE_NG_HPP
+#define GALERA_KEY_ENTRY_TABLE_NG_HPP
+
+#include "key_entry_ng.hpp"
+
+#include "gu_limits.h" // GU_CACHE_LINE_SIZE
+#include "gu_throw.hpp"
+
+#include <iterator>
+#include <new>
+#include <utility>
+
+#include <cerrno>
+#include <cstdlib>
+
+namespace galera
+{
+    class KeyEntryTableNG
+    {
+    public:
+
+        typedef KeyEntryNG value_type;
+
+        template <typename T>
+        class Iterator
+            : public std::iterator<std::forward_iterator_tag, T>
+        {
+        public:
+            Iterator() : cur_(nullptr), end_(nullptr) {}
+
+            Iterator(T* const cur, T* const end) : cur_(cur), end_(end)
+            {
+                skip_empty();
+            }
+
+            T& operator*()  const { return *cur_; }
+            T* operator->() const { return  cur_; }
+
+            Iterator& operator++()
+            {
+                ++cur_;
+                skip_empty();
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator const ret(*this);
+                ++(*this);
+                return ret;
+            }
+
+            bool operator==(const Iterator& other) const
+            {
+                return cur_ == other.cur_;
+            }
+
+            bool operator!=(const Iterator& other) const
+            {
+                return cur_ != other.cur_;
+            }
+
+        private:
+            void skip_empty()
+            {
+                while (cur_ != end_ && cur_->empty()) ++cur_;
+            }
+
+            T* cur_;
+            T* end_;
+        };
+
+        typedef Iterator<KeyEntryNG>       iterator;
+        typedef Iterator<const KeyEntryNG> const_iterator;
+
+        KeyEntryTableNG()
+            : slots_(nullptr),
+              mask_ (0),
+              size_ (0)
+        {}
+
+        ~KeyEntryTableNG()
+        {
+            destroy(slots_, capacity());
+        }
+
+        size_t size()     const { return size_; }
+        bool   empty()    const { return size_ == 0; }
+        size_t capacity() const { return slots_ ? mask_ + 1 : 0; }
+
+        /* memory allocated for the slot array */
+        size_t allocated() const { return capacity() * sizeof(KeyEntryNG); }
+
+        iterator begin() { return iterator(slots_, slots_ + capacity()); }
+        iterator end()
+        {
+            return iterator(slots_ + capacity(), slots_ + capacity());
+        }
+
+        const_iterator begin() const
+        {
+            return const_iterator(slots_, slots_ + capacity());
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator(slots_ + capacity(), slots_ + capacity());
+        }
+
+        /* Returns pointer to the entry matching the key or nullptr if
+         * there is none. */
+        KeyEntryNG* find(const KeySet::KeyPart& key)
+        {
+            if (gu_unlikely(empty())) return nullptr;
+
+            KeyEntryNG const ke(key);
+            size_t const pos(lookup(ke));
+
+            return slots_[pos].empty() ? nullptr : &slots_[pos];
+        }
+
+        const KeyEntryNG* find(const KeySet::KeyPart& key) const
+        {
+            return const_cast<KeyEntryTableNG*>(this)->find(key);
+        }
+
+        /* Returns pointer to the entry matching the key and true if a new
+         * (unreferenced) entry was inserted for it, false otherwise. */
+        std::pair<KeyEntryNG*, bool> insert(const KeySet::KeyPart& key)
+        {
+            if (gu_unlikely((size_ + 1) * MAX_LOAD_DEN >
+                            capacity() * MAX_LOAD_NUM))
+            {
+                rehash(capacity() ? capacity() * 2 : MIN_CAPACITY);
+            }
+
+            KeyEntryNG ke(key);
+            size_t const pos(lookup(ke));
+
+            if (slots_[pos].empty())
+            {
+                slots_[pos].swap(ke);
+                ++size_;
+                return std::make_pair(&slots_[pos], true);
+            }
+
+            return std::make_pair(&slots_[pos], false);
+        }
+
+        /* Erases the entry pointed to by kep which must have been obtained
+         * by find() or insert() and must not be referenced. */
+        void erase(KeyEntryNG* const kep)
+        {
+            assert(kep >= slots_ && kep < slots_ + capacity());
+            assert(!kep->empty());
+            assert(!kep->referenced());
+
+            size_t hole(kep - slots_);
+            size_t pos(hole);
+
+            /* Backward shift: move every following entry of the probe
+             * sequence into the hole unless that would place it before its
+             * home slot. */
+            for (pos = (pos + 1) & mask_; !slots_[pos].empty();
+                 pos = (pos + 1) & mask_)
+            {
+                size_t const home(slots_[pos].hash() & mask_);
+
+                if (((pos - home) & mask_) >= ((pos - hole) & mask_))
+                {
+                    slots_[hole].swap(slots_[pos]);
+                    hole = pos;
+                }
+            }
+
+            slots_[hole] = KeyEntryNG();
+            --size_;
+
+            if (gu_unlikely(size_ * MIN_LOAD_DEN < capacity() &&
+                            capacity() > MIN_CAPACITY))
+            {
+                rehash(capacity() / 2);
+            }
+        }
+
+        /* Removes all entries and releases memory. Entries must not be
+         * referenced. */
+        void clear()
+        {
+            destroy(slots_, capacity());
+            slots_ = nullptr;
+            mask_  = 0;
+            size_  = 0;
+        }
+
+    private:
+
+        KeyEntryTableNG(const KeyEntryTableNG&);
+        KeyEntryTableNG& operator=(const KeyEntryTableNG&);
+
+        static size_t const MIN_CAPACITY = 1 << 10;
+        /* grow when load factor exceeds 3/4 ... */
+        static size_t const MAX_LOAD_NUM = 3;
+        static size_t const MAX_LOAD_DEN = 4;
+        /* ... shrink when it falls below 1/8 */
+        static size_t const MIN_LOAD_DEN = 8;
+
+        /* Returns position of the matching entry, or of the empty slot
+         * where it should be inserted. */
+        size_t lookup(const KeyEntryNG& ke) const
+        {
+            assert(size_ < capacity());
+
+            size_t pos(ke.hash() & mask_);
+
+            while (!slots_[pos].empty() && !slots_[pos].matches(ke))
+            {
+                pos = (pos + 1) & mask_;
+            }
+
+            return pos;
+        }
+
+        static KeyEntryNG* allocate(size_t const cap)
+        {
+            void* ptr(nullptr);
+            size_t const size(cap * sizeof(KeyEntryNG));
+
+            if (::posix_memalign(&ptr, GU_CACHE_LINE_SIZE, size))
+            {
+                gu_throw_error(ENOMEM) << "Could not allocate " << size
+                                       << " bytes for certification index";
+            }
+
+            KeyEntryNG* const slots(static_cast<KeyEntryNG*>(ptr));
+            for (size_t i(0); i < cap; ++i) new (slots + i) KeyEntryNG();
+
+            return slots;
+        }
+
+        static void destroy(KeyEntryNG* const slots, size_t const cap)
+        {
+            for (size_t i(0); i < cap; ++i) slots[i].~KeyEntryNG();
+            ::free(slots);
+        }
+
+        void rehash(size_t const cap)
+        {
+            assert(cap >= MIN_CAPACITY);
+            assert((cap & (cap - 1)) == 0);
+            assert(size_ < cap);
+
+            KeyEntryNG* const old_slots(slots_);
+            size_t const      old_cap(capacity());
+
+            slots_ = allocate(cap);
+            mask_  = cap - 1;
+
+            for (size_t i(0); i < old_cap; ++i)
+            {
+                KeyEntryNG& ke(old_slots[i]);
+                if (ke.empty()) continue;
+
+                size_t pos(ke.hash() & mask_);
+                while (!slots_[pos].empty()) pos = (pos + 1) & mask_;
+
+                slots_[pos].swap(ke);
+            }
+
+            destroy(old_slots, old_cap);
+        }
+
+        KeyEntryNG* slots_;
+        size_t      mask_;
+        size_t      size_;
+    };
+}
+
+#endif // GALERA_KEY_ENTRY_TABLE_NG_HPP
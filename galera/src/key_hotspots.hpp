@@ -0,0 +1,269 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+//!
+// @file key_hotspots.hpp
+//
+// Bounded top-K tracking of certification index hot spots.
+//
+// Every certification conflict or dependency is recorded for the key part
+// (key prefix) it was detected on. Frequencies are estimated with a
+// count-min sketch of fixed size with conservative update, and the K most
+// frequent key parts are kept in a min-heap by count next to it, indexed
+// by key part hash. Text description of the key part is only made when it
+// enters top-K, so the per-event cost is a few counter increments, a hash
+// lookup and O(log K) heap update.
+//
+// Counts are approximate: the sketch may overestimate, but never
+// underestimates the frequency of a key part.
+//
+
+#ifndef GALERA_KEY_HOTSPOTS_HPP
+#define GALERA_KEY_HOTSPOTS_HPP
+
+#include "key_set.hpp"
+
+#include "gu_unordered.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace galera
+{
+    class KeyHotspots
+    {
+    public:
+
+        enum Kind
+        {
+            CONFLICT,
+            DEPENDENCY,
+            KIND_MAX
+        };
+
+        static size_t const MAX_SIZE = 1024;
+
+        explicit KeyHotspots(size_t const size = 0) : sketch_(), size_(0)
+        {
+            resize(size);
+        }
+
+        /* Number of top entries tracked for each kind, 0 means disabled */
+        size_t size()    const { return size_; }
+        bool   enabled() const { return size_ > 0; }
+
+        /* Changes the number of tracked entries, clears all counts */
+        void resize(size_t const size)
+        {
+            assert(size <= MAX_SIZE);
+
+            size_ = size;
+
+            for (int k(0); k < KIND_MAX; ++k)
+            {
+                sketch_[k].counters.assign(size_ ? DEPTH * WIDTH : 0, 0);
+                sketch_[k].top.clear();
+                sketch_[k].top.reserve(size_);
+                sketch_[k].index.clear();
+                sketch_[k].index.rehash(size_);
+            }
+        }
+
+        void clear() { resize(size_); }
+
+        void record(Kind const kind, const KeySet::KeyPart& key)
+        {
+            assert(enabled());
+            assert(kind < KIND_MAX);
+
+            Sketch& s(sketch_[kind]);
+
+            uint64_t w0, w1;
+            key.hash_words(w0, w1);
+
+            uint32_t* cnt[DEPTH];
+            uint32_t  est(std::numeric_limits<uint32_t>::max());
+
+            for (size_t d(0); d < DEPTH; ++d)
+            {
+                cnt[d] = &s.counters[d * WIDTH + slot(d, w0, w1)];
+                est = std::min(est, *cnt[d]);
+            }
+
+            if (gu_unlikely(est == std::numeric_limits<uint32_t>::max()))
+                return; // saturated
+
+            /* conservative update: only the smallest counters are bumped */
+            for (size_t d(0); d < DEPTH; ++d)
+            {
+                if (*cnt[d] == est) ++(*cnt[d]);
+            }
+            ++est;
+
+            Id const id(w0, w1);
+            Index::iterator const i(s.index.find(id));
+
+            if (i != s.index.end())
+            {
+                /* estimates never decrease, so the entry can only sink */
+                assert(s.top[i->second].count <= est);
+                s.top[i->second].count = est;
+                sift_down(s, i->second);
+            }
+            else if (s.top.size() < size_)
+            {
+                s.top.push_back(Entry(w0, w1, est, key));
+                s.index.insert(std::make_pair(id, s.top.size() - 1));
+                sift_up(s, s.top.size() - 1);
+            }
+            else if (s.top[0].count < est)
+            {
+                s.index.erase(s.index.find(s.top[0].id()));
+                s.top[0] = Entry(w0, w1, est, key);
+                s.index.insert(std::make_pair(id, size_t(0)));
+                sift_down(s, 0);
+            }
+        }
+
+        /* Prints top entries of a kind in the order of decreasing count
+         * as a semicolon separated list of count:key */
+        void print(std::ostream& os, Kind const kind) const
+        {
+            assert(kind < KIND_MAX);
+
+            std::vector<const Entry*> top;
+            top.reserve(sketch_[kind].top.size());
+
+            for (size_t i(0); i < sketch_[kind].top.size(); ++i)
+            {
+                top.push_back(&sketch_[kind].top[i]);
+            }
+
+            std::stable_sort(top.begin(), top.end(),
+                             [](const Entry* l, const Entry* r)
+                             { return l->count > r->count; });
+
+            for (size_t i(0); i < top.size(); ++i)
+            {
+                if (i) os << "; ";
+                os << top[i]->count << ':' << top[i]->key;
+            }
+        }
+
+        std::string str(Kind const kind) const
+        {
+            std::ostringstream os;
+            print(os, kind);
+            return os.str();
+        }
+
+    private:
+
+        /* sketch dimensions: 4 rows of 1024 counters, 16K per kind */
+        static size_t const DEPTH = 4;
+        static size_t const WIDTH = 1 << 10;
+
+        static size_t slot(size_t const row, uint64_t const w0,
+                           uint64_t const w1)
+        {
+            /* independent multiplicative hash per row */
+            static uint64_t const seeds[DEPTH] =
+            {
+                0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL,
+                0x165667b19e3779f9ULL, 0xd6e8feb86659fd93ULL
+            };
+
+            uint64_t const h((w0 ^ (w1 + row)) * seeds[row]);
+            return (h >> 54) & (WIDTH - 1);
+        }
+
+        typedef std::pair<uint64_t, uint64_t> Id;
+
+        struct Entry
+        {
+            Entry(uint64_t const a, uint64_t const b, uint32_t const c,
+                  const KeySet::KeyPart& kp)
+                : w0(a), w1(b), count(c), key()
+            {
+                std::ostringstream os;
+                os << kp;
+                key = os.str();
+            }
+
+            Id id() const { return Id(w0, w1); }
+
+            uint64_t    w0;
+            uint64_t    w1;
+            uint32_t    count;
+            std::string key;
+        };
+
+        struct IdHash
+        {
+            /* key part hash words are well mixed already */
+            size_t operator()(const Id& id) const
+            {
+                return size_t(id.first ^ id.second);
+            }
+        };
+
+        typedef gu::UnorderedMap<Id, size_t, IdHash> Index;
+
+        struct Sketch
+        {
+            Sketch() : counters(), top(), index() {}
+
+            std::vector<uint32_t> counters;
+            std::vector<Entry>    top;   // min-heap by count
+            Index                 index; // entry position in top
+        };
+
+        static void swap_entries(Sketch& s, size_t const a, size_t const b)
+        {
+            std::swap(s.top[a], s.top[b]);
+            s.index.find(s.top[a].id())->second = a;
+            s.index.find(s.top[b].id())->second = b;
+        }
+
+        static void sift_up(Sketch& s, size_t i)
+        {
+            while (i > 0)
+            {
+                size_t const parent((i - 1) / 2);
+
+                if (s.top[parent].count <= s.top[i].count) break;
+
+                swap_entries(s, i, parent);
+                i = parent;
+            }
+        }
+
+        static void sift_down(Sketch& s, size_t i)
+        {
+            size_t const n(s.top.size());
+
+            for (size_t child(2*i + 1); child < n; child = 2*i + 1)
+            {
+                if (child + 1 < n &&
+                    s.top[child + 1].count < s.top[child].count) ++child;
+
+                if (s.top[i].count <= s.top[child].count) break;
+
+                swap_entries(s, i, child);
+                i = child;
+            }
+        }
+
+        Sketch sketch_[KIND_MAX];
+        size_t size_;
+    };
+}
+
+#endif // GALERA_KEY_HOTSPOTS_HPP
@@ -1,5 +1,5 @@
 //
-// Copyright (C) 2013-2024 Codership Oy <info@codership.com>
+// Copyright (C) 2013-2026 Codership Oy <info@codership.com>
 //
 
 #include "key_set.hpp"
@@ -21,7 +21,7 @@ KeySet::throw_version(int ver)
 
 static const char* ver_str[KeySet::MAX_VERSION + 1] =
 {
-    "EMPTY", "FLAT8", "FLAT8A", "FLAT16", "FLAT16A"
+    "EMPTY", "FLAT8", "FLAT8A", "FLAT16", "FLAT16A", "TREE8"
 };
 
 KeySet::Version
@@ -148,6 +148,43 @@ KeySet::KeyPart::print_annotation(std::ostream& os, const gu::byte_t* buf)
     }
 }
 
+size_t
+KeySet::KeyPart::store_tree_part (const wsrep_buf_t& part,
+                                  int          const part_num,
+                                  gu::byte_t*        buf,
+                                  int          const size,
+                                  int          const alignment)
+{
+    static size_t const hdr_size(TREE_VALUE_OFF - TREE_DEPTH_OFF +
+                                 sizeof(ann_size_t));
+
+    assert(size > 0 && size_t(size) >= GU_ALIGN(hdr_size, alignment));
+
+    if (gu_unlikely(part_num > TREE_DEPTH_MAX))
+    {
+        gu_throw_error(EINVAL) << "Too many key parts: " << part_num + 1;
+    }
+
+    /* longer values are truncated to what fits in the buffer, the hash
+     * still covers the whole value */
+    size_t const max_len(size / alignment * alignment - hdr_size);
+    uint16_t const len(std::min(part.len, max_len));
+
+    ann_size_t const tail_size(GU_ALIGN(hdr_size + len, alignment));
+    assert(tail_size <= size);
+
+    *reinterpret_cast<ann_size_t*>(buf) = gu::htog(tail_size);
+    *reinterpret_cast<uint16_t*>(buf + TREE_DEPTH_OFF - 8) =
+        gu::htog<uint16_t>(part_num);
+    *reinterpret_cast<uint16_t*>(buf + TREE_LEN_OFF - 8) = gu::htog(len);
+
+    const gu::byte_t* const from(static_cast<const gu::byte_t*>(part.ptr));
+    std::copy(from, from + len, buf + hdr_size);
+    ::memset(buf + hdr_size + len, 0, tail_size - hdr_size - len);
+
+    return tail_size;
+}
+
 void
 KeySet::KeyPart::throw_buffer_too_short (size_t expected, size_t got)
 {
@@ -212,6 +249,13 @@ KeySet::KeyPart::print (std::ostream& os) const
         os << "=";
         print_annotation (os, data_ + size);
     }
+    else if (TREE8 == ver)
+    {
+        wsrep_buf_t const val(value());
+        os << '=' << depth() << ':'
+           << gu::Hexdump(val.ptr, val.len, true);
+        if (repeat()) os << " (repeat)";
+    }
 }
 
 /* returns true if left type is stronger than right */
@@ -228,9 +272,11 @@ KeySetOut::KeyPart::KeyPart (KeyParts&      added,
                              const KeyData& kd,
                              int const      part_num,
                              int const      ws_ver,
-                             int const      alignment)
+                             int const      alignment,
+                             const gu::Hash* const hashed,
+                             const KeySet::KeyPart::HashData* const digest)
     :
-    hash_ (parent->hash_),
+    hash_ (hashed ? *hashed : parent->hash_),
     part_ (0),
     value_(static_cast<const gu::byte_t*>(kd.parts[part_num].ptr)),
     size_ (kd.parts[part_num].len),
@@ -238,14 +284,20 @@ KeySetOut::KeyPart::KeyPart (KeyParts&      added,
     own_  (false)
 {
     assert (ver_);
-    uint32_t const s(gu::htog(size_));
-    hash_.append (&s, sizeof(s));
-    hash_.append (value_, size_);
+    assert (!hashed == !digest);
 
     KeySet::KeyPart::TmpStore ts;
     KeySet::KeyPart::HashData hd;
 
-    hash_.gather<sizeof(hd.buf)>(hd.buf);
+    if (hashed)
+    {
+        hd = *digest;
+    }
+    else
+    {
+        hash_value (hash_, value_, size_);
+        hash_.gather<sizeof(hd.buf)>(hd.buf);
+    }
 
     /* only leaf part of the key can be not of branch type */
     bool const leaf (part_num + 1 == kd.parts_num);
@@ -296,6 +348,14 @@ KeySetOut::KeyPart::KeyPart (KeyParts&      added,
 #endif
             throw DUPLICATE();
         }
+        else if (KeySet::TREE8 == ver_)
+        {
+            /* Branch part duplicate. In the tree format the key parts that
+               follow refer to it as a parent, so it must be stored again
+               at this position, marked to be skipped in certification. */
+            KeySet::KeyPart::mark_repeat(ts);
+            kp.store (store);
+        }
     }
 
     part_ = &(*inserted.first);
@@ -320,9 +380,10 @@ KeySetOut::KeyPart::print (std::ostream& os) const
 #define KSO_APPEND_DEBUG(...)
 #endif
 
-int KeySetOut::find_common_ancestor_with_previous(const KeyData& kd) const
+int KeySetOut::find_common_ancestor_with_previous(const KeyData& kd,
+                                                  int const from) const
 {
-    int i(0);
+    int i(from);
     for (;
          i < kd.parts_num &&
              size_t(i + 1) < prev_.size() &&
@@ -338,10 +399,78 @@ int KeySetOut::find_common_ancestor_with_previous(const KeyData& kd) const
     return i;
 }
 
+bool KeySetOut::leaf_sibling_of_previous(const KeyData& kd) const
+{
+    int const leaf(kd.parts_num - 1);
+
+    if (leaf < 0 || size_t(leaf) >= prev_.size()) return false;
+
+    for (int i(0); i < leaf; ++i)
+    {
+        if (!prev_[i + 1].match(kd.parts[i].ptr, kd.parts[i].len)) return false;
+    }
+
+    return true;
+}
+
+size_t
+KeySetOut::append (const KeyData* const kds, size_t const n)
+{
+    gu::Hash                  hashed[HASH_BATCH];
+    KeySet::KeyPart::HashData digest[HASH_BATCH];
+    size_t ret(0);
+
+    for (size_t k(0); k < n;)
+    {
+        /* Parent parts of the siblings stay in prev_ while the siblings are
+         * appended, so the leaves can be hashed in advance. */
+        int const parts_num(kds[k].parts_num);
+        size_t m(0);
+        while (m < HASH_BATCH && k + m < n &&
+               kds[k + m].parts_num == parts_num &&
+               leaf_sibling_of_previous(kds[k + m]))
+        {
+            ++m;
+        }
+
+        if (m < 2)
+        {
+            ret += append(kds[k]);
+            ++k;
+            continue;
+        }
+
+        int const leaf(parts_num - 1);
+        const gu::Hash& parent(prev_[leaf].hash());
+
+        for (size_t j(0); j < m; ++j)
+        {
+            const wsrep_buf_t& v(kds[k + j].parts[leaf]);
+            hashed[j] = parent;
+            KeyPart::hash_value(hashed[j], v.ptr, v.len);
+        }
+
+        GU_COMPILE_ASSERT(sizeof(digest[0]) == 16, digest_size);
+        gu::Hash::gather16(hashed, m, digest);
+
+        for (size_t j(0); j < m; ++j)
+        {
+            ret += append(kds[k + j], &hashed[j], &digest[j]);
+        }
+
+        k += m;
+    }
+
+    return ret;
+}
+
 size_t
-KeySetOut::append (const KeyData& kd)
+KeySetOut::append (const KeyData& kd, const gu::Hash* const leaf_hashed,
+                   const KeySet::KeyPart::HashData* const leaf_digest)
 {
-    int i = find_common_ancestor_with_previous(kd);
+    /* pre-hashed keys are known to share the parent with the previous key */
+    int i = find_common_ancestor_with_previous(kd, leaf_hashed ?
+                                               kd.parts_num - 1 : 0);
 
     KSO_APPEND_DEBUG("Append " << kd);
     /* if we have a fully matched key OR common ancestor is stronger, return */
@@ -393,6 +522,7 @@ KeySetOut::append (const KeyData& kd)
     int const anc(i);
     KSO_APPEND_DEBUG("Append key parts after ancestor " << i);
     const KeyPart* parent(&prev_[anc]);
+    assert(!leaf_hashed || anc + 1 == kd.parts_num);
 
     /* create parts that didn't match previous key and add to the set
      * of previously added keys. */
@@ -402,7 +532,8 @@ KeySetOut::append (const KeyData& kd)
     {
         try
         {
-            KeyPart kp(added_, *this, parent, kd, i, ws_ver_, alignment());
+            KeyPart kp(added_, *this, parent, kd, i, ws_ver_, alignment(),
+                       leaf_hashed, leaf_digest);
             if (size_t(j) < new_.size())
             {
                 new_[j] = kp;
@@ -419,15 +550,18 @@ KeySetOut::append (const KeyData& kd)
             /* There is a very small probability that child part throws DUPLICATE
              * even after parent was added as a new key. It does not matter:
              * a duplicate will be a duplicate in certification as well. */
-            goto out;
+            if (KeySet::TREE8 != version_) goto out;
+            /* In the tree format the parts stored so far are the ancestors
+             * for the next key, so they must be remembered. */
+            break;
         }
     }
 
-    assert (i == kd.parts_num);
-    assert (anc + j == kd.parts_num);
+    assert (i == kd.parts_num || KeySet::TREE8 == version_);
+    assert (anc + j == i);
 
     /* copy new parts to prev_ */
-    prev_().resize(1 + kd.parts_num);
+    prev_().resize(1 + i);
     std::copy(new_().begin(), new_().begin() + j, prev_().begin() + anc + 1);
 
     /* acquire key part value if it is volatile */
@@ -443,4 +577,12 @@ out:
 
 #undef KSO_APPEND_DEBUG
 
+void
+KeySetIn::throw_orphan (size_t const depth) const
+{
+    gu_throw_error(EPROTO) << "Malformed " << ver_str[version_]
+                           << " key set: key part at depth " << depth
+                           << " follows depth " << path_.size();
+}
+
 } /* namespace galera */
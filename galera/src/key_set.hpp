@@ -1,5 +1,5 @@
 //
-// Copyright (C) 2013-2018 Codership Oy <info@codership.com>
+// Copyright (C) 2013-2026 Codership Oy <info@codership.com>
 //
 
 
@@ -30,8 +30,8 @@ public:
         FLAT8A,   /*  8-byte hash (flat), annotated */
         FLAT16,   /* 16-byte hash (flat) */
         FLAT16A,  /* 16-byte hash (flat), annotated */
-//      TREE8,    /*  8-byte hash + full serialized key */
-        MAX_VERSION = FLAT16A
+        TREE8,    /*  8-byte hash + key part value, parts form a prefix tree */
+        MAX_VERSION = TREE8
     };
 
     static Version version (unsigned int ver)
@@ -117,6 +117,13 @@ public:
                                  sizeof(tmp.buf) - key_size,
                                  alignment);
             }
+            else if (TREE8 == ver)
+            {
+                store_tree_part(parts[part_num], part_num,
+                                tmp.buf + key_size,
+                                sizeof(tmp.buf) - key_size,
+                                alignment);
+            }
         }
 
         /* This ctor uses pointer to a permanently stored serialized key part */
@@ -199,6 +206,44 @@ public:
 
         Version version() const { return KeyPart::version(data_); }
 
+        /* TREE8 only: position of the part in the key, 0 for the first one.
+         * The parent of the part is the last preceding part one level up. */
+        int depth() const
+        {
+            assert(TREE8 == version());
+            return tree_depth_word() & ~TREE_REPEAT;
+        }
+
+        /* TREE8 branch part which is stored again only to be the parent of
+         * the following parts. An equal part of the same type precedes it in
+         * the key set, so it must be skipped in certification. */
+        bool repeat() const
+        {
+            return TREE8 == version() && (tree_depth_word() & TREE_REPEAT);
+        }
+
+        /* marks TREE8 key part created in tmp store as a repeat */
+        static void mark_repeat(TmpStore& tmp)
+        {
+            uint16_t* const d(reinterpret_cast<uint16_t*>
+                              (tmp.buf + TREE_DEPTH_OFF));
+            *d = gu::htog<uint16_t>(gu::gtoh(*d) | TREE_REPEAT);
+        }
+
+        /* TREE8 only: value of this part of the key (the values longer than
+         * fit in TmpStore are truncated) */
+        wsrep_buf_t value() const
+        {
+            assert(TREE8 == version());
+            wsrep_buf_t const ret =
+            {
+                data_ + TREE_VALUE_OFF,
+                gu::gtoh(*reinterpret_cast<const uint16_t*>
+                         (data_ + TREE_LEN_OFF))
+            };
+            return ret;
+        }
+
         KeyPart (const KeyPart& k) : data_(k.data_) {}
 
         KeyPart& operator= (const KeyPart& k) { data_ = k.data_; return *this; }
@@ -219,31 +264,42 @@ public:
             const uint32_t* rhs(reinterpret_cast<const uint32_t*>(kp.data_));
 #endif /* WORDSIZE */
 
-            switch (std::min(version(), kp.version()))
+            Version const min_ver(std::min(version(), kp.version()));
+
+            switch (min_ver)
             {
             case EMPTY:
                 assert(0);
                 throw_match_empty_key(version(), kp.version());
+            case TREE8:
+                /* both carry the value, so hash collisions are ruled out
+                 * unless the values were truncated (see value()) */
+                ret = tree_value_matches(kp);
+                break;
             case FLAT16:
             case FLAT16A:
+                /* TREE8 has only 8-byte hash */
+                if (std::max(version(), kp.version()) == TREE8) break;
 #if GU_WORDSIZE == 64
                 ret = (lhs[1] == rhs[1]);
 #else
                 ret = (lhs[2] == rhs[2] && lhs[3] == rhs[3]);
 #endif /* WORDSIZE */
-                /* fall through */
+                break;
             case FLAT8:
             case FLAT8A:
-                /* shift is to clear up the header */
+                break;
+            }
+
+            /* shift is to clear up the header */
 #if GU_WORDSIZE == 64
-                ret = ret && ((gtoh64(lhs[0]) >> HEADER_BITS) ==
-                              (gtoh64(rhs[0]) >> HEADER_BITS));
+            ret = ret && ((gtoh64(lhs[0]) >> HEADER_BITS) ==
+                          (gtoh64(rhs[0]) >> HEADER_BITS));
 #else
-                ret = ret && (lhs[1] == rhs[1] &&
-                              (gtoh32(lhs[0]) >> HEADER_BITS) ==
-                              (gtoh32(rhs[0]) >> HEADER_BITS));
+            ret = ret && (lhs[1] == rhs[1] &&
+                          (gtoh32(lhs[0]) >> HEADER_BITS) ==
+                          (gtoh32(rhs[0]) >> HEADER_BITS));
 #endif /* WORDSIZE */
-            }
 
             return ret;
         }
@@ -259,6 +315,24 @@ public:
             return ret; // (ret ^ (ret << HEADER_BITS)) to cover 0 bits
         }
 
+        /* Key hash as two host order 64-bit words for storing it inline in
+         * flat hash tables. Header bits are cleared from the first word,
+         * the second word is 0 for 8-byte hash versions. Returns true if
+         * the hash is 16 bytes long. */
+        bool
+        hash_words (uint64_t& w0, uint64_t& w1) const
+        {
+            const uint64_t* const words
+                (reinterpret_cast<const uint64_t*>(data_));
+            Version const ver(version());
+            bool const wide(FLAT16 == ver || FLAT16A == ver);
+
+            w0 = gu::gtoh(words[0]) >> HEADER_BITS;
+            w1 = wide ? gu::gtoh(words[1]) : 0;
+
+            return wide;
+        }
+
         static size_t
         serial_size (const gu::byte_t* const buf, size_t const size)
         {
@@ -319,6 +393,7 @@ public:
                 return 16;
             case FLAT8:
             case FLAT8A:
+            case TREE8:
                 return 8;
             case EMPTY: assert(0);
             }
@@ -334,6 +409,32 @@ public:
 
         typedef uint16_t ann_size_t;
 
+        /* TREE8 key part layout following the hash:
+         * ann_size_t total size of the tail (aligned),
+         * uint16_t   depth, the highest bit marks a repeat,
+         * uint16_t   value length,
+         * value bytes and padding */
+        static size_t const TREE_DEPTH_OFF = 8 + sizeof(ann_size_t);
+        static size_t const TREE_LEN_OFF   = TREE_DEPTH_OFF + sizeof(uint16_t);
+        static size_t const TREE_VALUE_OFF = TREE_LEN_OFF + sizeof(uint16_t);
+        static uint16_t const TREE_REPEAT  = 0x8000;
+        static int const      TREE_DEPTH_MAX = TREE_REPEAT - 1;
+
+        uint16_t tree_depth_word() const
+        {
+            return gu::gtoh(*reinterpret_cast<const uint16_t*>
+                            (data_ + TREE_DEPTH_OFF));
+        }
+
+        bool
+        tree_value_matches (const KeyPart& kp) const
+        {
+            wsrep_buf_t const l(value());
+            wsrep_buf_t const r(kp.value());
+
+            return (l.len == r.len && !::memcmp(l.ptr, r.ptr, l.len));
+        }
+
         static size_t
         serial_size (Version const ver,
                      const gu::byte_t* const buf, size_t const size = -1U)
@@ -342,7 +443,7 @@ public:
 
             assert (ret <= size);
 
-            if (annotated(ver))
+            if (annotated(ver) || TREE8 == ver)
             {
                 assert (ret + 2 <= size);
                 ret +=gu::gtoh(*reinterpret_cast<const ann_size_t*>(buf + ret));
@@ -359,6 +460,10 @@ public:
         static void
         print_annotation (std::ostream& os, const gu::byte_t* buf);
 
+        static size_t
+        store_tree_part (const wsrep_buf_t& part, int part_num,
+                         gu::byte_t* buf, int size, int alignment);
+
         static void
         throw_buffer_too_short (size_t expected, size_t got) GU_NORETURN;
         static void
@@ -526,6 +631,17 @@ public:
                                              res.second);
         }
 
+        /* Prepares the set for the given total number of keys, so that
+         * the heap-based set does not have to be rehashed as it grows. */
+        void reserve(size_t const n)
+        {
+            if (n <= FIRST_SIZE) return;
+
+            if (!second_) second_ = new KeyPartSet();
+
+            second_->rehash(n - first_size_);
+        }
+
         iterator erase(iterator it)
         {
             unsigned int idx(it->hash());
@@ -552,7 +668,10 @@ public:
             return end();
         }
 
-        size_t size() const { return (first_size_ + second_->size()); }
+        size_t size() const
+        {
+            return (first_size_ + (second_ ? second_->size() : 0));
+        }
 
     private:
 
@@ -585,13 +704,17 @@ public:
         /* to throw in KeyPart() ctor in case it is a duplicate */
         class DUPLICATE {};
 
+        /* hashed and digest, if given, are the hash state and digest of
+         * this part computed in advance by hash_value() */
         KeyPart (KeyParts&      added,
                  KeySetOut&     store,
                  const KeyPart* parent,
                  const KeyData& kd,
                  int const      part_num,
                  int const      ws_ver,
-                 int const      alignment);
+                 int const      alignment,
+                 const gu::Hash* hashed = NULL,
+                 const KeySet::KeyPart::HashData* digest = NULL);
 
         KeyPart (const KeyPart& k)
         :
@@ -631,6 +754,18 @@ public:
         int
         prefix() const { return (part_ ? part_->prefix() : 0); }
 
+        const gu::Hash&
+        hash() const { return hash_; }
+
+        /* appends part value to the hash of its parent */
+        static void
+        hash_value (gu::Hash& hash, const void* const v, unsigned int const s)
+        {
+            uint32_t const ss(gu::htog(s));
+            hash.append (&ss, sizeof(ss));
+            hash.append (v, s);
+        }
+
         void
         acquire()
         {
@@ -691,7 +826,7 @@ public:
             reserved,
             reserved_size,
             base_name,
-            check_type(version),
+            check_type(version, rsv),
             rsv
             ),
         added_(),
@@ -710,7 +845,20 @@ public:
     ~KeySetOut () {}
 
     size_t
-    append (const KeyData& kd);
+    append (const KeyData& kd) { return append(kd, NULL, NULL); }
+
+    /* Appends n keys. Consecutive keys that differ only in the leaf part,
+     * like rows of the same table, have their leaf hashes computed in
+     * a batch (in SIMD lanes where supported). Returns the total size
+     * increase. */
+    size_t
+    append (const KeyData* kds, size_t n);
+
+    /* Hints that about this many more key parts are going to be appended,
+     * e.g. by a bulk insert. Saves growing the set of appended key parts
+     * step by step. */
+    void
+    reserve (size_t const parts) { added_.reserve(added_.size() + parts); }
 
     KeySet::Version
     version () { return count() ? version_ : KeySet::EMPTY; }
@@ -724,14 +872,25 @@ private:
     KeySet::Version       version_;
     int                   ws_ver_;
 
-    int find_common_ancestor_with_previous(const KeyData&) const;
+    /* maximum number of keys which leaf parts are hashed in one batch */
+    static size_t const HASH_BATCH = 16;
+
+    size_t
+    append (const KeyData& kd, const gu::Hash* leaf_hashed,
+            const KeySet::KeyPart::HashData* leaf_digest);
+
+    /* from is the number of leading key parts known to match */
+    int find_common_ancestor_with_previous(const KeyData&, int from = 0) const;
+
+    /* true if kd is a sibling of the previous key: has the same parent */
+    bool leaf_sibling_of_previous(const KeyData& kd) const;
     static gu::RecordSet::CheckType
-    check_type (KeySet::Version ver)
+    check_type (KeySet::Version ver, gu::RecordSet::Version rsv)
     {
         switch (ver)
         {
         case KeySet::EMPTY: break; /* Can't create EMPTY KeySetOut */
-        default: return gu::RecordSet::CHECK_MMH128;
+        default: return gu::RecordSet::payload_check_type(rsv);
         }
 
         KeySet::throw_version(ver);
@@ -752,27 +911,64 @@ class KeySetIn : public gu::RecordSetIn<KeySet::KeyPart>
 {
 public:
 
+    typedef gu::RecordSetIn<KeySet::KeyPart> Base;
+
     KeySetIn (KeySet::Version ver, const gu::byte_t* buf, size_t size)
         :
-        gu::RecordSetIn<KeySet::KeyPart>(buf, size, false),
-        version_(ver)
+        Base(buf, size, false),
+        version_(ver),
+        path_()
     {}
 
-    KeySetIn () : gu::RecordSetIn<KeySet::KeyPart>(), version_(KeySet::EMPTY) {}
+    KeySetIn () : Base(), version_(KeySet::EMPTY), path_() {}
 
     void init (KeySet::Version ver, const gu::byte_t* buf, size_t size)
     {
-        gu::RecordSetIn<KeySet::KeyPart>::init(buf, size, false);
+        Base::init(buf, size, false);
         version_ = ver;
+        path_.clear();
     }
 
     KeySet::KeyPart const
-    next () const { return gu::RecordSetIn<KeySet::KeyPart>::next(); }
+    next () const
+    {
+        KeySet::KeyPart const kp(Base::next());
+
+        if (KeySet::TREE8 == version_) walk(kp);
+
+        return kp;
+    }
+
+    void rewind () const { Base::rewind(); path_.clear(); }
+
+    /* TREE8 only: the key which the part last returned by next() belongs
+     * to, from the first part (0) to that part (path_size() - 1) */
+    int path_size () const { return path_.size(); }
+
+    const KeySet::KeyPart& path (int const i) const
+    {
+        assert(size_t(i) < path_.size());
+        return path_[i];
+    }
 
 private:
 
     KeySet::Version version_;
 
+    mutable std::vector<KeySet::KeyPart> path_;
+
+    void walk (const KeySet::KeyPart& kp) const
+    {
+        size_t const depth(kp.depth());
+
+        if (gu_unlikely(depth > path_.size())) throw_orphan(depth);
+
+        path_.resize(depth);
+        path_.push_back(kp);
+    }
+
+    void throw_orphan (size_t depth) const GU_NORETURN;
+
 }; /* class KeySetIn */
 
 #if defined(__GNUG__)
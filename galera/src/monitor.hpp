@@ -7,10 +7,18 @@
 
 #include "trx_handle.hpp"
 #include <gu_lock.hpp> // for gu::Mutex and gu::Cond
+#include <gu_atomic.hpp>
+#include <gu_histogram.hpp>
 #include <gu_limits.h>
+#include <gu_time.h>
 #include "gu_thread_keys.hpp"
 
+#include <sys/mman.h> // madvise()
+#include <unistd.h>   // sysconf()
+
+#include <algorithm>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace galera
@@ -20,7 +28,9 @@ namespace galera
     {
     private:
 
-        struct Process
+        // Slots are padded to cache line size so that threads working
+        // on adjacent seqnos don't false-share.
+        struct alignas(GU_CACHE_LINE_SIZE) Process
         {
             Process()
                 : obj_(0)
@@ -77,30 +87,51 @@ namespace galera
             void operator=(const Process&);
         };
 
-        static const ssize_t process_size_ = (1ULL << 16);
-        static const size_t  process_mask_ = process_size_ - 1;
+        static const size_t huge_page_size_ = (1ULL << 21);
+
+        // Waits longer than this on average are not worth spinning for,
+        // roughly the cost of a couple of context switches, ns
+        static const long long spin_max_ = 20000;
     public:
 
-        Monitor(enum gu::MutexKey mutex_key, enum gu::CondKey cond_key)
+        static const size_t DEFAULT_SIZE = (1ULL << 16);
+        static const size_t MIN_SIZE     = (1ULL << 8);
+
+        // size is the number of process slots: the maximum distance between
+        // last left and the seqno which can enter the monitor, it is
+        // rounded up to the power of 2.
+        Monitor(enum gu::MutexKey mutex_key, enum gu::CondKey cond_key,
+                size_t const size = DEFAULT_SIZE)
             :
+            process_size_(window_size(size)),
+            process_mask_(process_size_ - 1),
             mutex_(gu::get_mutex_key(mutex_key)),
             cond_key_(cond_key),
             cond_(gu::get_cond_key(cond_key)),
             uuid_(WSREP_UUID_UNDEFINED),
             last_entered_(-1),
             last_left_(-1),
+            last_entered_pub_(-1),
+            last_left_pub_(-1),
             drain_seqno_(GU_LLONG_MAX),
-            process_(new Process[process_size_]),
+            drain_seqno_pub_(GU_LLONG_MAX),
+            process_(allocate(process_size_)),
             entered_(0),
             oooe_(0),
             oool_(0),
             win_size_(0),
-            waits_(0)
+            waits_(0),
+            deps_waiters_(0),
+            spin_(sysconf(_SC_NPROCESSORS_ONLN) > 1),
+            spin_force_(0),
+            wait_avg_(0),
+            wait_cnt_(0),
+            wait_hs_("0.0,0.000001,0.00001,0.0001,0.001,0.01,0.1,1.0")
         { }
 
         ~Monitor()
         {
-            delete[] process_;
+            destroy(process_, process_size_);
             if (entered_ > 0)
             {
                 log_info << "mon: entered " << entered_
@@ -136,13 +167,14 @@ namespace galera
             if (last_entered_ == -1 || seqno == -1)
             {
                 // first call or reset
-                last_entered_ = last_left_ = seqno;
+                set_last_entered(seqno);
+                set_last_left(seqno);
             }
             else
 #if 1 // now
             {
-                if (last_left_    < seqno)      last_left_    = seqno;
-                if (last_entered_ < last_left_) last_entered_ = last_left_;
+                if (last_left_    < seqno)      set_last_left(seqno);
+                if (last_entered_ < last_left_) set_last_entered(last_left_);
             }
 
             // some drainers may wait for us here
@@ -186,15 +218,37 @@ namespace galera
 #ifdef GU_DBUG_ON
                 obj.debug_sync(mutex_);
 #endif // GU_DBUG_ON
+                int const deps(obj.deps_count() > 0);
+                deps_waiters_ += deps;
+
+                long long wait_start(0);
+
                 while (may_enter(obj) == false &&
                        process_[idx].state_ == Process::S_WAITING)
                 {
+                    // Spin only before parking for the first time: once
+                    // parked the thread is woken up when it may enter, so
+                    // a (rare) wakeup that finds it still waiting goes
+                    // straight back to wait. The slot may have been
+                    // entered or canceled while mutex_ was released for
+                    // spinning without signaling, so always recheck.
+                    if (0 == wait_start)
+                    {
+                        wait_start = gu_time_monotonic();
+                        spin(obj, lock);
+                        continue;
+                    }
+
                     process_[idx].cond_ = obj.cond();
                     ++waits_;
                     lock.wait(*process_[idx].cond_);
                     process_[idx].cond_ = 0;
                 }
 
+                deps_waiters_ -= deps;
+
+                if (wait_start) record_wait(gu_time_monotonic() - wait_start);
+
                 if (process_[idx].state_ != Process::S_CANCELED)
                 {
                     assert(process_[idx].state_ == Process::S_WAITING ||
@@ -278,7 +332,7 @@ namespace galera
             new (&process_[idx].dobj_) C(obj);
 #endif /* NDEBUG */
 
-            if (obj_seqno > last_entered_) last_entered_ = obj_seqno;
+            if (obj_seqno > last_entered_) set_last_entered(obj_seqno);
 
             if (obj_seqno <= drain_seqno_)
             {
@@ -327,17 +381,10 @@ namespace galera
             return false;
         }
 
-        wsrep_seqno_t last_left() const
-        {
-            gu::Lock lock(mutex_);
-            return last_left_;
-        }
-
-        wsrep_seqno_t last_entered() const
-        {
-            gu::Lock lock(mutex_);
-            return last_entered_;
-        }
+        // positions can be read without locking, but the value is only
+        // a snapshot which may be behind by the time it is used
+        wsrep_seqno_t last_left()    const { return last_left_pub_();    }
+        wsrep_seqno_t last_entered() const { return last_entered_pub_(); }
 
         void last_left_gtid(wsrep_gtid_t& gtid) const
         {
@@ -348,10 +395,12 @@ namespace galera
 
         ssize_t       size()        const { return process_size_; }
 
+        // called without mutex_, so it reads the published copies and the
+        // answer is only a hint: enter() still serializes on mutex_
         bool would_block (wsrep_seqno_t seqno) const
         {
-            return (seqno - last_left_ >= process_size_ ||
-                    seqno > drain_seqno_);
+            return (seqno - last_left_pub_() >= process_size_ ||
+                    seqno > drain_seqno_pub_());
         }
 
         void drain(wsrep_seqno_t seqno)
@@ -370,12 +419,13 @@ namespace galera
             // there can be some stale canceled entries
             update_last_left(lock);
 
-            drain_seqno_ = GU_LLONG_MAX;
+            set_drain_seqno(GU_LLONG_MAX);
             cond_.broadcast();
         }
 
         void wait(wsrep_seqno_t seqno)
         {
+            if (last_left_pub_() >= seqno) return; // fast path
             gu::Lock lock(mutex_);
             while (last_left_ < seqno)
             {
@@ -418,10 +468,27 @@ namespace galera
             *waits = waits_;
         }
 
+        // distribution of time spent waiting to enter, in seconds,
+        // empty if there were no waits
+        std::string wait_histogram() const
+        {
+            gu::Lock lock(mutex_);
+            return (wait_cnt_ > 0 ? wait_hs_.to_string() : std::string());
+        }
+
+        // Makes waiters spin for ns before parking regardless of the number
+        // of CPUs and recent waits, 0 restores the default. For unit tests.
+        void force_spin(long long const ns)
+        {
+            gu::Lock lock(mutex_);
+            spin_force_ = ns;
+        }
+
         void flush_stats()
         {
             gu::Lock lock(mutex_);
             oooe_ = 0; oool_ = 0; win_size_ = 0; entered_ = 0; waits_ = 0;
+            wait_cnt_ = 0; wait_hs_.clear();
         }
 
     private:
@@ -436,6 +503,46 @@ namespace galera
 #endif /* GALERA_MONITOR_DEBUG_PRINT */
         }
 
+        static ssize_t window_size(size_t const size)
+        {
+            size_t ret(MIN_SIZE);
+            while (ret < size) ret <<= 1;
+            return ret;
+        }
+
+        static Process* allocate(size_t const num)
+        {
+            size_t const size(num * sizeof(Process));
+            // large windows are aligned to huge page boundary so that they
+            // can be backed by transparent huge pages
+            size_t const align(size >= huge_page_size_ ?
+                               huge_page_size_ : GU_CACHE_LINE_SIZE);
+            void* ptr(nullptr);
+
+            if (::posix_memalign(&ptr, align, size))
+            {
+                gu_throw_error(ENOMEM) << "Could not allocate " << size
+                                       << " bytes for monitor window";
+            }
+#ifdef MADV_HUGEPAGE
+            if (align == huge_page_size_)
+            {
+                // best effort, ignore errors
+                (void)::madvise(ptr, size, MADV_HUGEPAGE);
+            }
+#endif /* MADV_HUGEPAGE */
+            Process* const ret(static_cast<Process*>(ptr));
+            for (size_t i(0); i < num; ++i) new (ret + i) Process();
+
+            return ret;
+        }
+
+        static void destroy(Process* const process, size_t const num)
+        {
+            for (size_t i(0); i < num; ++i) process[i].~Process();
+            ::free(process);
+        }
+
         size_t indexof(wsrep_seqno_t seqno) const
         {
             return (seqno & process_mask_);
@@ -443,7 +550,26 @@ namespace galera
 
         bool may_enter(const C& obj) const
         {
-            return obj.condition(last_entered_, last_left_);
+            return obj.condition(last_entered_, last_left_) && deps_left(obj);
+        }
+
+        // whether explicit dependencies of obj, if any, have left
+        bool deps_left(const C& obj) const
+        {
+            for (int i(0); i < obj.deps_count(); ++i)
+            {
+                wsrep_seqno_t const dep(obj.dep(i));
+
+                assert(dep < obj.seqno());
+
+                if (dep > last_left_ &&
+                    process_[indexof(dep)].state_ != Process::S_FINISHED)
+                {
+                    return false;
+                }
+            }
+
+            return true;
         }
 
         // wait until it is possible to grab slot in monitor,
@@ -459,7 +585,27 @@ namespace galera
                 lock.wait(cond_);
             }
 
-            if (last_entered_ < obj_seqno) last_entered_ = obj_seqno;
+            if (last_entered_ < obj_seqno) set_last_entered(obj_seqno);
+        }
+
+        // last_left_, last_entered_ and drain_seqno_ must only be modified
+        // with these under mutex_ to keep published copies in sync
+        void set_last_left(wsrep_seqno_t const seqno)
+        {
+            last_left_     = seqno;
+            last_left_pub_ = seqno;
+        }
+
+        void set_last_entered(wsrep_seqno_t const seqno)
+        {
+            last_entered_     = seqno;
+            last_entered_pub_ = seqno;
+        }
+
+        void set_drain_seqno(wsrep_seqno_t const seqno)
+        {
+            drain_seqno_     = seqno;
+            drain_seqno_pub_ = seqno;
         }
 
         void update_last_left(gu::Lock& lock)
@@ -471,7 +617,7 @@ namespace galera
                 if (Process::S_FINISHED == a.state_)
                 {
                     a.state_   = Process::S_IDLE;
-                    last_left_ = i;
+                    set_last_left(i);
                     a.wake_up_waiters(lock);
                 }
                 else
@@ -504,6 +650,49 @@ namespace galera
             }
         }
 
+        static inline void cpu_relax()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__)
+            __asm__ __volatile__("yield");
+#endif
+        }
+
+        // Before parking the thread spin with mutex_ released for up to
+        // twice the recent average wait if waits are short enough for that
+        // to be cheaper than a context switch. The condition is checked
+        // against lock-free copies of the positions, so it is only a hint
+        // which must be rechecked under mutex_.
+        void spin(const C& obj, gu::Lock& lock)
+        {
+            if (0 == spin_force_ &&
+                (!spin_ || wait_avg_ > spin_max_ || obj.deps_count() > 0))
+                return;
+
+            long long const max(spin_max_);
+            long long const budget(spin_force_ ? spin_force_ :
+                                   std::min(2*wait_avg_ + 1000, max));
+            long long const start(gu_time_monotonic());
+            bool ready(false);
+
+            gu::Unlock unlock(lock);
+
+            do
+            {
+                for (int i(0); i < 64; ++i) cpu_relax();
+                ready = obj.condition(last_entered_pub_(), last_left_pub_());
+            }
+            while (!ready && gu_time_monotonic() - start < budget);
+        }
+
+        void record_wait(long long const ns)
+        {
+            wait_avg_ = (7*wait_avg_ + ns) / 8;
+            ++wait_cnt_;
+            wait_hs_.insert(double(ns) * 1.0e-9);
+        }
+
         void post_leave(wsrep_seqno_t const obj_seqno, gu::Lock& lock)
         {
             const size_t idx(indexof(obj_seqno));
@@ -511,7 +700,7 @@ namespace galera
             if (last_left_ + 1 == obj_seqno) // we're shrinking window
             {
                 process_[idx].state_ = Process::S_IDLE;
-                last_left_           = obj_seqno;
+                set_last_left(obj_seqno);
                 process_[idx].wake_up_waiters(lock);
 
                 update_last_left(lock);
@@ -523,6 +712,9 @@ namespace galera
             else
             {
                 process_[idx].state_ = Process::S_FINISHED;
+                // waiters with explicit dependencies don't need to wait
+                // for the window to shrink
+                if (deps_waiters_ > 0) wake_up_next();
             }
 
             process_[idx].obj_ = 0;
@@ -545,7 +737,7 @@ namespace galera
         {
             log_debug << "draining up to " << seqno;
 
-            drain_seqno_ = seqno;
+            set_drain_seqno(seqno);
 
             if (last_left_ > drain_seqno_)
             {
@@ -579,6 +771,8 @@ namespace galera
         Monitor(const Monitor&);
         void operator=(const Monitor&);
 
+        ssize_t const process_size_;
+        size_t  const process_mask_;
         mutable
         gu::Mutex mutex_;
         gu::CondKey cond_key_;
@@ -586,7 +780,11 @@ namespace galera
         wsrep_uuid_t  uuid_;
         wsrep_seqno_t last_entered_;
         wsrep_seqno_t last_left_;
+        // copies of the above for readers which don't take mutex_
+        gu::Atomic<wsrep_seqno_t> last_entered_pub_;
+        gu::Atomic<wsrep_seqno_t> last_left_pub_;
         wsrep_seqno_t drain_seqno_;
+        gu::Atomic<wsrep_seqno_t> drain_seqno_pub_; // for would_block()
         Process*      process_;
         long entered_;  // entered
         long oooe_;     // out of order entered
@@ -595,6 +793,13 @@ namespace galera
         // Total number of waits in the monitor. Incremented before
         // entering into waiting state.
         long long waits_;
+        // Number of objects with explicit dependencies waiting to enter
+        int deps_waiters_;
+        bool const    spin_;     // spinning makes sense on this machine
+        long long     spin_force_; // spin budget set by force_spin(), ns
+        long long     wait_avg_; // moving average of wait time, ns
+        long long     wait_cnt_;
+        gu::Histogram wait_hs_;
     };
 }
 
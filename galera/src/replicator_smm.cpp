@@ -15,6 +15,8 @@
 #include <sstream>
 #include <iostream>
 
+#include <unistd.h> // access(), unlink()
+
 
 #define TX_SET_STATE(t_,s_) (t_).set_state(s_, __LINE__)
 
@@ -82,6 +84,7 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
     init_config_        (config_, args->node_address, args->data_dir),
     parse_options_      (*this, config_, args->options),
     init_ssl_           (config_),
+    checksum_pool_      (),
     protocol_version_   (-1),
     proto_max_          (gu::from_string<int>(config_.get(Param::proto_max))),
     state_              (S_CLOSED),
@@ -93,12 +96,15 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
                              config_.get(Param::commit_order))),
     state_file_         (config_.get(BASE_DIR)+'/'+GALERA_STATE_FILE),
     st_                 (state_file_),
+    cert_index_file_    (config_.get(BASE_DIR)+'/'+CERT_INDEX_FILE),
     safe_to_bootstrap_  (true),
     trx_params_         (config_.get(BASE_DIR), -1,
                          KeySet::version(config_.get(Param::key_format)),
                          TrxHandleMaster::Defaults.record_set_ver_,
                          gu::from_string<int>(config_.get(
-                             Param::max_write_set_size))),
+                             Param::max_write_set_size)),
+                         DataSet::VER1,
+                         config_.get<int>(Param::compress_threshold)),
     uuid_               (WSREP_UUID_UNDEFINED),
     state_uuid_         (WSREP_UUID_UNDEFINED),
     state_uuid_str_     (),
@@ -139,14 +145,18 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
     ist_senders_        (gcache_),
     wsdb_               (),
     cert_               (config_, gcache_, &service_thd_),
+    cert_index_snapshot_(),
     pending_cert_queue_ (gcache_),
     write_set_waiters_  (),
     local_monitor_      (gu::GU_MUTEX_KEY_LOCAL_MONITOR,
-                         gu::GU_COND_KEY_LOCAL_MONITOR),
+                         gu::GU_COND_KEY_LOCAL_MONITOR,
+                         config_.get<size_t>(Param::monitor_window)),
     apply_monitor_      (gu::GU_MUTEX_KEY_APPLY_MONITOR,
-                         gu::GU_COND_KEY_APPLY_MONITOR),
+                         gu::GU_COND_KEY_APPLY_MONITOR,
+                         config_.get<size_t>(Param::monitor_window)),
     commit_monitor_     (gu::GU_MUTEX_KEY_COMMIT_MONITOR,
-                         gu::GU_COND_KEY_COMMIT_MONITOR),
+                         gu::GU_COND_KEY_COMMIT_MONITOR,
+                         config_.get<size_t>(Param::monitor_window)),
     causal_read_timeout_(config_.get(Param::causal_read_timeout)),
     receivers_          (),
     replicated_         (),
@@ -200,6 +210,8 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
 
     local_monitor_.set_initial_position(WSREP_UUID_UNDEFINED, 0);
 
+    gu::Allocator::arena(gu::Allocator::arena(config_.get(Param::ws_arena)));
+
     wsrep_uuid_t  uuid;
     wsrep_seqno_t seqno;
 
@@ -227,6 +239,7 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
                                       trx_params_.version_);
         gcache_.seqno_reset(gu::GTID(uuid, seqno));
         // update gcache position to one supplied by app.
+        load_cert_index(uuid, seqno);
     }
 
     build_stats_vars(wsrep_stats_);
@@ -253,6 +266,7 @@ void galera::ReplicatorSMM::shift_to_CLOSED()
     if (state_uuid_ != WSREP_UUID_UNDEFINED)
     {
         st_.set (state_uuid_, last_committed(), safe_to_bootstrap_);
+        if (!st_.corrupt()) save_cert_index();
     }
 
     /* Cleanup for re-opening. */
@@ -280,6 +294,57 @@ void galera::ReplicatorSMM::shift_to_CLOSED()
     write_set_waiters_.interrupt_waiters();
 }
 
+void galera::ReplicatorSMM::save_cert_index()
+{
+    if (!cert_.snapshot()) return;
+
+    try
+    {
+        cert_.write_snapshot(cert_index_file_,
+                             gu::GTID(state_uuid_, last_committed()));
+    }
+    catch (gu::Exception& e)
+    {
+        log_warn << "Failed to save certification index: " << e.what();
+    }
+}
+
+void galera::ReplicatorSMM::load_cert_index(const wsrep_uuid_t& uuid,
+                                            wsrep_seqno_t const seqno)
+{
+    if (!cert_.snapshot() || ::access(cert_index_file_.c_str(), F_OK)) return;
+
+    try
+    {
+        std::unique_ptr<CertIndexSnapshot> snapshot(
+            new CertIndexSnapshot(cert_index_file_));
+
+        if (snapshot->gtid() == gu::GTID(uuid, seqno))
+        {
+            log_info << "Loaded certification index snapshot at "
+                     << snapshot->gtid() << ": "
+                     << snapshot->records().size()
+                     << " write sets from seqno " << snapshot->lowest();
+            cert_index_snapshot_ = std::move(snapshot);
+        }
+        else
+        {
+            log_info << "Certification index snapshot position "
+                     << snapshot->gtid() << " does not match state "
+                     << gu::GTID(uuid, seqno) << ", ignoring it";
+        }
+    }
+    catch (gu::Exception& e)
+    {
+        log_warn << "Failed to load certification index snapshot: "
+                 << e.what();
+    }
+
+    /* Snapshot is good for one restart only: it is mapped already and the
+     * file must not be mistaken for a valid one after a crash. */
+    ::unlink(cert_index_file_.c_str());
+}
+
 void galera::ReplicatorSMM::wait_for_CLOSED(gu::Lock& lock)
 {
     assert(closing_mutex_.locked());
@@ -1886,10 +1951,12 @@ writeset_from_handle (wsrep_po_handle_t&             handle,
 //                gu::String<256>(trx_params.working_dir_) << '/' << &handle,
                 trx_params.working_dir_, wsrep_trx_id_t(&handle),
                 /* key format is not essential since we're not adding keys */
-                KeySet::version(trx_params.key_format_), NULL, 0, 0,
+                trx_params.key_format(), NULL, 0, 0,
                 trx_params.record_set_ver_,
-                WriteSetNG::MAX_VERSION, DataSet::MAX_VERSION, DataSet::MAX_VERSION,
-                trx_params.max_write_set_size_);
+                WriteSetNG::MAX_VERSION, trx_params.data_set_version(),
+                trx_params.data_set_version(),
+                trx_params.max_write_set_size_,
+                trx_params.compress_threshold_);
 
             handle.opaque = ret;
         }
@@ -2367,6 +2434,23 @@ galera::get_trx_protocol_versions(int proto_ver)
         trx_ver = 6; // zero-level key in the writeset
         record_set_ver = gu::RecordSet::VER2;
         break;
+    case 12:
+        // Protocol upgrade to enable support for compressed data sets,
+        // no effect on writeset or record set versions
+        trx_ver = 6;
+        record_set_ver = gu::RecordSet::VER2;
+        break;
+    case 13:
+        // Protocol upgrade to enable support for TREE8 key sets,
+        // no effect on writeset or record set versions
+        trx_ver = 6;
+        record_set_ver = gu::RecordSet::VER2;
+        break;
+    case 14:
+        // Protocol upgrade to checksum record sets with CRC-32C
+        trx_ver = 6;
+        record_set_ver = gu::RecordSet::VER3;
+        break;
     default:
         gu_throw_error(EPROTO)
             << "Configuration change resulted in an unsupported protocol "
@@ -2382,6 +2466,10 @@ void galera::ReplicatorSMM::establish_protocol_versions (int proto_ver)
         const auto trx_versions(get_trx_protocol_versions(proto_ver));
         trx_params_.version_ = std::get<0>(trx_versions);
         trx_params_.record_set_ver_ = std::get<1>(trx_versions);
+        trx_params_.data_set_ver_ = proto_ver >= PROTO_VER_COMPRESSED_DATA ?
+            DataSet::VER2 : DataSet::VER1;
+        trx_params_.key_format_max_ = proto_ver >= PROTO_VER_TREE_KEYS ?
+            KeySet::TREE8 : KeySet::FLAT16A;
         protocol_version_ = proto_ver;
         log_info << "REPL Protocols: " << protocol_version_ << " ("
                  << trx_params_.version_ << ")";
@@ -3016,6 +3104,9 @@ void galera::ReplicatorSMM::process_prim_conf_change(void* recv_ctx,
         return;
     }
 
+    // No state transfer, so no IST to restore certification index for.
+    cert_index_snapshot_.reset();
+
     // From this point on the CC is known to be processed in order.
     assert(group_seqno > cert_.position());
 
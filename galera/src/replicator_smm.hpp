@@ -19,9 +19,11 @@
 #include "monitor.hpp"
 #include "wsdb.hpp"
 #include "certification.hpp"
+#include "cert_index_snapshot.hpp"
 #include "trx_handle.hpp"
 #include "write_set.hpp"
 #include "galera_service_thd.hpp"
+#include "checksum_pool.hpp"
 #include "fsm.hpp"
 #include "action_source.hpp"
 #include "ist.hpp"
@@ -31,6 +33,7 @@
 #include "write_set_wait.hpp"
 
 #include <map>
+#include <memory>
 #include <queue>
 
 namespace galera
@@ -406,6 +409,9 @@ namespace galera
             static const std::string commit_order;
             static const std::string causal_read_timeout;
             static const std::string max_write_set_size;
+            static const std::string monitor_window;
+            static const std::string compress_threshold;
+            static const std::string ws_arena;
         };
 
         typedef std::pair<std::string, std::string> Default;
@@ -476,6 +482,11 @@ namespace galera
                                     bool must_apply);
         void handle_ist_trx(const TrxHandleSlavePtr& ts, bool must_apply,
                             bool preload);
+        bool restore_cert_index(wsrep_seqno_t first_seqno);
+
+        // Certification index snapshot
+        void save_cert_index();
+        void load_cert_index(const wsrep_uuid_t& uuid, wsrep_seqno_t seqno);
 
         /* process pending queue events scheduled before local_seqno */
         void process_pending_queue(wsrep_seqno_t local_seqno);
@@ -564,6 +575,9 @@ namespace galera
                 return (last_left + 1 == seqno_);
             }
 
+            int           deps_count() const { return 0; }
+            wsrep_seqno_t dep(int)     const { return WSREP_SEQNO_UNDEFINED; }
+
 #ifdef GU_DBUG_ON
             void debug_sync(gu::Mutex& mutex)
             {
@@ -619,10 +633,11 @@ namespace galera
             ApplyOrder(const TrxHandleSlave& ts)
                 :
                 global_seqno_ (ts.global_seqno()),
-                depends_seqno_(ts.depends_seqno()),
+                depends_seqno_(ts.pa_barrier()),
                 cond_(&ts.apply_order_cond_),
                 is_local_     (ts.local()),
-                is_toi_       (ts.is_toi())
+                is_toi_       (ts.is_toi()),
+                deps_         (ts.pa_deps_count() > 0 ? &ts : NULL)
 #ifndef NDEBUG
                 ,trx_         (&ts)
 #endif
@@ -640,7 +655,8 @@ namespace galera
                 depends_seqno_(ds),
                 cond_(),
                 is_local_     (l),
-                is_toi_       (false)
+                is_toi_       (false),
+                deps_         (NULL)
 #ifndef NDEBUG
                 ,trx_         (NULL)
 #endif
@@ -657,6 +673,15 @@ namespace galera
                         last_left >= depends_seqno_);
             }
 
+            /* explicit dependencies in addition to depends_seqno_ */
+            int deps_count() const
+            {
+                return ((deps_ && (is_local_ == false || is_toi_ == true)) ?
+                        deps_->pa_deps_count() : 0);
+            }
+
+            wsrep_seqno_t dep(int i) const { return deps_->pa_dep(i); }
+
 #ifdef GU_DBUG_ON
             void debug_sync(gu::Mutex& mutex)
             {
@@ -683,6 +708,7 @@ namespace galera
                 cond_(),
                 is_local_     (false),
                 is_toi_       (false),
+                deps_         (NULL),
                 trx_          (NULL)
             {}
 #endif /* NDEBUG */
@@ -703,6 +729,8 @@ namespace galera
             gu::Cond* cond_;
             const bool is_local_;
             const bool is_toi_;
+            // write set with explicit dependencies, if any
+            const TrxHandleSlave* const deps_;
 #ifndef NDEBUG
             // this pointer is for debugging purposes only and
             // is not guaranteed to point at a valid location
@@ -783,6 +811,9 @@ namespace galera
                 gu_throw_fatal << "invalid commit mode value " << mode_;
             }
 
+            int           deps_count() const { return 0; }
+            wsrep_seqno_t dep(int)     const { return WSREP_SEQNO_UNDEFINED; }
+
 #ifdef GU_DBUG_ON
             void debug_sync(gu::Mutex& mutex)
             {
@@ -957,6 +988,8 @@ namespace galera
             InitSSL(gu::Config& conf) { gu::ssl_init_options(conf); }
         } init_ssl_; // initialize global SSL parameters
 
+        ChecksumPool::Ref      checksum_pool_; // background ws verification
+
         static int const       MAX_PROTO_VER;
 
         /*
@@ -975,6 +1008,9 @@ namespace galera
          * | 4.x            10 | PA range/ 5 | CC events /  3 |               2 |
          * |                   | UPD keys    | idx preload    |                 |
          * |                11 | SRV keys  6 |              3 |               2 |
+         * |                12 | LZ data   6 |              3 |               2 |
+         * |                13 | TREE8 key 6 |              3 |               2 |
+         * |                14 |           6 |              3 | CRC32C        3 |
          * |--------------------------------------------------------------------|
          *
          * Note: str_proto_ver is decided in replicator_str.cpp based on
@@ -985,6 +1021,10 @@ namespace galera
         static int const PROTO_VER_GALERA_3_MAX = 9;
         /* repl protocol version which orders CC */
         static int const PROTO_VER_ORDERED_CC = 10;
+        /* repl protocol version which allows compressed data sets */
+        static int const PROTO_VER_COMPRESSED_DATA = 12;
+        /* repl protocol version which allows TREE8 key sets */
+        static int const PROTO_VER_TREE_KEYS = 13;
 
         int                    protocol_version_;// general repl layer proto
         int                    proto_max_;    // maximum allowed proto version
@@ -1002,6 +1042,7 @@ namespace galera
         // persistent data location
         std::string           state_file_;
         SavedState            st_;
+        std::string           cert_index_file_;
 
         // boolean telling if the node is safe to use for bootstrapping
         // a new primary component
@@ -1055,6 +1096,8 @@ namespace galera
         // trx processing
         Wsdb            wsdb_;
         Certification   cert_;
+        // index snapshot loaded on startup, to be used by IST
+        std::unique_ptr<CertIndexSnapshot> cert_index_snapshot_;
 
         class PendingCertQueue
         {
@@ -24,8 +24,14 @@ const std::string galera::ReplicatorSMM::Param::key_format =
     common_prefix + "key_format";
 const std::string galera::ReplicatorSMM::Param::max_write_set_size =
     common_prefix + "max_ws_size";
+const std::string galera::ReplicatorSMM::Param::monitor_window =
+    common_prefix + "monitor_window";
+const std::string galera::ReplicatorSMM::Param::compress_threshold =
+    common_prefix + "compress_threshold";
+const std::string galera::ReplicatorSMM::Param::ws_arena =
+    common_prefix + "ws_arena";
 
-int const galera::ReplicatorSMM::MAX_PROTO_VER(11);
+int const galera::ReplicatorSMM::MAX_PROTO_VER(14);
 
 galera::ReplicatorSMM::Defaults::Defaults() : map_()
 {
@@ -38,6 +44,11 @@ galera::ReplicatorSMM::Defaults::Defaults() : map_()
     const int max_write_set_size(galera::WriteSetNG::MAX_SIZE);
     map_.insert(Default(Param::max_write_set_size,
                         gu::to_string(max_write_set_size)));
+    const size_t monitor_window(Monitor<LocalOrder>::DEFAULT_SIZE);
+    map_.insert(Default(Param::monitor_window,
+                        gu::to_string(monitor_window)));
+    map_.insert(Default(Param::compress_threshold, "0"));
+    map_.insert(Default(Param::ws_arena, "NONE"));
 }
 
 const galera::ReplicatorSMM::Defaults galera::ReplicatorSMM::defaults;
@@ -62,6 +73,8 @@ galera::ReplicatorSMM::InitConfig::InitConfig(gu::Config&       conf,
 
     conf.set_flags(Param::causal_read_timeout, gu::Config::Flag::type_duration);
     conf.set_flags(Param::max_write_set_size, gu::Config::Flag::type_integer);
+    conf.set_flags(Param::monitor_window, gu::Config::Flag::type_integer);
+    conf.set_flags(Param::compress_threshold, gu::Config::Flag::type_integer);
     conf.set_flags(Param::base_dir, gu::Config::Flag::read_only);
     conf.set_flags(Param::base_port, gu::Config::Flag::read_only |
                    gu::Config::Flag::type_integer);
@@ -175,7 +188,8 @@ galera::ReplicatorSMM::set_param (const std::string& key,
     else if (key == Param::base_host ||
              key == Param::base_port ||
              key == Param::base_dir ||
-             key == Param::proto_max)
+             key == Param::proto_max ||
+             key == Param::monitor_window)
     {
         // nothing to do here, these params take effect only at
         // provider (re)start
@@ -188,6 +202,14 @@ galera::ReplicatorSMM::set_param (const std::string& key,
     {
         trx_params_.max_write_set_size_ = gu::from_string<int>(value);
     }
+    else if (key == Param::compress_threshold)
+    {
+        trx_params_.compress_threshold_ = gu::from_string<int>(value);
+    }
+    else if (key == Param::ws_arena)
+    {
+        gu::Allocator::arena(gu::Allocator::arena(value));
+    }
     else
     {
         log_warn << "parameter '" << key << "' not found";
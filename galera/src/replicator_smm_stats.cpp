@@ -273,6 +273,16 @@ galera::ReplicatorSMM::stats_get() const
     gu::Status status;
     int gcs_rc = gcs_.get_status(status);
 
+    cert_.hotspots_status(status);
+    gcache_.map_status(status);
+
+    std::string hs(local_monitor_.wait_histogram());
+    if (!hs.empty()) status.insert("local_wait_hs", hs);
+    hs = apply_monitor_.wait_histogram();
+    if (!hs.empty()) status.insert("apply_wait_hs", hs);
+    hs = commit_monitor_.wait_histogram();
+    if (!hs.empty()) status.insert("commit_wait_hs", hs);
+
 #ifdef GU_DBUG_ON
     status.insert("debug_sync_waiters", gu_debug_sync_waiters());
 #endif // GU_DBUG_ON
@@ -32,6 +32,9 @@ static int get_str_proto_ver(int const group_proto_ver)
         return 2;
     case 10:
     case 11:
+    case 12:
+    case 13:
+    case 14:
         // 4.x
         // CC events in IST, certification index preload
         return 3;
@@ -271,21 +274,27 @@ read_state_request (const void* const req, size_t const req_len)
 class IST_request
 {
 public:
-    IST_request() : peer_(), uuid_(), last_applied_(), group_seqno_() { }
+    IST_request() : peer_(), uuid_(), last_applied_(), group_seqno_(),
+                    cert_lowest_(WSREP_SEQNO_UNDEFINED) { }
     IST_request(const std::string& peer,
                 const wsrep_uuid_t& uuid,
                 wsrep_seqno_t last_applied,
-                wsrep_seqno_t last_missing_seqno)
+                wsrep_seqno_t last_missing_seqno,
+                wsrep_seqno_t cert_lowest = WSREP_SEQNO_UNDEFINED)
         :
         peer_(peer),
         uuid_(uuid),
         last_applied_(last_applied),
-        group_seqno_(last_missing_seqno)
+        group_seqno_(last_missing_seqno),
+        cert_lowest_(cert_lowest)
     { }
     const std::string&  peer()  const { return peer_ ; }
     const wsrep_uuid_t& uuid()  const { return uuid_ ; }
     wsrep_seqno_t       last_applied() const { return last_applied_; }
     wsrep_seqno_t       group_seqno()  const { return group_seqno_; }
+    // Lowest seqno of the certification index which joiner has restored
+    // from snapshot at last_applied, WSREP_SEQNO_UNDEFINED if none.
+    wsrep_seqno_t       cert_lowest()  const { return cert_lowest_; }
 private:
     friend std::ostream& operator<<(std::ostream&, const IST_request&);
     friend std::istream& operator>>(std::istream&, IST_request&);
@@ -293,22 +302,37 @@ private:
     wsrep_uuid_t uuid_;
     wsrep_seqno_t last_applied_;
     wsrep_seqno_t group_seqno_;
+    wsrep_seqno_t cert_lowest_;
 };
 
 std::ostream& operator<<(std::ostream& os, const IST_request& istr)
 {
-    return (os
-            << istr.uuid_         << ":"
-            << istr.last_applied_ << "-"
-            << istr.group_seqno_  << "|"
-            << istr.peer_);
+    os << istr.uuid_         << ":"
+       << istr.last_applied_ << "-"
+       << istr.group_seqno_  << "|"
+       << istr.peer_;
+
+    // Optional trailing field, ignored by older donors.
+    if (istr.cert_lowest_ != WSREP_SEQNO_UNDEFINED)
+    {
+        os << " " << istr.cert_lowest_;
+    }
+
+    return os;
 }
 
 std::istream& operator>>(std::istream& is, IST_request& istr)
 {
     char c;
-    return (is >> istr.uuid_ >> c >> istr.last_applied_
-            >> c >> istr.group_seqno_ >> c >> istr.peer_);
+    is >> istr.uuid_ >> c >> istr.last_applied_
+       >> c >> istr.group_seqno_ >> c >> istr.peer_;
+
+    if (!(is >> istr.cert_lowest_))
+    {
+        istr.cert_lowest_ = WSREP_SEQNO_UNDEFINED;
+    }
+
+    return is;
 }
 
 static void
@@ -457,11 +481,24 @@ void ReplicatorSMM::process_state_req(void*       recv_ctx,
             {
                 log_info << "IST request: " << istr;
 
+                // Joiner which has restored certification index from
+                // snapshot needs no preload if the index goes back far enough.
+                bool const cert_restored
+                    (istr.cert_lowest() != WSREP_SEQNO_UNDEFINED &&
+                     istr.cert_lowest() <= cc_lowest_trx_seqno_);
+
                 wsrep_seqno_t const first
-                    ((str_proto_ver < 3 || cc_lowest_trx_seqno_ == 0) ?
+                    ((str_proto_ver < 3 || cc_lowest_trx_seqno_ == 0 ||
+                      cert_restored) ?
                     istr.last_applied() + 1 :
                     std::min(cc_lowest_trx_seqno_, istr.last_applied()+1));
 
+                if (cert_restored)
+                {
+                    log_info << "Joiner has certification index from seqno "
+                             << istr.cert_lowest() << ", skipping preload";
+                }
+
                 try
                 {
                     gcache_.seqno_lock(first);
@@ -669,9 +706,27 @@ ReplicatorSMM::prepare_for_IST (void*& ptr, ssize_t& len,
 
     std::ostringstream os;
 
+    wsrep_seqno_t cert_lowest(WSREP_SEQNO_UNDEFINED);
+
+    if (cert_index_snapshot_)
+    {
+        if (cert_index_snapshot_->gtid() == gu::GTID(state_uuid_, last_applied))
+        {
+            cert_lowest = cert_index_snapshot_->lowest();
+        }
+        else
+        {
+            log_info << "Discarding certification index snapshot at "
+                     << cert_index_snapshot_->gtid() << ", IST from "
+                     << gu::GTID(group_uuid, last_applied);
+            cert_index_snapshot_.reset();
+        }
+    }
+
     /* NOTE: in case last_applied is -1, first_needed is 0, but first legal
      * cached seqno is 1 so donor will revert to SST anyways, as is required */
-    os << IST_request(recv_addr, state_uuid_, last_applied, last_needed);
+    os << IST_request(recv_addr, state_uuid_, last_applied, last_needed,
+                      cert_lowest);
 
     char* str = strdup (os.str().c_str());
 
@@ -1062,6 +1117,7 @@ ReplicatorSMM::request_state_transfer (void* recv_ctx,
 
             ist_receiver_.ready(ist_from);
             recv_IST(recv_ctx);
+            cert_index_snapshot_.reset(); // if not used by now, it never will
 
             wsrep_seqno_t const ist_seqno(ist_receiver_.finished());
 
@@ -1314,6 +1370,36 @@ static void append_ist_trx(galera::Certification& cert,
     }
 }
 
+// Rebuild certification index from the snapshot loaded on startup if IST
+// continues right after the snapshot position.
+bool ReplicatorSMM::restore_cert_index(wsrep_seqno_t const first_seqno)
+{
+    if (!cert_index_snapshot_) return false;
+
+    // snapshot is used at most once
+    std::unique_ptr<CertIndexSnapshot> snapshot
+        (std::move(cert_index_snapshot_));
+
+    if (snapshot->gtid() != gu::GTID(state_uuid_, first_seqno - 1))
+    {
+        log_info << "Certification index snapshot at " << snapshot->gtid()
+                 << " does not match IST starting at " << first_seqno
+                 << ", rebuilding index from IST";
+        return false;
+    }
+
+    cert_.restore_snapshot(*snapshot, slave_pool_);
+
+    log_info << "Restored certification index from snapshot: "
+             << snapshot->records().size() << " entries, seqnos "
+             << snapshot->lowest() << "-" << snapshot->gtid().seqno();
+
+    // write sets are in gcache now, don't keep the file mapped
+    snapshot.reset();
+
+    return true;
+}
+
 void ReplicatorSMM::handle_ist_trx_preload(const TrxHandleSlavePtr& ts,
                                            bool const must_apply)
 {
@@ -1370,7 +1456,8 @@ void ReplicatorSMM::ist_trx(const TrxHandleSlavePtr& ts, bool must_apply,
         return;
     }
 
-    if (gu_unlikely(cert_.position() == WSREP_SEQNO_UNDEFINED))
+    if (gu_unlikely(cert_.position() == WSREP_SEQNO_UNDEFINED) &&
+        not restore_cert_index(ts->global_seqno()))
     {
         if (not ts->is_dummy())
         {
@@ -1452,7 +1539,7 @@ void ReplicatorSMM::ist_cc(const gcs_act_cchange& conf,
     assert(conf.seqno == act.seqno_g);
 
     if (gu_unlikely(cert_.position() == WSREP_SEQNO_UNDEFINED) &&
-        (must_apply || preload))
+        (must_apply || preload) && not restore_cert_index(conf.seqno))
     {
         // This is the first IST event for rebuilding cert index,
         // need to initialize certification
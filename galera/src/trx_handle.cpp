@@ -106,6 +106,13 @@ galera::TrxHandleSlave::print(std::ostream& os) const
        << ", d: "        << depends_seqno_
        << ")";
 
+    if (pa_deps_count_ > 0)
+    {
+        os << " pa deps (b: " << pa_barrier_ << ",";
+        for (int i(0); i < pa_deps_count_; ++i) os << ' ' << pa_deps_[i];
+        os << ")";
+    }
+
     if (!skip_event())
     {
         os << " WS pa_range: " << write_set().pa_range();
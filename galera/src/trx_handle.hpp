@@ -591,6 +591,68 @@ namespace galera
                    seqno_lt == WSREP_SEQNO_UNDEFINED ||
                    preordered());
             depends_seqno_ = seqno_lt;
+            pa_deps_count_ = 0;
+        }
+
+        /*
+         * Explicit parallel applying dependencies.
+         *
+         * depends_seqno() is the highest seqno this write set depends on
+         * and the write set may always be applied after all write sets up
+         * to it have been applied. Certification may also track the exact
+         * write sets it depends on: then the write set may be applied as
+         * soon as all write sets up to pa_barrier() and those listed by
+         * pa_dep() have been applied. This is local to the node,
+         * depends_seqno() is what gets replicated to others.
+         */
+        static int const MAX_PA_DEPS = 8;
+
+        wsrep_seqno_t pa_barrier() const
+        {
+            return pa_deps_count_ ? pa_barrier_ : depends_seqno_;
+        }
+
+        int           pa_deps_count() const { return pa_deps_count_; }
+        wsrep_seqno_t pa_dep(int i)   const { return pa_deps_[i]; }
+
+        /* Makes the write set depend on all write sets up to seqno. */
+        void raise_pa_barrier(wsrep_seqno_t const seqno)
+        {
+            if (seqno > depends_seqno_) depends_seqno_ = seqno;
+            if (pa_deps_count_ == 0 || seqno <= pa_barrier_) return;
+
+            pa_barrier_ = seqno;
+
+            int n(0);
+            for (int i(0); i < pa_deps_count_; ++i)
+            {
+                if (pa_deps_[i] > pa_barrier_) pa_deps_[n++] = pa_deps_[i];
+            }
+            pa_deps_count_ = n;
+        }
+
+        /* Makes the write set depend on write set seqno only. If there are
+         * too many explicit dependencies, falls back to depending on all
+         * write sets up to depends_seqno(). */
+        void add_pa_dep(wsrep_seqno_t const seqno)
+        {
+            if (pa_deps_count_ == 0) pa_barrier_ = depends_seqno_;
+            if (seqno > depends_seqno_) depends_seqno_ = seqno;
+            if (seqno <= pa_barrier_) return;
+
+            for (int i(0); i < pa_deps_count_; ++i)
+            {
+                if (pa_deps_[i] == seqno) return;
+            }
+
+            if (gu_likely(pa_deps_count_ < MAX_PA_DEPS))
+            {
+                pa_deps_[pa_deps_count_++] = seqno;
+            }
+            else
+            {
+                pa_deps_count_ = 0;
+            }
         }
 
         void set_global_seqno(wsrep_seqno_t s) // for monitor cancellation
@@ -710,6 +772,9 @@ namespace galera
             global_seqno_      (WSREP_SEQNO_UNDEFINED),
             last_seen_seqno_   (WSREP_SEQNO_UNDEFINED),
             depends_seqno_     (WSREP_SEQNO_UNDEFINED),
+            pa_barrier_        (WSREP_SEQNO_UNDEFINED),
+            pa_deps_           (),
+            pa_deps_count_     (0),
             ends_nbo_          (WSREP_SEQNO_UNDEFINED),
             mem_pool_          (mp),
             write_set_         (),
@@ -739,6 +804,9 @@ namespace galera
         wsrep_seqno_t          global_seqno_;
         wsrep_seqno_t          last_seen_seqno_;
         wsrep_seqno_t          depends_seqno_;
+        wsrep_seqno_t          pa_barrier_;
+        wsrep_seqno_t          pa_deps_[MAX_PA_DEPS];
+        int                    pa_deps_count_;
         wsrep_seqno_t          ends_nbo_;
         gu::MemPool<true>&     mem_pool_;
         WriteSetIn             write_set_;
@@ -810,24 +878,50 @@ namespace galera
             KeySet::Version        key_format_;
             gu::RecordSet::Version record_set_ver_;
             int                    max_write_set_size_;
+            DataSet::Version       data_set_ver_;
+            int                    compress_threshold_; // 0 - no compression
+            KeySet::Version        key_format_max_; // supported by the group
 
             Params (const std::string& wdir,
                     int                ver,
                     KeySet::Version    kformat,
                     gu::RecordSet::Version rsv = gu::RecordSet::VER2,
-                    int                max_write_set_size = WriteSetNG::MAX_SIZE)
+                    int                max_write_set_size = WriteSetNG::MAX_SIZE,
+                    DataSet::Version   dver = DataSet::VER1,
+                    int                compress_threshold = 0)
                 :
                 working_dir_       (wdir),
                 version_           (ver),
                 key_format_        (kformat),
                 record_set_ver_    (rsv),
-                max_write_set_size_(max_write_set_size)
+                max_write_set_size_(max_write_set_size),
+                data_set_ver_      (dver),
+                compress_threshold_(compress_threshold),
+                key_format_max_    (KeySet::MAX_VERSION)
             {}
 
             Params () :
                 working_dir_(), version_(), key_format_(),
-                record_set_ver_(), max_write_set_size_()
+                record_set_ver_(), max_write_set_size_(),
+                data_set_ver_(), compress_threshold_(),
+                key_format_max_(KeySet::MAX_VERSION)
             {}
+
+            /* compressed data sets are used only if enabled and supported
+             * by the group */
+            DataSet::Version data_set_version() const
+            {
+                return (compress_threshold_ > 0 ?
+                        data_set_ver_ : DataSet::VER1);
+            }
+
+            /* key formats not supported by the group fall back to the
+             * annotated flat one, which carries the same information */
+            KeySet::Version key_format() const
+            {
+                return (key_format_ > key_format_max_ ?
+                        KeySet::FLAT8A : key_format_);
+            }
         };
 
         static const Params Defaults;
@@ -887,6 +981,26 @@ namespace galera
         }
 
         void append_key(const KeyData& key)
+        {
+            check_key_version(key);
+
+            gu_trace(write_set_out().append_key(key));
+        }
+
+        /* keys are expected to be of the same protocol version */
+        void append_keys(const KeyData* const keys, size_t const n)
+        {
+            if (n > 0) check_key_version(keys[0]);
+
+            gu_trace(write_set_out().append_keys(keys, n));
+        }
+
+        void reserve_keys(size_t const parts)
+        {
+            write_set_out().reserve_keys(parts);
+        }
+
+        void check_key_version(const KeyData& key) const
         {
             /*! protection against protocol change during trx lifetime */
             if (key.proto_ver != version())
@@ -895,8 +1009,6 @@ namespace galera
                                        << "' does not match to trx version' "
                                        << version() << "'";
             }
-
-            gu_trace(write_set_out().append_key(key));
         }
 
         void append_data(const void* data, const size_t data_len,
@@ -1056,15 +1168,16 @@ namespace galera
                    params_.version_ <= WriteSetNG::MAX_VERSION);
 
             new (wso) WriteSetOut (params_.working_dir_,
-                                   trx_id(), params_.key_format_,
+                                   trx_id(), params_.key_format(),
                                    store,
                                    wso_buf_size_ - sizeof(WriteSetOut),
                                    0,
                                    params_.record_set_ver_,
                                    WriteSetNG::Version(params_.version_),
-                                   DataSet::MAX_VERSION,
-                                   DataSet::MAX_VERSION,
-                                   params_.max_write_set_size_);
+                                   params_.data_set_version(),
+                                   params_.data_set_version(),
+                                   params_.max_write_set_size_,
+                                   params_.compress_threshold_);
 
             wso_ = true;
         }
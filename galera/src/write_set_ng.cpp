@@ -8,7 +8,6 @@
 #include <gu_time.h>
 #include <gu_macros.hpp>
 #include <gu_utils.hpp>
-#include <gu_thread_keys.hpp>
 #ifndef NDEBUG
 #include <gcache_memops.hpp> // gcache::MemOps::ALIGNMENT
 #endif
@@ -202,7 +201,7 @@ const char WriteSetOut::annt_suffix[] = "_annt";
 void
 WriteSetIn::init (ssize_t const st)
 {
-    assert(false == check_thr_);
+    assert(false == check_pending_);
 
     const gu::byte_t* const pptr (header_.payload());
     ssize_t           const psize(size_ - header_.size());
@@ -214,33 +213,26 @@ WriteSetIn::init (ssize_t const st)
     if (kver != KeySet::EMPTY) gu_trace(keys_.init (kver, pptr, psize));
 
     assert (false == check_);
-    assert (false == check_thr_);
+    assert (false == check_pending_);
 
     if (gu_likely(st > 0)) /* checksum enforced */
     {
-        if (size_ >= st)
+        if (gu_likely(parse()))
         {
-            /* buffer too big, start checksumming in background */
-            int const err(gu_thread_create (
-                              gu::get_thread_key(
-                                  gu::GU_THREAD_KEY_WRITE_SET_CHECK),
-                              &check_thr_id_,
-                              checksum_thread, this));
-
-            if (gu_likely(0 == err))
+            if (size_ >= st)
             {
-                check_thr_ = true;
-                return;
+                /* buffer too big, verify record sets in parallel in
+                 * background, the verdict is postponed till
+                 * verify_checksum() regardless */
+                checksum_submit();
+                check_pending_ = true;
             }
 
-            log_warn << "Starting checksum thread failed: " << err
-                     << '(' << ::strerror(err) << ')';
-
-            /* fall through to checksum in foreground */
+            /* whatever was not submitted is verified in foreground */
+            checksum();
         }
 
-        checksum();
-        gu_trace(checksum_fin());
+        if (gu_likely(!check_pending_)) gu_trace(checksum_fin());
     }
     else /* checksum skipped, pretend it's alright */
     {
@@ -249,8 +241,8 @@ WriteSetIn::init (ssize_t const st)
 }
 
 
-void
-WriteSetIn::checksum()
+bool
+WriteSetIn::parse()
 {
     const gu::byte_t* pptr (header_.payload());
     ssize_t           psize(size_ - header_.size());
@@ -261,7 +253,6 @@ WriteSetIn::checksum()
     {
         if (keys_.size() > 0)
         {
-            gu_trace(keys_.checksum());
             size_t const tmpsize(keys_.serial_size());
             psize -= tmpsize;
             pptr  += tmpsize;
@@ -274,7 +265,6 @@ WriteSetIn::checksum()
         {
             assert (psize > 0);
             gu_trace(data_.init(dver, pptr, psize));
-            gu_trace(data_.checksum());
             size_t const tmpsize(data_.serial_size());
             psize -= tmpsize;
             pptr  += tmpsize;
@@ -283,7 +273,6 @@ WriteSetIn::checksum()
             if (header_.has_unrd())
             {
                 gu_trace(unrd_.init(dver, pptr, psize));
-                gu_trace(unrd_.checksum());
                 size_t const tmpsize(unrd_.serial_size());
                 psize -= tmpsize;
                 pptr  += tmpsize;
@@ -296,7 +285,6 @@ WriteSetIn::checksum()
                 gu_trace(annt_->init(dver, pptr, psize));
                 // we don't care for annotation checksum - it is not a reason
                 // to throw an exception and abort execution
-                // gu_trace(annt_->checksum());
 #ifndef NDEBUG
                 psize -= annt_->serial_size();
 #endif
@@ -306,6 +294,51 @@ WriteSetIn::checksum()
         assert (psize >= 0);
         assert (size_t(psize) < gcache::MemOps::ALIGNMENT);
 #endif
+        return true;
+    }
+    catch (std::exception& e)
+    {
+        log_error << e.what();
+    }
+    catch (...)
+    {
+        log_error << "Non-standard exception in WriteSet::parse()";
+    }
+
+    return false;
+}
+
+
+const gu::RecordSetInBase*
+WriteSetIn::check_set(int const i) const
+{
+    switch (i)
+    {
+    case CHECK_KEYS: return &keys_;
+    case CHECK_DATA: return &data_;
+    case CHECK_UNRD: return &unrd_;
+    }
+
+    assert(0);
+    return NULL;
+}
+
+
+void
+WriteSetIn::checksum()
+{
+    try
+    {
+        for (int i(0); i < CHECK_MAX; ++i)
+        {
+            const gu::RecordSetInBase* const set(check_set(i));
+
+            if (set->size() > 0 && NULL == check_jobs_[i].set_)
+            {
+                gu_trace(set->checksum());
+            }
+        }
+
         check_ = true;
     }
     catch (std::exception& e)
@@ -319,6 +352,44 @@ WriteSetIn::checksum()
 }
 
 
+void
+WriteSetIn::checksum_submit()
+{
+    for (int i(0); i < CHECK_MAX; ++i)
+    {
+        const gu::RecordSetInBase* const set(check_set(i));
+
+        if (0 == set->size()) continue;
+
+        check_jobs_[i].set_ = set;
+
+        if (gu_unlikely(!ChecksumPool::submit(check_jobs_[i])))
+        {
+            /* pool is not running */
+            check_jobs_[i].set_ = NULL;
+            break;
+        }
+    }
+}
+
+
+void
+WriteSetIn::checksum_wait() const
+{
+    for (int i(0); i < CHECK_MAX; ++i)
+    {
+        if (check_jobs_[i].set_ != NULL)
+        {
+            ChecksumPool::wait(check_jobs_[i]);
+            check_ = check_ && check_jobs_[i].ok();
+            check_jobs_[i].set_ = NULL;
+        }
+    }
+
+    check_pending_ = false;
+}
+
+
 void
 WriteSetIn::write_annotation(std::ostream& os) const
 {
@@ -17,6 +17,7 @@
 #include "wsrep_api.h"
 #include "key_set.hpp"
 #include "data_set.hpp"
+#include "checksum_pool.hpp"
 
 #include "gu_serialize.hpp"
 #include "gu_vector.hpp"
@@ -25,8 +26,6 @@
 #include <string>
 #include <iomanip>
 
-#include <gu_threads.h>
-
 namespace galera
 {
     class WriteSetNG
@@ -508,7 +507,8 @@ namespace galera
                      WriteSetNG::Version     ver      = WriteSetNG::MAX_VERSION,
                      DataSet::Version        dver     = DataSet::MAX_VERSION,
                      DataSet::Version        uver     = DataSet::MAX_VERSION,
-                     size_t                  max_size = WriteSetNG::MAX_SIZE)
+                     size_t                  max_size = WriteSetNG::MAX_SIZE,
+                     size_t                  compress = 0)
             :
             header_(ver),
             base_name_(dir_name, id),
@@ -519,10 +519,12 @@ namespace galera
                     kbn_, kver, rsv, ver),
             /* 5/8 of reserved goes to data set  */
             dbn_   (base_name_),
-            data_  (reserved + reserved_size, reserved_size*5, dbn_, dver, rsv),
+            data_  (reserved + reserved_size, reserved_size*5, dbn_, dver, rsv,
+                    compress),
             /* 2/8 of reserved goes to unordered set  */
             ubn_   (base_name_),
-            unrd_  (reserved + reserved_size*6, reserved_size*2, ubn_, uver,rsv),
+            unrd_  (reserved + reserved_size*6, reserved_size*2, ubn_, uver,rsv,
+                    compress),
             /* annotation set is not allocated unless requested */
             abn_   (base_name_),
             annt_  (NULL),
@@ -540,6 +542,14 @@ namespace galera
             left_ -= keys_.append(k);
         }
 
+        void append_keys(const KeyData* const k, size_t const n)
+        {
+            left_ -= keys_.append(k, n);
+        }
+
+        /* see KeySetOut::reserve() */
+        void reserve_keys(size_t const parts) { keys_.reserve(parts); }
+
         void append_data(const void* data, size_t data_len, bool store)
         {
             left_ -= data_.append(data, data_len, store);
@@ -554,8 +564,9 @@ namespace galera
         {
             if (NULL == annt_)
             {
-                annt_ = new DataSetOut(NULL, 0, abn_, DataSet::MAX_VERSION,
-                                       // use the same version as the dataset
+                // use the same versions as the dataset
+                annt_ = new DataSetOut(NULL, 0, abn_,
+                                       data_.configured_version(),
                                        data_.gu::RecordSet::version());
                 left_ -= annt_->size();
             }
@@ -717,8 +728,8 @@ namespace galera
               data_  (),
               unrd_  (),
               annt_  (NULL),
-              check_thr_id_(),
-              check_thr_(false),
+              check_jobs_(),
+              check_pending_(false),
               check_ (false)
         {
             gu_trace(init(st));
@@ -731,8 +742,8 @@ namespace galera
               data_  (),
               unrd_  (),
               annt_  (NULL),
-              check_thr_id_(),
-              check_thr_(false),
+              check_jobs_(),
+              check_pending_(false),
               check_ (false)
         {}
 
@@ -748,8 +759,8 @@ namespace galera
         /*
          * WriteSetIn(buf) == WriteSetIn() + read_buf(buf)
          *
-         * @param st threshold at which launch dedicated thread for checksumming
-         *           0 - no checksumming
+         * @param st threshold at which checksumming is offloaded to
+         *           ChecksumPool, 0 - no checksumming
          */
         void read_buf (const gu::Buf& buf, ssize_t const st = SIZE_THRESHOLD)
         {
@@ -768,10 +779,10 @@ namespace galera
 
         ~WriteSetIn ()
         {
-            if (gu_unlikely(check_thr_))
+            if (gu_unlikely(check_pending_))
             {
-                /* checksum was performed in a parallel thread */
-                gu_thread_join (check_thr_id_, NULL);
+                /* jobs reference this object, wait for them to finish */
+                checksum_wait();
             }
 
             delete annt_;
@@ -811,11 +822,10 @@ namespace galera
          * and before it is finalized. */
         void verify_checksum() const /* throws */
         {
-            if (gu_unlikely(check_thr_))
+            if (gu_unlikely(check_pending_))
             {
-                /* checksum was performed in a parallel thread */
-                gu_thread_join (check_thr_id_, NULL);
-                check_thr_ = false;
+                /* checksum was performed in background */
+                checksum_wait();
                 gu_trace(checksum_fin());
             }
         }
@@ -854,13 +864,31 @@ namespace galera
         DataSetIn          data_;
         DataSetIn          unrd_;
         DataSetIn*         annt_;
-        gu_thread_t        check_thr_id_;
-        bool mutable       check_thr_;
-        bool               check_;
 
-        static size_t const SIZE_THRESHOLD = 1 << 22; /* 4Mb */
+        /* checksums a single record set in ChecksumPool */
+        class CheckJob : public ChecksumPool::Job
+        {
+        public:
+            CheckJob() : ChecksumPool::Job(), set_(NULL) {}
+            void run() { set_->checksum(); }
+            const gu::RecordSetInBase* set_;
+        };
 
+        enum { CHECK_KEYS, CHECK_DATA, CHECK_UNRD, CHECK_MAX };
+
+        CheckJob mutable   check_jobs_[CHECK_MAX];
+        bool mutable       check_pending_;
+        bool mutable       check_;
+
+        /* there is no thread creation overhead with the pool */
+        static size_t const SIZE_THRESHOLD = 1 << 18; /* 256Kb */
+
+        bool parse ();    /* initializes record sets in the payload */
         void checksum (); /* checksums writeset, stores result in check_ */
+        void checksum_submit (); /* submits record sets to ChecksumPool */
+        void checksum_wait () const; /* waits for submitted jobs */
+
+        const gu::RecordSetInBase* check_set (int i) const;
 
         void checksum_fin() const
         {
@@ -870,13 +898,6 @@ namespace galera
             }
         }
 
-        static void* checksum_thread (void* arg)
-        {
-            WriteSetIn* ws(reinterpret_cast<WriteSetIn*>(arg));
-            ws->checksum();
-            return NULL;
-        }
-
         /* late initialization after default constructor */
         void init (ssize_t size_threshold);
 
@@ -25,6 +25,7 @@
 #include "wsrep_node_isolation.h"
 
 #include <cassert>
+#include <vector>
 
 
 using galera::KeyOS;
@@ -1004,11 +1005,30 @@ wsrep_status_t galera_append_key(wsrep_t*           const gh,
 
         if (keys_num > 0)
         {
-            for (size_t i(0); i < keys_num; ++i)
+            /* the batch size is the only hint we get about the number
+             * of rows to expect */
+            if (keys_num > 1)
+            {
+                trx->reserve_keys(keys_num * keys[0].key_parts_num);
+
+                /* let the key set hash sibling keys in a batch */
+                std::vector<galera::KeyData> kds;
+                kds.reserve(keys_num);
+                for (size_t i(0); i < keys_num; ++i)
+                {
+                    kds.push_back(galera::KeyData(proto_ver,
+                                                  keys[i].key_parts,
+                                                  keys[i].key_parts_num,
+                                                  key_type,
+                                                  copy));
+                }
+                gu_trace(trx->append_keys(&kds[0], kds.size()));
+            }
+            else
             {
                 galera::KeyData const k(proto_ver,
-                                        keys[i].key_parts,
-                                        keys[i].key_parts_num,
+                                        keys[0].key_parts,
+                                        keys[0].key_parts_num,
                                         key_type,
                                         copy);
                 gu_trace(trx->append_key(k));
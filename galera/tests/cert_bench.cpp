@@ -0,0 +1,544 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+/**
+ * This is to benchmark Certification::append_trx() throughput, latency,
+ * index size and purge cost on either synthetic or recorded write sets.
+ *
+ * Synthetic write sets have a configurable number of keys of the form
+ * (table, row), where rows are drawn from a zipfian distribution, and
+ * come from a number of nodes with a random certification interval.
+ *
+ * Recorded write sets are read from a copy of galera.cache ring buffer
+ * file. Certification has overwritten their last seen seqno with the
+ * global seqno and dependency distance, so the last seen seqno is
+ * restored as the dependency the write set got originally. This is the
+ * shortest certification interval it could have had, so the replay
+ * reproduces index size, dependencies and purge cost, but no conflicts.
+ *
+ * Usage: cert_bench [option=value ...]
+ *
+ *   trxs=N      number of synthetic write sets           (1000000)
+ *   keys=N      keys per write set                       (4)
+ *   tables=N    number of tables                         (16)
+ *   rows=N      number of rows per table                 (1000000)
+ *   zipf=S      zipfian skew of row popularity, 0 - flat (0.0)
+ *   shared=P    fraction of shared keys                  (0.0)
+ *   format=F    key format: flat8, flat8a, flat16, flat16a,
+ *               tree8                                    (flat16)
+ *   nodes=N     number of nodes write sets come from     (3)
+ *   interval=N  maximum certification interval           (16)
+ *   batch=N     write sets certified between commits     (1000)
+ *   gcache=F    replay write sets from gcache file F instead
+ *
+ * Note: gcache file is opened for recovery and might be modified,
+ *       so always use a copy of the real one.
+ */
+
+#include "certification.hpp"
+#include "replicator_smm.hpp" // ReplicatorSMM::InitConfig
+#include "key_data.hpp"
+#include "gcache_rb_store.hpp"
+#include "gcache_bh.hpp"
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using galera::Certification;
+using galera::KeySet;
+using galera::TrxHandle;
+using galera::TrxHandleSlave;
+using galera::TrxHandleSlavePtr;
+
+typedef std::chrono::steady_clock Clock;
+
+static double ns(Clock::duration const d)
+{
+    return std::chrono::duration<double, std::nano>(d).count();
+}
+
+struct Options
+{
+    Options()
+        : trxs(1000000), keys(4), tables(16), rows(1000000), zipf(0.0),
+          shared(0.0), format(KeySet::FLAT16), format_name("flat16"),
+          nodes(3), interval(16),
+          batch(1000), gcache()
+    {}
+
+    size_t          trxs;
+    size_t          keys;
+    size_t          tables;
+    size_t          rows;
+    double          zipf;
+    double          shared;
+    KeySet::Version format;
+    std::string     format_name;
+    size_t          nodes;
+    size_t          interval;
+    size_t          batch;
+    std::string     gcache;
+};
+
+template <typename T> static void
+read_value(const std::string& opt, const std::string& value, T& var)
+{
+    std::istringstream is(value);
+    if (!(is >> var) || !is.eof())
+    {
+        std::cerr << "Bad value for '" << opt << "': " << value << std::endl;
+        ::exit(EXIT_FAILURE);
+    }
+}
+
+static Options
+parse(int const argc, char* argv[])
+{
+    Options o;
+
+    for (int i(1); i < argc; ++i)
+    {
+        std::string const arg(argv[i]);
+        size_t const eq(arg.find('='));
+        std::string const opt(arg.substr(0, eq));
+        std::string const value(eq != std::string::npos ?
+                                arg.substr(eq + 1) : "");
+
+        if      (opt == "trxs")     read_value(opt, value, o.trxs);
+        else if (opt == "keys")     read_value(opt, value, o.keys);
+        else if (opt == "tables")   read_value(opt, value, o.tables);
+        else if (opt == "rows")     read_value(opt, value, o.rows);
+        else if (opt == "zipf")     read_value(opt, value, o.zipf);
+        else if (opt == "shared")   read_value(opt, value, o.shared);
+        else if (opt == "format")
+        {
+            o.format      = KeySet::version(value);
+            o.format_name = value;
+        }
+        else if (opt == "nodes")    read_value(opt, value, o.nodes);
+        else if (opt == "interval") read_value(opt, value, o.interval);
+        else if (opt == "batch")    read_value(opt, value, o.batch);
+        else if (opt == "gcache")   o.gcache = value;
+        else
+        {
+            std::cerr << "Unrecognized option: " << arg << std::endl;
+            ::exit(EXIT_FAILURE);
+        }
+    }
+
+    if (o.format == KeySet::EMPTY || o.keys == 0 || o.tables == 0 ||
+        o.rows == 0 || o.nodes == 0 || o.batch == 0)
+    {
+        std::cerr << "Bad options" << std::endl;
+        ::exit(EXIT_FAILURE);
+    }
+
+    return o;
+}
+
+/* Zipfian distribution over [0, n) with precomputed CDF */
+class Zipf
+{
+public:
+
+    Zipf(size_t const n, double const s) : cdf_()
+    {
+        if (s == 0.0) return; // uniform
+
+        cdf_.resize(n);
+        double sum(0);
+        for (size_t i(0); i < n; ++i)
+        {
+            sum += 1.0 / std::pow(double(i + 1), s);
+            cdf_[i] = sum;
+        }
+        for (size_t i(0); i < n; ++i) cdf_[i] /= sum;
+    }
+
+    template <class Rng>
+    size_t operator()(Rng& rng, size_t const n) const
+    {
+        if (cdf_.empty()) return rng() % n;
+
+        double const u(std::uniform_real_distribution<double>(0, 1)(rng));
+        return std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin();
+    }
+
+private:
+
+    std::vector<double> cdf_;
+};
+
+/* Releases the write set buffer together with the slave handle. */
+class BufDeleter
+{
+public:
+
+    explicit BufDeleter(void* const buf) : buf_(buf) {}
+
+    void operator()(TrxHandleSlave* const ts)
+    {
+        galera::TrxHandleSlaveDeleter()(ts);
+        ::free(buf_);
+    }
+
+private:
+
+    void* buf_;
+};
+
+struct Metrics
+{
+    Metrics()
+        : latency(), certified(0), failed(0), cert_time(0),
+          purges(0), purge_time(0), index_max(0)
+    {}
+
+    std::vector<float> latency;
+    size_t certified;
+    size_t failed;
+    double cert_time;
+    size_t purges;
+    double purge_time;
+    size_t index_max;
+};
+
+class Bench
+{
+public:
+
+    Bench(gu::Config& conf, gcache::GCache& gcache)
+        : gcache_(gcache),
+          sp_(sizeof(TrxHandleSlave), 1024, "cert_bench_sp"),
+          cert_(conf, gcache, 0),
+          m_()
+    {}
+
+    void start(const gu::GTID& position)
+    {
+        cert_.assign_initial_position(position,
+                                      galera::WriteSetNG::MAX_VERSION);
+    }
+
+    TrxHandleSlavePtr slave(const void* const ws, size_t const size,
+                            wsrep_seqno_t const seqno, bool const recorded)
+    {
+        void* const buf(::malloc(size));
+        if (!buf) throw std::bad_alloc();
+        ::memcpy(buf, ws, size);
+
+        TrxHandleSlavePtr ts(TrxHandleSlave::New(false, sp_),
+                             BufDeleter(buf));
+
+        if (recorded)
+        {
+            gu::Buf const wsb = { buf, ssize_t(size) };
+            galera::WriteSetNG::Header hdr(wsb);
+            wsrep_seqno_t const dist(std::max<int>(hdr.pa_range(), 1));
+            hdr.finalize(std::max<wsrep_seqno_t>(seqno - dist, 0), 0);
+        }
+
+        gcs_action const act = { seqno, seqno, buf, int32_t(size),
+                                 GCS_ACT_WRITESET };
+        ts->unserialize<true>(gcache_, act);
+
+        return ts;
+    }
+
+    void dummy(wsrep_seqno_t const seqno)
+    {
+        TrxHandleSlavePtr ts(TrxHandleSlave::New(false, sp_),
+                             galera::TrxHandleSlaveDeleter());
+        ts->set_global_seqno(seqno);
+        cert_.append_dummy_preload(ts);
+    }
+
+    void certify(const std::vector<TrxHandleSlavePtr>& batch)
+    {
+        for (size_t i(0); i < batch.size(); ++i)
+        {
+            Clock::time_point const begin(Clock::now());
+            Certification::TestResult const res(cert_.append_trx(batch[i]));
+            Clock::duration const d(Clock::now() - begin);
+
+            m_.latency.push_back(ns(d));
+            m_.cert_time += ns(d);
+            ++m_.certified;
+            m_.failed += (res != Certification::TEST_OK);
+        }
+
+        double interval, deps;
+        size_t index_size;
+        cert_.stats_get(interval, deps, index_size);
+        m_.index_max = std::max(m_.index_max, index_size);
+
+        for (size_t i(0); i < batch.size(); ++i)
+        {
+            wsrep_seqno_t const purge(cert_.set_trx_committed(*batch[i]));
+
+            if (purge > 0)
+            {
+                Clock::time_point const begin(Clock::now());
+                cert_.purge_trxs_upto(purge, true);
+                // no service thread here, finish the purge inline
+                while (cert_.purge_step()) {}
+                m_.purge_time += ns(Clock::now() - begin);
+                ++m_.purges;
+            }
+        }
+    }
+
+    void report()
+    {
+        double interval, deps;
+        size_t index_size;
+        cert_.stats_get(interval, deps, index_size);
+
+        std::vector<float>& l(m_.latency);
+        float p50(0), p99(0), max(0);
+        if (!l.empty())
+        {
+            std::nth_element(l.begin(), l.begin() + l.size() / 2, l.end());
+            p50 = l[l.size() / 2];
+            std::nth_element(l.begin(), l.begin() + l.size() * 99 / 100,
+                             l.end());
+            p99 = l[l.size() * 99 / 100];
+            max = *std::max_element(l.begin(), l.end());
+        }
+
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+
+        std::cout << "================" << std::endl;
+        std::cout << "certified:\t"     << m_.certified
+                  << " (failed: " << m_.failed << ")" << std::endl;
+        std::cout << "trx/s:\t\t"       << (m_.cert_time > 0 ?
+                                          m_.certified * 1.0e9 / m_.cert_time :
+                                          0) << std::endl;
+        std::cout << "latency, ns:\t"   << "p50 " << p50 << ", p99 " << p99
+                  << ", max " << max << std::endl;
+        std::cout << "avg deps dist:\t"  << deps << std::endl;
+        std::cout << "avg interval:\t"   << interval << std::endl;
+        std::cout << "index size:\t"     << index_size
+                  << " (max " << m_.index_max << ")" << std::endl;
+        std::cout << "purges:\t\t"       << m_.purges << ", "
+                  << (m_.purges ? m_.purge_time / m_.purges : 0)
+                  << " ns per purge" << std::endl;
+        std::cout << "max RSS, KiB:\t"   << ru.ru_maxrss << std::endl;
+        std::cout << "----------------" << std::endl;
+    }
+
+private:
+
+    gcache::GCache&      gcache_;
+    TrxHandleSlave::Pool sp_;   // must outlive cert_
+    Certification        cert_;
+    Metrics              m_;
+};
+
+static void
+run_synthetic(const Options& o, gu::Config& conf)
+{
+    conf.set("gcache.name", "cert_bench.cache");
+    conf.set("gcache.size", "1M");
+
+    galera::ProgressCallback<int64_t> pcb(WSREP_MEMBER_UNDEFINED,
+                                          WSREP_MEMBER_UNDEFINED);
+    gcache::GCache gcache(&pcb, conf, ".");
+    Bench bench(conf, gcache);
+    bench.start(gu::GTID(gu::UUID(), 0));
+
+    galera::TrxHandleMaster::Pool mp(sizeof(galera::TrxHandleMaster) +
+                                     sizeof(galera::WriteSetOut), 16,
+                                     "cert_bench_mp");
+    galera::TrxHandleMaster::Params const params("",
+                                                 galera::WriteSetNG::MAX_VERSION,
+                                                 o.format);
+    std::mt19937_64 rng(o.trxs);
+    Zipf const zipf(o.rows, o.zipf);
+
+    std::vector<std::string> tables;
+    for (size_t t(0); t < o.tables; ++t)
+    {
+        std::ostringstream os;
+        os << "db/table" << t;
+        tables.push_back(os.str());
+    }
+
+    std::vector<wsrep_uuid_t> nodes(o.nodes);
+    for (size_t n(0); n < o.nodes; ++n)
+    {
+        ::memset(&nodes[n], 0, sizeof(wsrep_uuid_t));
+        nodes[n].data[0] = n + 1;
+    }
+
+    std::vector<TrxHandleSlavePtr> batch;
+    batch.reserve(o.batch);
+
+    for (wsrep_seqno_t seqno(1); size_t(seqno) <= o.trxs; ++seqno)
+    {
+        size_t const node(rng() % o.nodes);
+        galera::TrxHandleMasterPtr txm(
+            galera::TrxHandleMaster::New(mp, params, nodes[node], node,
+                                         seqno),
+            galera::TrxHandleMasterDeleter());
+        txm->set_flags(TrxHandle::F_BEGIN | TrxHandle::F_COMMIT);
+
+        for (size_t k(0); k < o.keys; ++k)
+        {
+            const std::string& table(tables[rng() % o.tables]);
+            uint64_t const row(zipf(rng, o.rows));
+            wsrep_buf_t const parts[2] =
+                {
+                    { table.c_str(), table.size() },
+                    { &row, sizeof(row) }
+                };
+            bool const shared(std::uniform_real_distribution<double>(0, 1)
+                              (rng) < o.shared);
+            txm->append_key(galera::KeyData(txm->version(), parts, 2,
+                                            shared ? WSREP_KEY_SHARED :
+                                            WSREP_KEY_EXCLUSIVE, true));
+        }
+
+        galera::WriteSetNG::GatherVector out;
+        size_t const size(txm->write_set_out().gather(txm->source_id(),
+                                                      txm->conn_id(),
+                                                      txm->trx_id(), out));
+        wsrep_seqno_t const last_seen(
+            std::max<wsrep_seqno_t>(0, seqno - 1 -
+                                    (o.interval ? rng() % o.interval : 0)));
+        txm->finalize(last_seen);
+
+        std::vector<gu::byte_t> ws(size);
+        out.serialize(ws.data(), size);
+        batch.push_back(bench.slave(ws.data(), size, seqno, false));
+
+        if (batch.size() == o.batch)
+        {
+            bench.certify(batch);
+            batch.clear();
+        }
+    }
+
+    bench.certify(batch);
+    batch.clear();
+    bench.report();
+
+    ::unlink("cert_bench.cache");
+}
+
+static void
+run_recorded(const Options& o, gu::Config& conf)
+{
+    struct stat st;
+    if (::stat(o.gcache.c_str(), &st))
+    {
+        std::cerr << "Failed to stat '" << o.gcache << "': "
+                  << ::strerror(errno) << std::endl;
+        ::exit(EXIT_FAILURE);
+    }
+
+    /* gcache.size must match the file, otherwise it will be resized */
+    size_t const overhead(gcache::RingBuffer::pad_size() +
+                          sizeof(gcache::BufferHeader));
+    if (size_t(st.st_size) <= overhead)
+    {
+        std::cerr << "'" << o.gcache << "' is too small" << std::endl;
+        ::exit(EXIT_FAILURE);
+    }
+
+    conf.set("gcache.name", o.gcache);
+    conf.set("gcache.size", gu::to_string(st.st_size - overhead));
+    conf.set("gcache.recover", "yes");
+
+    galera::ProgressCallback<int64_t> pcb(WSREP_MEMBER_UNDEFINED,
+                                          WSREP_MEMBER_UNDEFINED);
+    gcache::GCache gcache(&pcb, conf, ".");
+
+    gcache::seqno_t const first(gcache.seqno_min());
+    if (first <= 0)
+    {
+        std::cerr << "No write sets found in '" << o.gcache << "'"
+                  << std::endl;
+        ::exit(EXIT_FAILURE);
+    }
+
+    Bench bench(conf, gcache);
+    bench.start(gu::GTID(gu::UUID(), first - 1));
+
+    std::vector<gcache::GCache::Buffer> bufs(o.batch);
+    std::vector<TrxHandleSlavePtr> batch;
+    batch.reserve(o.batch);
+
+    gcache::seqno_t seqno(first);
+    size_t n;
+
+    gcache.seqno_lock(first);
+
+    while ((n = gcache.seqno_get_buffers(bufs, seqno)) > 0)
+    {
+        for (size_t i(0); i < n; ++i, ++seqno)
+        {
+            const gcache::GCache::Buffer& b(bufs[i]);
+            assert(b.seqno_g() == seqno);
+
+            if (b.type() == GCS_ACT_WRITESET && !b.skip())
+            {
+                batch.push_back(bench.slave(b.ptr(), b.size(), seqno, true));
+            }
+            else
+            {
+                /* certify what is before the gap and leave the gap */
+                bench.certify(batch);
+                batch.clear();
+                bench.dummy(seqno);
+            }
+        }
+
+        bench.certify(batch);
+        batch.clear();
+    }
+
+    gcache.seqno_unlock();
+
+    std::cout << "Replayed " << o.gcache << ": seqnos " << first << " - "
+              << seqno - 1 << std::endl;
+    bench.report();
+}
+
+int main(int argc, char* argv[])
+{
+    Options const o(parse(argc, argv));
+
+    gu::Config conf;
+    galera::ReplicatorSMM::InitConfig init(conf, NULL, NULL);
+
+    if (o.gcache.empty())
+    {
+        std::cout << "Running with parameters: trxs = " << o.trxs
+                  << ", keys = " << o.keys << ", tables = " << o.tables
+                  << ", rows = " << o.rows << ", zipf = " << o.zipf
+                  << ", shared = " << o.shared
+                  << ", format = " << o.format_name
+                  << ", nodes = " << o.nodes << ", interval = " << o.interval
+                  << ", batch = " << o.batch << std::endl;
+
+        run_synthetic(o, conf);
+    }
+    else
+    {
+        run_recorded(o, conf);
+    }
+
+    return 0;
+}
@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+/**
+ * This is to benchmark certification index operations of the flat
+ * KeyEntryTableNG and compare those to the node based
+ * gu::UnorderedSet<KeyEntryNG*> which was used before.
+ *
+ * Usage: cert_index_bench [flat|node] [number of keys] [window] [loops]
+ *
+ * Numbers are representative only in a release (NDEBUG) build.
+ */
+
+#include "key_entry_table_ng.hpp"
+#include "gu_unordered.hpp"
+
+#include <sys/time.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <random>
+
+using galera::KeySet;
+using galera::KeyEntryNG;
+
+static double time_diff(const struct timeval& l,
+                        const struct timeval& r)
+{
+    double const left(double(l.tv_usec)*1.0e-06 + l.tv_sec);
+    double const right(double(r.tv_usec)*1.0e-06 + r.tv_sec);
+    return left - right;
+}
+
+/* Key parts with random 16-byte hashes stored in one contiguous buffer,
+ * like they would be in a writeset buffer. */
+class Keys
+{
+public:
+
+    Keys(size_t const n, KeySet::Version const ver)
+        : buf_(n * WORDS), parts_()
+    {
+        std::mt19937_64 rng(n);
+        parts_.reserve(n);
+
+        for (size_t i(0); i < n; ++i)
+        {
+            KeySet::KeyPart::HashData hd;
+            uint64_t* const h(reinterpret_cast<uint64_t*>(hd.buf));
+            h[0] = rng();
+            h[1] = rng();
+
+            KeySet::KeyPart::TmpStore ts;
+            KeySet::KeyPart const tmp(ts, hd, NULL, ver, 3, 0, 8);
+            uint64_t* const dst(&buf_[i * WORDS]);
+            ::memcpy(dst, ts.buf, sizeof(uint64_t) * WORDS);
+
+            parts_.push_back(KeySet::KeyPart(
+                                 reinterpret_cast<gu::byte_t*>(dst)));
+        }
+    }
+
+    size_t size() const { return parts_.size(); }
+    const KeySet::KeyPart& operator[](size_t i) const { return parts_[i]; }
+
+private:
+
+    static size_t const WORDS = 2;
+
+    std::vector<uint64_t>        buf_;
+    std::vector<KeySet::KeyPart> parts_;
+};
+
+/* Index operations in the way Certification used to perform them */
+class NodeIndex
+{
+public:
+
+    typedef gu::UnorderedSet<KeyEntryNG*, galera::KeyEntryPtrHashNG,
+                             galera::KeyEntryPtrEqualNG> Index;
+
+    static const char* name() { return "gu::UnorderedSet<KeyEntryNG*>"; }
+
+    NodeIndex() : index_() {}
+
+    ~NodeIndex()
+    {
+        std::for_each(index_.begin(), index_.end(), gu::DeleteObject());
+    }
+
+    void insert(const KeySet::KeyPart& kp)
+    {
+        KeyEntryNG ke(kp);
+        Index::iterator ci(index_.find(&ke));
+
+        if (ci == index_.end())
+        {
+            index_.insert(new KeyEntryNG(ke));
+        }
+    }
+
+    bool find(const KeySet::KeyPart& kp) const
+    {
+        KeyEntryNG ke(kp);
+        return index_.find(&ke) != index_.end();
+    }
+
+    void erase(const KeySet::KeyPart& kp)
+    {
+        KeyEntryNG ke(kp);
+        Index::iterator ci(index_.find(&ke));
+
+        if (ci != index_.end())
+        {
+            KeyEntryNG* const kep(*ci);
+            index_.erase(ci);
+            delete kep;
+        }
+    }
+
+    size_t size() const { return index_.size(); }
+
+private:
+
+    Index index_;
+};
+
+class FlatIndex
+{
+public:
+
+    static const char* name() { return "galera::KeyEntryTableNG"; }
+
+    FlatIndex() : index_() {}
+
+    void insert(const KeySet::KeyPart& kp)
+    {
+        index_.insert(kp);
+    }
+
+    bool find(const KeySet::KeyPart& kp) const
+    {
+        return index_.find(kp) != nullptr;
+    }
+
+    void erase(const KeySet::KeyPart& kp)
+    {
+        KeyEntryNG* const kep(index_.find(kp));
+        if (kep) index_.erase(kep);
+    }
+
+    size_t size() const { return index_.size(); }
+
+private:
+
+    galera::KeyEntryTableNG index_;
+};
+
+struct Metrics
+{
+    Metrics() : insert(0), find_hit(0), find_miss(0), slide(0), purge(0) {}
+
+    double insert;
+    double find_hit;
+    double find_miss;
+    double slide;
+    double purge;
+};
+
+template <class Index>
+static void
+run(const Keys& keys, size_t const window, Metrics& m)
+{
+    Index index;
+    size_t const n(keys.size() - window);
+    size_t found(0);
+    struct timeval tv_begin, tv_end;
+
+    /* initial population, like do_ref_keys() */
+    gettimeofday(&tv_begin, NULL);
+    for (size_t i(0); i < n; ++i) index.insert(keys[i]);
+    gettimeofday(&tv_end, NULL);
+    m.insert += time_diff(tv_end, tv_begin);
+
+    /* lookups of existing keys, like certify_v3to6() with conflicts */
+    gettimeofday(&tv_begin, NULL);
+    for (size_t i(0); i < n; ++i) found += index.find(keys[(i * 7919) % n]);
+    gettimeofday(&tv_end, NULL);
+    m.find_hit += time_diff(tv_end, tv_begin);
+
+    /* lookups of absent keys, like certify_v3to6() of new keys */
+    gettimeofday(&tv_begin, NULL);
+    for (size_t i(n); i < keys.size(); ++i) found += index.find(keys[i]);
+    gettimeofday(&tv_end, NULL);
+    m.find_miss += time_diff(tv_end, tv_begin);
+
+    /* sliding certification window: insert new keys, purge the oldest */
+    gettimeofday(&tv_begin, NULL);
+    for (size_t i(0); i < window; ++i)
+    {
+        index.insert(keys[n + i]);
+        index.erase(keys[i]);
+    }
+    gettimeofday(&tv_end, NULL);
+    m.slide += time_diff(tv_end, tv_begin);
+
+    /* purge everything, like purge_key_set() */
+    gettimeofday(&tv_begin, NULL);
+    for (size_t i(window); i < keys.size(); ++i) index.erase(keys[i]);
+    gettimeofday(&tv_end, NULL);
+    m.purge += time_diff(tv_end, tv_begin);
+
+    if (found != n || index.size() != 0)
+    {
+        std::cerr << "Unexpected result: found " << found << " out of " << n
+                  << ", left " << index.size() << std::endl;
+        ::abort();
+    }
+}
+
+template <class Index>
+static void
+loops(const Keys& keys, size_t const window, int const loops)
+{
+    Metrics m;
+
+    for (int l(1); l <= loops; ++l)
+    {
+        run<Index>(keys, window, m);
+    }
+
+    double const n(double(keys.size() - window) * loops);
+    double const w(double(window) * loops);
+    std::cout << "================" << std::endl;
+    std::cout << Index::name() << ", ns per operation:" << std::endl;
+    std::cout << "insert:\t\t"    << m.insert    * 1.0e9 / n << std::endl;
+    std::cout << "find (hit):\t"  << m.find_hit  * 1.0e9 / n << std::endl;
+    std::cout << "find (miss):\t" << m.find_miss * 1.0e9 / w << std::endl;
+    std::cout << "insert+erase:\t" << m.slide    * 1.0e9 / w << std::endl;
+    std::cout << "erase:\t\t"     << m.purge     * 1.0e9 / n << std::endl;
+    std::cout << "----------------" << std::endl;
+}
+
+template <typename T> void
+read_arg(char* argv[], int position, T& var)
+{
+    std::string arg(argv[position]);
+    std::istringstream is(arg);
+    is >> var;
+}
+
+int main(int argc, char* argv[])
+{
+    static const char* const FLAT = "flat";
+    static const char* const NODE = "node";
+
+    std::string index(FLAT);
+    size_t keys_num(1 << 20); // 1M
+    size_t window(1 << 16);
+    int    base_loops(4);
+
+    if (argc >= 2) read_arg(argv, 1, index);
+    if (argc >= 3) read_arg(argv, 2, keys_num);
+    if (argc >= 4) read_arg(argv, 3, window);
+    if (argc >= 5) read_arg(argv, 4, base_loops);
+
+    window = std::min(window, keys_num / 2);
+
+    std::cout << "Running with parameters: index type = " << index
+              << ", keys = " << keys_num << ", window = " << window
+              << ", loops = " << base_loops << '\n';
+
+    Keys const keys(keys_num + window, KeySet::FLAT16);
+
+    if (index == FLAT)
+        loops<FlatIndex>(keys, window, base_loops);
+    else if (index == NODE)
+        loops<NodeIndex>(keys, window, base_loops);
+    else
+    {
+        std::cerr << "First option should be either '" << FLAT << "' or '"
+                  << NODE << "'" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
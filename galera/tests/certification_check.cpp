@@ -4,6 +4,7 @@
 
 #include "replicator_smm.hpp" // ReplicatorSMM::InitConfig
 #include "certification.hpp"
+#include "cert_index_snapshot.hpp"
 #include "trx_handle.hpp"
 #include "key_os.hpp"
 
@@ -720,11 +721,27 @@ struct CertFixture
         galera::TrxHandleSlavePtr ts;
     };
 
-    CfCertResult append(const wsrep_uuid_t& node, wsrep_conn_id_t conn,
-                        wsrep_seqno_t last_seen,
-                        const std::vector<const char*>& key,
-                        wsrep_key_type_t type, int flags,
-                        const gu::byte_t* data_buf, size_t data_buf_len)
+    galera::TrxHandleSlavePtr make_ts(const wsrep_uuid_t& node,
+                                      wsrep_conn_id_t conn,
+                                      wsrep_seqno_t last_seen,
+                                      const std::vector<const char*>& key,
+                                      wsrep_key_type_t type, int flags,
+                                      const gu::byte_t* data_buf,
+                                      size_t data_buf_len)
+    {
+        std::vector<std::vector<const char*> > const keys(1, key);
+        return make_ts_keys(node, conn, last_seen, keys, type, flags,
+                            data_buf, data_buf_len);
+    }
+
+    galera::TrxHandleSlavePtr make_ts_keys(
+        const wsrep_uuid_t& node,
+        wsrep_conn_id_t conn,
+        wsrep_seqno_t last_seen,
+        const std::vector<std::vector<const char*> >& keys,
+        wsrep_key_type_t type, int flags,
+        const gu::byte_t* data_buf,
+        size_t data_buf_len)
     {
         galera::TrxHandleMasterPtr txm{ galera::TrxHandleMaster::New(
                                             mp,
@@ -734,8 +751,11 @@ struct CertFixture
                                             node, conn, cur_trx_id),
                                         galera::TrxHandleMasterDeleter{} };
         txm->set_flags(flags);
-        TestKey tkey{ txm->version(), type, key };
-        txm->append_key(tkey());
+        for (size_t i(0); i < keys.size(); ++i)
+        {
+            TestKey tkey{ txm->version(), type, keys[i] };
+            txm->append_key(tkey());
+        }
         if (data_buf)
         {
             txm->append_data(data_buf, data_buf_len, WSREP_DATA_ORDERED, false);
@@ -754,6 +774,17 @@ struct CertFixture
         galera::TrxHandleSlavePtr ts(galera::TrxHandleSlave::New(false, sp),
                                      galera::TrxHandleSlaveDeleter{});
         ck_assert(ts->unserialize<true>(gcache, act) == size);
+        return ts;
+    }
+
+    CfCertResult append(const wsrep_uuid_t& node, wsrep_conn_id_t conn,
+                        wsrep_seqno_t last_seen,
+                        const std::vector<const char*>& key,
+                        wsrep_key_type_t type, int flags,
+                        const gu::byte_t* data_buf, size_t data_buf_len)
+    {
+        galera::TrxHandleSlavePtr ts(make_ts(node, conn, last_seen, key, type,
+                                             flags, data_buf, data_buf_len));
         auto result = cert.append_trx(ts);
         /* Mark committed here to avoid doing it in every test case. If the
          * ts is not marked as committed, the certification destructor will
@@ -823,6 +854,137 @@ START_TEST(cert_append_trx)
 }
 END_TEST
 
+/* TREE8 key set stores db/t1 again to parent db/t1/r2, the repeated part
+ * must be neither referenced twice nor purged twice */
+START_TEST(cert_tree8_repeat_purge)
+{
+    CertFixture f;
+    int const flags(galera::TrxHandle::F_BEGIN | galera::TrxHandle::F_COMMIT);
+    std::vector<std::vector<const char*> > const keys =
+    {
+        { "db", "t1", "r1" },
+        { "db", "t2", "r1" },
+        { "db", "t1", "r2" }
+    };
+
+    galera::TrxHandleSlavePtr ts1(f.make_ts_keys(f.node1, f.conn1, 0, keys,
+                                                 WSREP_KEY_EXCLUSIVE, flags,
+                                                 nullptr, 0));
+    ck_assert_int_eq(f.cert.append_trx(ts1), CertResult::TEST_OK);
+
+    double avg_cert_interval, avg_deps_dist;
+    size_t index_size;
+    f.cert.stats_get(avg_cert_interval, avg_deps_dist, index_size);
+    /* db, db/t1, db/t1/r1, db/t2, db/t2/r1, db/t1/r2 */
+    ck_assert_int_eq(index_size, 6);
+
+    /* the part following the repeat must be found */
+    galera::TrxHandleSlavePtr ts2(f.make_ts(f.node2, f.conn2, 0,
+                                            { "db", "t1", "r2" },
+                                            WSREP_KEY_EXCLUSIVE, flags,
+                                            nullptr, 0));
+    ck_assert_int_eq(f.cert.append_trx(ts2), CertResult::TEST_FAILED);
+
+    /* has seen both, so that they become safe to discard on commit */
+    galera::TrxHandleSlavePtr ts3(f.make_ts(f.node2, f.conn2, 2, { "x" },
+                                            WSREP_KEY_EXCLUSIVE, flags,
+                                            nullptr, 0));
+    ck_assert_int_eq(f.cert.append_trx(ts3), CertResult::TEST_OK);
+
+    f.cert.set_trx_committed(*ts1);
+    f.cert.set_trx_committed(*ts2);
+    f.cert.set_trx_committed(*ts3);
+    ck_assert_int_eq(f.cert.purge_trxs_upto(ts2->global_seqno(), false),
+                     ts2->global_seqno());
+
+    galera::TrxHandleSlavePtr ts4(f.make_ts(f.node1, f.conn1, 3, { "y" },
+                                            WSREP_KEY_EXCLUSIVE, flags,
+                                            nullptr, 0));
+    ck_assert_int_eq(f.cert.append_trx(ts4), CertResult::TEST_OK);
+    ts4->mark_committed();
+    f.cert.stats_get(avg_cert_interval, avg_deps_dist, index_size);
+    /* only x and y remain */
+    ck_assert_int_eq(index_size, 2);
+}
+END_TEST
+
+/* Purge of a large number of trxs is done in steps, the index must
+ * certify correctly while some of the purged trxs are still in it */
+START_TEST(cert_partial_purge)
+{
+    CertFixture f;
+    int const flags(galera::TrxHandle::F_BEGIN | galera::TrxHandle::F_COMMIT);
+    int const n(1500); // more than one purge step of keys
+
+    std::vector<std::string> names;
+    for (int i(0); i < n; ++i) names.push_back(gu::to_string(i));
+
+    std::vector<galera::TrxHandleSlavePtr> tss;
+    for (int i(0); i < n; ++i)
+    {
+        tss.push_back(f.make_ts(f.node1, f.conn1, i,
+                                { "p", names[i].c_str() },
+                                WSREP_KEY_EXCLUSIVE, flags, nullptr, 0));
+        ck_assert_int_eq(f.cert.append_trx(tss.back()), CertResult::TEST_OK);
+    }
+    /* has seen all, so that they become safe to discard on commit */
+    tss.push_back(f.make_ts(f.node1, f.conn1, n, { "x" },
+                            WSREP_KEY_EXCLUSIVE, flags, nullptr, 0));
+    ck_assert_int_eq(f.cert.append_trx(tss.back()), CertResult::TEST_OK);
+
+    for (size_t i(0); i < tss.size(); ++i) f.cert.set_trx_committed(*tss[i]);
+    ck_assert_int_eq(f.cert.purge_trxs_upto(n, false), n);
+
+    double avg_cert_interval, avg_deps_dist;
+    size_t index_size;
+
+    galera::TrxHandleSlavePtr tsa(f.make_ts(f.node2, f.conn2, n + 1,
+                                            { "p", names[0].c_str() },
+                                            WSREP_KEY_EXCLUSIVE, flags,
+                                            nullptr, 0));
+    ck_assert_int_eq(f.cert.append_trx(tsa), CertResult::TEST_OK);
+    f.cert.stats_get(avg_cert_interval, avg_deps_dist, index_size);
+    ck_assert(index_size > 4); // not purged completely yet
+
+    /* takes over the key of a trx still queued for purge */
+    galera::TrxHandleSlavePtr tsb(f.make_ts(f.node2, f.conn2, n + 1,
+                                            { "p", names[n - 1].c_str() },
+                                            WSREP_KEY_EXCLUSIVE, flags,
+                                            nullptr, 0));
+    ck_assert_int_eq(f.cert.append_trx(tsb), CertResult::TEST_OK);
+
+    galera::TrxHandleSlavePtr tsc(f.make_ts(f.node1, f.conn1, n + 1,
+                                            { "p", names[n - 1].c_str() },
+                                            WSREP_KEY_EXCLUSIVE, flags,
+                                            nullptr, 0));
+    ck_assert_int_eq(f.cert.append_trx(tsc), CertResult::TEST_FAILED);
+
+    while (f.cert.purge_step()) {}
+
+    /* purge of the queued trx must leave the key to tsb */
+    galera::TrxHandleSlavePtr tsd(f.make_ts(f.node1, f.conn1, n + 1,
+                                            { "p", names[n - 1].c_str() },
+                                            WSREP_KEY_EXCLUSIVE, flags,
+                                            nullptr, 0));
+    ck_assert_int_eq(f.cert.append_trx(tsd), CertResult::TEST_FAILED);
+
+    /* index size is sampled on successful append */
+    galera::TrxHandleSlavePtr tse(f.make_ts(f.node2, f.conn2, n + 1, { "y" },
+                                            WSREP_KEY_EXCLUSIVE, flags,
+                                            nullptr, 0));
+    ck_assert_int_eq(f.cert.append_trx(tse), CertResult::TEST_OK);
+    f.cert.stats_get(avg_cert_interval, avg_deps_dist, index_size);
+    /* x, p, p/0, p/1499, y */
+    ck_assert_int_eq(index_size, 5);
+
+    f.cert.set_trx_committed(*tsa);
+    f.cert.set_trx_committed(*tsb);
+    f.cert.set_trx_committed(*tsc);
+    f.cert.set_trx_committed(*tsd);
+    f.cert.set_trx_committed(*tse);
+}
+END_TEST
+
 /*
  * Cert against shared
  */
@@ -1535,6 +1697,368 @@ START_TEST(cert_certify_no_match)
 }
 END_TEST
 
+START_TEST(cert_explicit_deps)
+{
+    CertFixture f;
+    f.cert.param_set("cert.explicit_deps", "yes");
+
+    auto res
+        = f.append_trx(f.node1, f.conn1, 0, { "a", "x" }, WSREP_KEY_EXCLUSIVE);
+    ck_assert_int_eq(res.result, CertResult::TEST_OK);
+    res = f.append_trx(f.node1, f.conn1, 0, { "b", "y" }, WSREP_KEY_EXCLUSIVE);
+    ck_assert_int_eq(res.result, CertResult::TEST_OK);
+
+    /* depends on 2 only */
+    res = f.append_trx(f.node2, f.conn2, 2, { "b", "y" }, WSREP_KEY_EXCLUSIVE);
+    ck_assert_int_eq(res.result, CertResult::TEST_OK);
+    ck_assert_int_eq(res.ts->depends_seqno(), 2);
+    ck_assert_int_eq(res.ts->pa_barrier(), 0);
+    ck_assert_int_eq(res.ts->pa_deps_count(), 1);
+    ck_assert_int_eq(res.ts->pa_dep(0), 2);
+
+    /* only the latest shared reference is known, must wait for all */
+    res = f.append_trx(f.node1, f.conn1, 3, { "c", "z" }, WSREP_KEY_SHARED);
+    ck_assert_int_eq(res.result, CertResult::TEST_OK);
+    res = f.append_trx(f.node2, f.conn2, 4, { "c", "z" }, WSREP_KEY_EXCLUSIVE);
+    ck_assert_int_eq(res.result, CertResult::TEST_OK);
+    ck_assert_int_eq(res.ts->depends_seqno(), 4);
+    ck_assert_int_eq(res.ts->pa_barrier(), 4);
+    ck_assert_int_eq(res.ts->pa_deps_count(), 0);
+
+    f.cert.param_set("cert.explicit_deps", "no");
+    res = f.append_trx(f.node2, f.conn2, 5, { "b", "y" }, WSREP_KEY_EXCLUSIVE);
+    ck_assert_int_eq(res.result, CertResult::TEST_OK);
+    ck_assert_int_eq(res.ts->depends_seqno(), 3);
+    ck_assert_int_eq(res.ts->pa_barrier(), 3);
+    ck_assert_int_eq(res.ts->pa_deps_count(), 0);
+}
+END_TEST
+
+START_TEST(cert_hotspots)
+{
+    CertFixture f;
+    gu::Status status;
+
+    f.cert.hotspots_status(status);
+    ck_assert_int_eq(status.size(), 0); // disabled by default
+
+    f.cert.param_set("cert.hotspots", "4");
+
+    auto res
+        = f.append_trx(f.node1, f.conn1, 0, { "b", "l" }, WSREP_KEY_EXCLUSIVE);
+    ck_assert_int_eq(res.result, CertResult::TEST_OK);
+    res = f.append_trx(f.node2, f.conn2, 0, { "b", "l" }, WSREP_KEY_EXCLUSIVE);
+    ck_assert_int_eq(res.result, CertResult::TEST_FAILED);
+    res = f.append_trx(f.node2, f.conn2, 1, { "b", "l" }, WSREP_KEY_EXCLUSIVE);
+    ck_assert_int_eq(res.result, CertResult::TEST_OK);
+
+    f.cert.hotspots_status(status);
+    ck_assert_int_eq(status.size(), 2);
+    for (gu::Status::const_iterator i(status.begin()); i != status.end(); ++i)
+    {
+        ck_assert_msg(i->second.find("1:") == 0, "%s = '%s'",
+                      i->first.c_str(), i->second.c_str());
+    }
+
+    f.cert.param_set("cert.hotspots_dump", "");
+
+    try
+    {
+        f.cert.param_set("cert.hotspots", "-1");
+        ck_abort_msg("negative top size was accepted");
+    }
+    catch (gu::Exception& e)
+    {
+        ck_assert_int_eq(e.get_errno(), EINVAL);
+    }
+
+    f.cert.param_set("cert.hotspots", "0");
+    gu::Status disabled;
+    f.cert.hotspots_status(disabled);
+    ck_assert_int_eq(disabled.size(), 0);
+}
+END_TEST
+
+
+/*
+ * Flat certification index table
+ */
+
+/* Creates n key parts with 16-byte hashes in buf. To exercise collision
+ * handling every fourth hash differs from the previous one only in the high
+ * half and hash low bits are set to cluster keys in the same table slots. */
+static std::vector<galera::KeySet::KeyPart>
+make_key_parts(std::vector<uint64_t>& buf, size_t const n)
+{
+    std::vector<galera::KeySet::KeyPart> ret;
+    buf.resize(n * 2);
+
+    for (size_t i(0); i < n; ++i)
+    {
+        galera::KeySet::KeyPart::HashData hd;
+        uint64_t* const h(reinterpret_cast<uint64_t*>(hd.buf));
+        h[0] = gu::htog<uint64_t>(((i & ~size_t(3)) << 16) + (i % 5) * 32);
+        h[1] = gu::htog<uint64_t>(i);
+
+        galera::KeySet::KeyPart::TmpStore ts;
+        galera::KeySet::KeyPart const tmp(ts, hd, NULL, galera::KeySet::FLAT16,
+                                          0, 0, 8);
+        ::memcpy(&buf[i * 2], ts.buf, 2 * sizeof(uint64_t));
+        ret.push_back(galera::KeySet::KeyPart(
+                          reinterpret_cast<const gu::byte_t*>(&buf[i * 2])));
+    }
+
+    return ret;
+}
+
+START_TEST(cert_index_insert_find_erase)
+{
+    std::vector<uint64_t> buf;
+    size_t const n(10000);
+    std::vector<galera::KeySet::KeyPart> const keys(make_key_parts(buf, n));
+
+    galera::KeyEntryTableNG index;
+    ck_assert(index.find(keys[0]) == nullptr);
+
+    for (size_t i(0); i < n; ++i)
+    {
+        ck_assert(index.insert(keys[i]).second);
+        ck_assert(!index.insert(keys[i]).second);
+    }
+    ck_assert_int_eq(index.size(), n);
+    ck_assert(index.capacity() > n);
+    ck_assert_int_eq(std::distance(index.begin(), index.end()), n);
+
+    for (size_t i(0); i < n; ++i)
+    {
+        const galera::KeyEntryNG* const kep(index.find(keys[i]));
+        ck_assert(kep != nullptr);
+        ck_assert(kep->key().matches(keys[i]));
+    }
+
+    /* erase every other key in pseudo-random order */
+    for (size_t i(0); i < n; ++i)
+    {
+        size_t const k((i * 7919) % n);
+        if (k % 2) continue;
+        galera::KeyEntryNG* const kep(index.find(keys[k]));
+        ck_assert(kep != nullptr);
+        index.erase(kep);
+    }
+    ck_assert_int_eq(index.size(), n / 2);
+
+    for (size_t i(0); i < n; ++i)
+    {
+        ck_assert_msg((index.find(keys[i]) != nullptr) == (i % 2),
+                      "Key %zu is %s", i, (i % 2) ? "missing" : "present");
+    }
+
+    /* erasing the rest should shrink the table */
+    size_t const cap(index.capacity());
+    for (size_t i(1); i < n; i += 2)
+    {
+        index.erase(index.find(keys[i]));
+    }
+    ck_assert(index.empty());
+    ck_assert(index.capacity() < cap);
+    ck_assert(index.begin() == index.end());
+
+    index.insert(keys[0]);
+    index.clear();
+    ck_assert(index.empty());
+    ck_assert(index.find(keys[0]) == nullptr);
+}
+END_TEST
+
+START_TEST(cert_index_snapshot_write_read)
+{
+    std::string const file("cert_index_snapshot_check.dat");
+    gu::GTID const gtid(gu::UUID(0, 0), 100);
+
+    std::vector<std::string> bufs;
+    galera::CertIndexSnapshot::Records records;
+    for (int i(0); i < 10; ++i)
+    {
+        bufs.push_back(std::string(i * 3 + 1, 'a' + i));
+    }
+    for (int i(0); i < 10; ++i)
+    {
+        galera::CertIndexSnapshot::Record const r =
+            { 90 + i, bufs[i].data(), bufs[i].size() };
+        records.push_back(r);
+    }
+
+    galera::CertIndexSnapshot::write(file, gtid, 90, 6, records);
+
+    {
+        galera::CertIndexSnapshot const snap(file);
+        ck_assert(snap.gtid() == gtid);
+        ck_assert_int_eq(snap.lowest(), 90);
+        ck_assert_int_eq(snap.version(), 6);
+        ck_assert_int_eq(snap.records().size(), records.size());
+        for (size_t i(0); i < records.size(); ++i)
+        {
+            const galera::CertIndexSnapshot::Record& r(snap.records()[i]);
+            ck_assert_int_eq(r.seqno, records[i].seqno);
+            ck_assert_int_eq(r.size, records[i].size);
+            ck_assert(!::memcmp(r.ptr, records[i].ptr, r.size));
+        }
+    }
+
+    /* corrupt one byte of the last record */
+    FILE* const f(fopen(file.c_str(), "r+"));
+    ck_assert(f != NULL);
+    ck_assert(fseek(f, -5, SEEK_END) == 0);
+    ck_assert(fputc('z', f) == 'z');
+    ck_assert(fclose(f) == 0);
+
+    try
+    {
+        galera::CertIndexSnapshot const snap(file);
+        ck_abort_msg("corrupted snapshot was not detected");
+    }
+    catch (gu::Exception& e)
+    {
+        ck_assert_int_eq(e.get_errno(), EINVAL);
+    }
+
+    ::unlink(file.c_str());
+}
+END_TEST
+
+/* Index saved to a snapshot and restored into another certification
+ * object: the failed trx keeps its seqno in the trx map and the position
+ * is the snapshot seqno even though the last trx is below it. */
+START_TEST(cert_index_snapshot_restore)
+{
+    std::string const file("cert_index_snapshot_restore.dat");
+    CertFixture f;
+    int const flags(galera::TrxHandle::F_BEGIN | galera::TrxHandle::F_COMMIT);
+
+    std::vector<CertFixture::CfCertResult> res;
+    res.push_back(f.append_trx(f.node1, f.conn1, 0, { "b", "l1" },
+                               WSREP_KEY_EXCLUSIVE));
+    res.push_back(f.append_trx(f.node2, f.conn2, 0, { "b", "l1" },
+                               WSREP_KEY_EXCLUSIVE));
+    res.push_back(f.append_trx(f.node2, f.conn2, 2, { "b", "l2" },
+                               WSREP_KEY_EXCLUSIVE));
+    ck_assert_int_eq(res[0].result, CertResult::TEST_OK);
+    ck_assert_int_eq(res[1].result, CertResult::TEST_FAILED);
+    ck_assert_int_eq(res[2].result, CertResult::TEST_OK);
+    ck_assert(res[1].ts->is_dummy());
+
+    for (size_t i(0); i < res.size(); ++i)
+    {
+        f.gcache.seqno_assign(res[i].ts->action().first,
+                              res[i].ts->global_seqno(), GCS_ACT_WRITESET,
+                              res[i].result != CertResult::TEST_OK);
+    }
+
+    /* configuration change after the last trx */
+    gu::GTID const gtid(gu::UUID(0, 0), 4);
+    f.cert.adjust_position(galera::View(), gtid, f.version);
+    ck_assert(f.cert.write_snapshot(file, gtid));
+
+    galera::CertIndexSnapshot const snap(file);
+    ::unlink(file.c_str());
+    ck_assert(snap.gtid() == gtid);
+    ck_assert_int_eq(snap.lowest(), 1);
+    ck_assert_int_eq(snap.records().size(), 3);
+    ck_assert_int_eq(snap.records()[1].seqno, 2);
+    ck_assert_int_eq(snap.records()[1].size, 0);
+
+    galera::Certification cert(f.conf, f.gcache, 0);
+    cert.restore_snapshot(snap, f.sp);
+    ck_assert_int_eq(cert.position(), 4);
+    ck_assert_int_eq(cert.lowest_trx_seqno(), 1);
+
+    f.cur_seqno = cert.position();
+
+    /* conflicts with restored seqno 3 */
+    galera::TrxHandleSlavePtr ts5(f.make_ts(f.node1, f.conn1, 2, { "b", "l2" },
+                                            WSREP_KEY_EXCLUSIVE, flags,
+                                            nullptr, 0));
+    ck_assert_int_eq(cert.append_trx(ts5), CertResult::TEST_FAILED);
+    cert.set_trx_committed(*ts5);
+
+    galera::TrxHandleSlavePtr ts6(f.make_ts(f.node1, f.conn1, 5, { "b", "l2" },
+                                            WSREP_KEY_EXCLUSIVE, flags,
+                                            nullptr, 0));
+    ck_assert_int_eq(cert.append_trx(ts6), CertResult::TEST_OK);
+    cert.set_trx_committed(*ts6);
+
+    /* purge goes over the placeholder of the failed trx, seqno 4 was not
+     * a trx */
+    cert.purge_trxs_upto(3, false);
+    ck_assert_int_eq(cert.lowest_trx_seqno(), 5);
+}
+END_TEST
+
+START_TEST(cert_hotspots_top)
+{
+    std::vector<uint64_t> buf;
+    size_t const n(100);
+    std::vector<galera::KeySet::KeyPart> const keys(make_key_parts(buf, n));
+
+    galera::KeyHotspots hs(3);
+
+    /* key i is recorded i times, only the last 3 should make it to top */
+    for (size_t i(0); i < n; ++i)
+    {
+        for (size_t j(0); j < i; ++j)
+        {
+            hs.record(galera::KeyHotspots::CONFLICT, keys[i]);
+        }
+    }
+    hs.record(galera::KeyHotspots::DEPENDENCY, keys[0]);
+
+    std::string const conflicts(hs.str(galera::KeyHotspots::CONFLICT));
+    ck_assert_msg(conflicts.find("99:") == 0, "%s", conflicts.c_str());
+    ck_assert_msg(conflicts.find("; 98:") != std::string::npos, "%s",
+                  conflicts.c_str());
+    ck_assert_msg(conflicts.find("; 97:") != std::string::npos, "%s",
+                  conflicts.c_str());
+    ck_assert_int_eq(std::count(conflicts.begin(), conflicts.end(), ';'), 2);
+
+    std::string const deps(hs.str(galera::KeyHotspots::DEPENDENCY));
+    ck_assert_msg(deps.find("1:") == 0, "%s", deps.c_str());
+
+    hs.clear();
+    ck_assert(hs.enabled());
+    ck_assert(hs.str(galera::KeyHotspots::CONFLICT).empty());
+}
+END_TEST
+
+START_TEST(cert_hotspots_interleaved)
+{
+    std::vector<uint64_t> buf;
+    size_t const n(100);
+    std::vector<galera::KeySet::KeyPart> const keys(make_key_parts(buf, n));
+
+    galera::KeyHotspots hs(8);
+
+    /* key i is recorded i times in round robin, so top entries keep
+     * overtaking each other and the ones that enter early are evicted */
+    for (size_t round(0); round < n; ++round)
+    {
+        for (size_t i(round + 1); i < n; ++i)
+        {
+            hs.record(galera::KeyHotspots::CONFLICT, keys[i]);
+        }
+    }
+
+    std::ostringstream expected;
+    for (size_t i(n - 1); i >= n - 8; --i)
+    {
+        if (i < n - 1) expected << "; ";
+        expected << i << ':' << keys[i];
+    }
+
+    ck_assert_msg(hs.str(galera::KeyHotspots::CONFLICT) == expected.str(),
+                  "expected '%s', got '%s'", expected.str().c_str(),
+                  hs.str(galera::KeyHotspots::CONFLICT).c_str());
+}
+END_TEST
 
 Suite* certification_suite()
 {
@@ -1624,7 +2148,19 @@ Suite* certification_suite()
     tcase_add_test(t, cert_certify_shared_shared_pa_unsafe);
     tcase_add_test(t, cert_certify_no_match_pa_unsafe);
     tcase_add_test(t, cert_certify_no_match);
+    tcase_add_test(t, cert_explicit_deps);
+    tcase_add_test(t, cert_hotspots);
+    tcase_add_test(t, cert_tree8_repeat_purge);
+    tcase_add_test(t, cert_partial_purge);
+
+    suite_add_tcase(s, t);
 
+    t = tcase_create("certification_index");
+    tcase_add_test(t, cert_index_insert_find_erase);
+    tcase_add_test(t, cert_index_snapshot_write_read);
+    tcase_add_test(t, cert_index_snapshot_restore);
+    tcase_add_test(t, cert_hotspots_top);
+    tcase_add_test(t, cert_hotspots_interleaved);
     suite_add_tcase(s, t);
 
     return s;
@@ -1,4 +1,4 @@
-/* Copyright (C) 2013-2023 Codership Oy <info@codership.com>
+/* Copyright (C) 2013-2026 Codership Oy <info@codership.com>
  *
  * $Id$
  */
@@ -9,6 +9,7 @@
 
 #include "gu_logger.hpp"
 #include "gu_hexdump.hpp"
+#include "gu_serialize.hpp"
 
 #include <check.h>
 
@@ -242,6 +243,133 @@ static void test_ver(gu::RecordSet::Version const rsv)
     }
 }
 
+static void test_compressed(size_t const threshold, bool const compressed)
+{
+    size_t const MB = 1 << 20;
+
+    TestRecord rout0(128,  "abc0");
+    TestRecord rout1(4096, "abc1");
+    TestRecord rout2(1*MB, "klm");
+
+    std::vector<TestRecord*> records;
+    records.push_back (&rout0);
+    records.push_back (&rout1);
+    records.push_back (&rout2);
+
+    std::vector<gu::byte_t> raw;
+
+    union { gu::byte_t buf[1024]; gu_word_t align; } reserved;
+    TestBaseName str("data_set_test");
+    DataSetOut dset_out(reserved.buf, sizeof(reserved.buf), str, DataSet::VER2,
+                        gu::RecordSet::VER2, threshold);
+
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const gu::byte_t* const ptr
+            (static_cast<const gu::byte_t*>(records[i]->buf()));
+        raw.insert(raw.end(), ptr, ptr + records[i]->serial_size());
+        dset_out.append (ptr, records[i]->serial_size(), i % 2);
+    }
+
+    ck_assert(DataSet::VER2 == dset_out.version());
+
+    DataSetOut::GatherVector out_bufs;
+    size_t const out_size (dset_out.gather (out_bufs));
+    ck_assert_msg(0 == out_size % gu::RecordSet::VER2_ALIGNMENT,
+                  "out size %zu not aligned", out_size);
+
+    if (compressed)
+        ck_assert_msg(out_size < raw.size() / 8,
+                      "expected compression of %zu bytes, got %zu",
+                      raw.size(), out_size);
+    else
+        ck_assert_msg(out_size > raw.size(),
+                      "expected %zu bytes to be sent as is, got %zu",
+                      raw.size(), out_size);
+
+    std::vector<gu::byte_t> in_buf;
+    in_buf.reserve(out_size);
+    for (size_t i = 0; i < out_bufs->size(); ++i)
+    {
+        const gu::byte_t* ptr
+            (reinterpret_cast<const gu::byte_t*>(out_bufs[i].ptr));
+        in_buf.insert (in_buf.end(), ptr, ptr + out_bufs[i].size);
+    }
+    ck_assert(in_buf.size() == out_size);
+
+    galera::DataSetIn dset_in;
+    dset_in.init(dset_out.version(), in_buf.data(), in_buf.size());
+
+    try { dset_in.checksum(); }
+    catch(gu::Exception& e) { ck_abort_msg("%s", e.what()); }
+
+    ck_assert(dset_in.serial_size() == out_size);
+
+    /* make sure that rewind() and count() trigger unpacking as well */
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        if (pass) dset_in.rewind();
+        ck_assert(1 == dset_in.count());
+        gu::Buf const data(dset_in.next());
+        ck_assert_msg(size_t(data.size) == raw.size(),
+                      "expected %zu bytes, found %zd", raw.size(), data.size);
+        ck_assert(0 == ::memcmp(data.ptr, raw.data(), raw.size()));
+    }
+
+    if (compressed)
+    {
+        /* bogus uncompressed size must be rejected before allocating it */
+        gu::RecordSetIn<galera::DataSet::RecordIn> const
+            outer(in_buf.data(), in_buf.size(), false);
+        size_t const size_off(static_cast<const gu::byte_t*>
+                              (outer.next().buf().ptr) - in_buf.data());
+
+        std::vector<gu::byte_t> bad_buf(in_buf);
+        gu::serialize8(uint64_t(1) << 40, bad_buf.data(), bad_buf.size(),
+                       size_off);
+        galera::DataSetIn const dset_bad(dset_out.version(),
+                                         bad_buf.data(), bad_buf.size());
+        try
+        {
+            dset_bad.count();
+            ck_abort_msg("Bogus uncompressed size not detected");
+        }
+        catch(gu::Exception& e)
+        {
+            ck_assert_int_eq(e.get_errno(), EINVAL);
+        }
+    }
+
+    /* corrupted compressed payload must be detected by outer checksum */
+    in_buf[in_buf.size() / 2] ^= 0x01;
+    galera::DataSetIn const dset_bad(dset_out.version(),
+                                     in_buf.data(), in_buf.size());
+    try
+    {
+        dset_bad.checksum();
+        ck_abort_msg("Corruption not detected");
+    }
+    catch(gu::Exception& e) {}
+}
+
+START_TEST (ver2_compressed)
+{
+    test_compressed(1024, true);
+}
+END_TEST
+
+START_TEST (ver2_below_threshold)
+{
+    test_compressed(16 << 20, false);
+}
+END_TEST
+
+START_TEST (ver2_no_compression)
+{
+    test_compressed(0, false);
+}
+END_TEST
+
 #ifndef GALERA_ONLY_ALIGNED
 START_TEST (ver1)
 {
@@ -256,6 +384,13 @@ START_TEST (ver2)
 }
 END_TEST
 
+START_TEST (ver3)
+{
+    gu_crc32c_configure(); // select CRC-32C implementation
+    test_ver(gu::RecordSet::VER3);
+}
+END_TEST
+
 Suite* data_set_suite ()
 {
     TCase* t = tcase_create ("DataSet");
@@ -263,6 +398,10 @@ Suite* data_set_suite ()
     tcase_add_test (t, ver1);
 #endif
     tcase_add_test (t, ver2);
+    tcase_add_test (t, ver3);
+    tcase_add_test (t, ver2_compressed);
+    tcase_add_test (t, ver2_below_threshold);
+    tcase_add_test (t, ver2_no_compression);
     tcase_set_timeout(t, 60);
 
     Suite* s = suite_create ("DataSet");
@@ -30,8 +30,11 @@ static const char* Defaults[] =
 {
     "base_dir",                    ".",
     "base_port",                   "4567",
+    "cert.explicit_deps",          "no",
+    "cert.hotspots",               "0",
     "cert.log_conflicts",          "no",
     "cert.optimistic_pa",          "yes",
+    "cert.snapshot",               "no",
     "debug",                       "no",
 #ifdef GU_DBUG_ON
     "dbug",                        "",
@@ -59,11 +62,16 @@ static const char* Defaults[] =
     "gcache.debug",                "0",
 #endif
     "gcache.dir",                  ".",
+    "gcache.hugepages",            "no",
     "gcache.keep_pages_size",      "0",
     "gcache.keep_plaintext_size",  "128M", /* defaults to gcache.page_size */
     "gcache.mem_size",             "0",
+    "gcache.mlock",                "no",
     "gcache.name",                 "galera.cache",
+    "gcache.numa_bind",            "no",
+    "gcache.page_prealloc",        "1",
     "gcache.page_size",            "128M",
+    "gcache.populate",             "no",
     "gcache.recover",              "yes",
     "gcache.size",                 "128M",
     "gcomm.thread_prio",           "",
@@ -103,9 +111,12 @@ static const char* Defaults[] =
     "protonet.version",            "0",
     "repl.causal_read_timeout",    "PT30S",
     "repl.commit_order",           "3",
+    "repl.compress_threshold",     "0",
     "repl.key_format",             "FLAT8",
     "repl.max_ws_size",            "2147483647",
-    "repl.proto_max",              "11",
+    "repl.monitor_window",         "65536",
+    "repl.proto_max",              "14",
+    "repl.ws_arena",               "NONE",
 #ifdef GU_DBUG_ON
     "signal",                      "",
 #endif
@@ -23,6 +23,7 @@ extern Suite* ist_suite();
 extern Suite* saved_state_suite();
 extern Suite* defaults_suite();
 extern Suite* progress_suite();
+extern Suite* monitor_suite();
 
 static suite_creator_t suites[] =
 {
@@ -36,6 +37,7 @@ static suite_creator_t suites[] =
     saved_state_suite,
     defaults_suite,
     progress_suite,
+    monitor_suite,
     0
 };
 
@@ -228,6 +228,8 @@ public:
     {
         return (last_left >= trx_.depends_seqno());
     }
+    int deps_count() const { return 0; }
+    wsrep_seqno_t dep(int) const { return WSREP_SEQNO_UNDEFINED; }
 #ifdef GU_DBUG_ON
     void debug_sync(gu::Mutex&) { }
 #endif // GU_DBUG_ON
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+/**
+ * This is to benchmark KeySetOut::append() on bulk transactions, which
+ * append many unique row keys, optionally mixed with duplicates.
+ *
+ * Keys are of the form (schema, table, row), rows of a write set are
+ * consecutive, so that schema and table are shared with the previous key,
+ * duplicates refer to random rows appended before.
+ *
+ * Usage: key_set_bench [option=value ...]
+ *
+ *   trxs=N      number of write sets                     (10)
+ *   keys=N      keys per write set                       (200000)
+ *   dups=P      fraction of duplicate keys               (0.0)
+ *   reserve=B   hint the expected number of keys (0|1)   (0)
+ *   batch=N     keys per append call, as passed by
+ *               wsrep append_key()                       (1)
+ *   format=F    key format: flat8, flat8a, flat16, flat16a,
+ *               tree8                                    (flat8)
+ *   arena=A     allocator arena: none, thp, hugetlb      (none)
+ */
+
+#include "key_set.hpp"
+#include "key_data.hpp"
+#include "write_set_ng.hpp" // WriteSetNG::MAX_VERSION
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using galera::KeySet;
+using galera::KeySetOut;
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options
+{
+    Options()
+        : trxs(10), keys(200000), dups(0.0), reserve(false), batch(1),
+          format(KeySet::FLAT8), format_name("flat8"),
+          arena(gu::Allocator::ARENA_NONE), arena_name("none")
+    {}
+
+    size_t          trxs;
+    size_t          keys;
+    double          dups;
+    bool            reserve;
+    size_t          batch;
+    KeySet::Version format;
+    std::string     format_name;
+    gu::Allocator::Arena arena;
+    std::string     arena_name;
+};
+
+template <typename T> static void
+read_value(const std::string& opt, const std::string& value, T& var)
+{
+    std::istringstream is(value);
+    if (!(is >> var) || !is.eof())
+    {
+        std::cerr << "Bad value for '" << opt << "': " << value << std::endl;
+        ::exit(EXIT_FAILURE);
+    }
+}
+
+static Options
+parse(int const argc, char* argv[])
+{
+    Options o;
+
+    for (int i(1); i < argc; ++i)
+    {
+        std::string const arg(argv[i]);
+        size_t const eq(arg.find('='));
+        std::string const opt(arg.substr(0, eq));
+        std::string const value(eq != std::string::npos ?
+                                arg.substr(eq + 1) : "");
+
+        if      (opt == "trxs")    read_value(opt, value, o.trxs);
+        else if (opt == "keys")    read_value(opt, value, o.keys);
+        else if (opt == "dups")    read_value(opt, value, o.dups);
+        else if (opt == "reserve") read_value(opt, value, o.reserve);
+        else if (opt == "batch")   read_value(opt, value, o.batch);
+        else if (opt == "format")
+        {
+            o.format      = KeySet::version(value);
+            o.format_name = value;
+        }
+        else if (opt == "arena")
+        {
+            o.arena      = gu::Allocator::arena(value);
+            o.arena_name = value;
+        }
+        else
+        {
+            std::cerr << "Unrecognized option: " << arg << std::endl;
+            ::exit(EXIT_FAILURE);
+        }
+    }
+
+    if (o.format == KeySet::EMPTY || o.keys == 0 || o.trxs == 0 ||
+        o.batch == 0 ||
+        o.dups < 0.0 || o.dups >= 1.0)
+    {
+        std::cerr << "Bad options" << std::endl;
+        ::exit(EXIT_FAILURE);
+    }
+
+    return o;
+}
+
+class BenchBaseName : public gu::Allocator::BaseName
+{
+public:
+    void print(std::ostream& os) const { os << "key_set_bench"; }
+};
+
+int main(int argc, char* argv[])
+{
+    Options const o(parse(argc, argv));
+
+    gu_mmh128_configure(); // select batch hashing implementation
+    gu::Allocator::arena(o.arena);
+
+    std::cout << "Running with parameters: trxs = " << o.trxs
+              << ", keys = " << o.keys << ", dups = " << o.dups
+              << ", reserve = " << o.reserve << ", batch = " << o.batch
+              << ", format = " << o.format_name
+              << ", arena = " << o.arena_name << std::endl;
+
+    int const ws_ver(galera::WriteSetNG::MAX_VERSION);
+    static const char schema[] = "schema";
+    static const char table[]  = "table";
+
+    /* row keys are precomputed to keep the generator off the path */
+    std::vector<uint64_t> rows(o.keys);
+    std::mt19937_64 rng(o.keys);
+    std::bernoulli_distribution dup(o.dups);
+    uint64_t next_row(0);
+    for (size_t i(0); i < o.keys; ++i)
+    {
+        rows[i] = (i > 0 && dup(rng)) ? rows[rng() % i] : next_row++;
+    }
+
+    std::vector<wsrep_buf_t> parts(3 * o.keys);
+    std::vector<galera::KeyData> kds;
+    kds.reserve(o.keys);
+    for (size_t i(0); i < o.keys; ++i)
+    {
+        wsrep_buf_t* const p(&parts[3 * i]);
+        p[0].ptr = schema;   p[0].len = sizeof(schema);
+        p[1].ptr = table;    p[1].len = sizeof(table);
+        p[2].ptr = &rows[i]; p[2].len = sizeof(rows[i]);
+        kds.push_back(galera::KeyData(ws_ver, p, 3, WSREP_KEY_EXCLUSIVE,
+                                      false));
+    }
+
+    BenchBaseName const base_name;
+    Clock::duration total(0);
+    size_t appended(0);
+    size_t size(0);
+
+    for (size_t t(0); t < o.trxs; ++t)
+    {
+        union { gu::byte_t buf[1 << 13]; gu_word_t align; } reserved;
+        KeySetOut kso(reserved.buf, sizeof(reserved.buf), base_name,
+                      o.format, gu::RecordSet::VER2, ws_ver);
+
+        Clock::time_point const start(Clock::now());
+
+        if (o.reserve) kso.reserve(o.keys);
+
+        if (1 == o.batch)
+        {
+            for (size_t i(0); i < o.keys; ++i) kso.append(kds[i]);
+        }
+        else
+        {
+            for (size_t i(0); i < o.keys; i += o.batch)
+            {
+                kso.append(&kds[i], std::min(o.batch, o.keys - i));
+            }
+        }
+
+        total += Clock::now() - start;
+        appended = kso.count();
+        size = kso.size();
+    }
+
+    double const ns(std::chrono::duration<double, std::nano>(total).count());
+
+    std::cout << "Key parts per write set: " << appended
+              << ", key set size: " << size << " bytes" << std::endl;
+    std::cout << "Append: " << ns / (o.trxs * o.keys) << " ns/key, "
+              << 1e9 * o.trxs * o.keys / ns << " keys/s" << std::endl;
+
+    return 0;
+}
@@ -1,4 +1,4 @@
-/* copyright (C) 2013-2024 Codership Oy <info@codership.com>
+/* copyright (C) 2013-2026 Codership Oy <info@codership.com>
  *
  * $Id$
  */
@@ -14,6 +14,8 @@
 
 #include <check.h>
 
+#include <sstream>
+
 using namespace galera;
 
 class TestBaseName : public gu::Allocator::BaseName
@@ -420,6 +422,13 @@ START_TEST (ver2_5)
 }
 END_TEST
 
+START_TEST (ver3_5)
+{
+    gu_crc32c_configure(); // select CRC-32C implementation
+    test_ver(gu::RecordSet::VER3, 5);
+}
+END_TEST
+
 struct KsoFixture
 {
     union Res
@@ -816,6 +825,254 @@ START_TEST(kso_append_exclusive_leaf_over_branch)
 }
 END_TEST
 
+static std::vector<gu::byte_t> gather_keys(KeySetOut& kso)
+{
+    KeySetOut::GatherVector out;
+    out->reserve(kso.page_count());
+    size_t const out_size(kso.gather(out));
+
+    std::vector<gu::byte_t> in;
+    in.reserve(out_size);
+    for (size_t i(0); i < out->size(); ++i)
+    {
+        const gu::byte_t* ptr(static_cast<const gu::byte_t*>(out[i].ptr));
+        in.insert (in.end(), ptr, ptr + out[i].size);
+    }
+
+    return in;
+}
+
+START_TEST(tree8)
+{
+    static std::vector<const char*> const keys[] =
+    {
+        { "db", "t1", "r1" },
+        { "db", "t1", "r2" },
+        { "db", "t2", "r1" },
+        { "db", "t1", "r3" }, // t1 is not shared with the previous key
+        { "db", "t1", "r3" }, // full duplicate
+        { "db", "t2", "r1" }, // only t2 is stored, r1 is a duplicate
+        { "db", "t2", "r4" }  // r4 must become a child of the t2 above
+    };
+    /* expected full keys of the stored key parts, in order */
+    static const char* const paths[] =
+    {
+        "db", "db/t1", "db/t1/r1", "db/t1/r2", "db/t2", "db/t2/r1",
+        "db/t1", "db/t1/r3", "db/t2", "db/t2/r4"
+    };
+    int const paths_num(sizeof(paths)/sizeof(paths[0]));
+
+    union { gu::byte_t buf[1024]; gu_word_t align; } tres, fres;
+    TestBaseName const str("tree8_test");
+    KeySetOut tree(tres.buf, sizeof(tres.buf), str, KeySet::TREE8,
+                   gu::RecordSet::VER2, WriteSetNG::MAX_VERSION);
+    KeySetOut flat(fres.buf, sizeof(fres.buf), str, KeySet::FLAT8A,
+                   gu::RecordSet::VER2, WriteSetNG::MAX_VERSION);
+
+    for (size_t i(0); i < sizeof(keys)/sizeof(keys[0]); ++i)
+    {
+        TestKey tk(KeySet::TREE8, WSREP_KEY_EXCLUSIVE, keys[i]);
+        tree.append(tk());
+        flat.append(tk());
+    }
+
+    ck_assert_int_eq(tree.count(), paths_num);
+
+    std::vector<gu::byte_t> const tin(gather_keys(tree));
+    std::vector<gu::byte_t> const fin(gather_keys(flat));
+
+    KeySetIn ksi(tree.version(), tin.data(), tin.size());
+    KeySetIn fsi(flat.version(), fin.data(), fin.size());
+    ksi.checksum();
+
+    for (int n(0); n < 2; ++n) // second pass checks rewind()
+    {
+        for (int i(0); i < ksi.count(); ++i)
+        {
+            KeySet::KeyPart const kp(ksi.next());
+            ck_assert(KeySet::TREE8 == kp.version());
+            ck_assert_int_eq(kp.depth() + 1, ksi.path_size());
+            /* branches stored again only to parent the following parts */
+            ck_assert(kp.repeat() == (6 == i || 8 == i));
+
+            std::string path;
+            for (int d(0); d < ksi.path_size(); ++d)
+            {
+                if (d > 0) path += '/';
+                wsrep_buf_t const v(ksi.path(d).value());
+                const char* const ptr(static_cast<const char*>(v.ptr));
+                /* TestKey parts include the terminating '\0' */
+                ck_assert(v.len > 0 && '\0' == ptr[v.len - 1]);
+                path.append(ptr, v.len - 1);
+            }
+            ck_assert_msg(path == paths[i], "Part %d: expected '%s', got '%s'",
+                          i, paths[i], path.c_str());
+        }
+        ksi.rewind();
+    }
+
+    /* key parts must match across formats: the first three are the same */
+    for (int i(0); i < 3; ++i)
+    {
+        KeySet::KeyPart const tkp(ksi.next());
+        KeySet::KeyPart const fkp(fsi.next());
+        ck_assert(tkp.matches(fkp));
+        ck_assert(fkp.matches(tkp));
+    }
+    ksi.rewind();
+    KeySet::KeyPart const db(ksi.next());
+    KeySet::KeyPart const t1(ksi.next());
+    ck_assert(!db.matches(t1));
+    ck_assert(db.matches(db));
+}
+END_TEST
+
+START_TEST(tree8_size)
+{
+    union { gu::byte_t buf[1024]; gu_word_t align; } tres, fres;
+    TestBaseName const str("tree8_size");
+    KeySetOut tree(tres.buf, sizeof(tres.buf), str, KeySet::TREE8,
+                   gu::RecordSet::VER2, WriteSetNG::MAX_VERSION);
+    KeySetOut flat(fres.buf, sizeof(fres.buf), str, KeySet::FLAT8A,
+                   gu::RecordSet::VER2, WriteSetNG::MAX_VERSION);
+
+    /* a typical multi-row transaction: many rows of the same table */
+    for (int i(0); i < 64; ++i)
+    {
+        std::ostringstream row;
+        row << "row" << i;
+        std::string const r(row.str());
+        TestKey tk(KeySet::TREE8, WSREP_KEY_EXCLUSIVE,
+                   { "database", "some_table", r.c_str() });
+        tree.append(tk());
+        flat.append(tk());
+    }
+
+    ck_assert_int_eq(tree.count(), flat.count());
+    ck_assert_msg(tree.size() < flat.size(),
+                  "TREE8 size %zu, FLAT8A size %zu", tree.size(), flat.size());
+}
+END_TEST
+
+static void test_many_keys(bool const reserve)
+{
+    union { gu::byte_t buf[1024]; gu_word_t align; } res;
+    TestBaseName const str("many_keys");
+    KeySetOut kso(res.buf, sizeof(res.buf), str, KeySet::FLAT8,
+                  gu::RecordSet::VER2, WriteSetNG::MAX_VERSION);
+
+    int const rows(20000);
+
+    if (reserve) kso.reserve(rows + 1);
+
+    /* enough keys to overflow the preallocated set many times over */
+    for (int n(0); n < 2; ++n)
+    {
+        for (int i(0); i < rows; ++i)
+        {
+            /* second pass appends the same keys in reverse order */
+            int const row(n ? rows - 1 - i : i);
+            wsrep_buf_t const parts[2] =
+            {
+                { "table", 6 },
+                { &row, sizeof(row) }
+            };
+            KeyData const kd(WriteSetNG::MAX_VERSION, parts, 2,
+                             WSREP_KEY_EXCLUSIVE, true);
+            kso.append(kd);
+        }
+
+        ck_assert_int_eq(kso.count(), rows + 1);
+    }
+
+    std::vector<gu::byte_t> const in(gather_keys(kso));
+    KeySetIn ksi(kso.version(), in.data(), in.size());
+    ck_assert_int_eq(ksi.count(), rows + 1);
+    ksi.checksum();
+}
+
+START_TEST(many_keys)
+{
+    test_many_keys(false);
+}
+END_TEST
+
+START_TEST(many_keys_reserve)
+{
+    test_many_keys(true);
+}
+END_TEST
+
+/* Batch append must produce exactly the same key set as one by one */
+START_TEST(batch_append)
+{
+    gu_mmh128_configure(); // use SIMD batch hashing if available
+
+    int const ws_ver(WriteSetNG::MAX_VERSION);
+    static const char* const tables[] = { "t1", "t2" };
+    static wsrep_key_type_t const types[] =
+        { WSREP_KEY_SHARED, WSREP_KEY_SHARED, WSREP_KEY_EXCLUSIVE };
+
+    /* runs of sibling rows in alternating tables, with duplicate rows and
+     * stronger duplicates of them, and a few keys of other lengths */
+    int const n(200);
+    std::vector<int>         rows(n);
+    std::vector<wsrep_buf_t> parts(3 * n);
+    std::vector<KeyData>     kds;
+
+    for (int i(0); i < n; ++i)
+    {
+        rows[i] = (i % 5 == 4) ? rows[i - 3] : i;
+        parts[3*i + 0].ptr = "schema"; parts[3*i + 0].len = 7;
+        parts[3*i + 1].ptr = tables[(i / 40) % 2]; parts[3*i + 1].len = 3;
+        parts[3*i + 2].ptr = &rows[i]; parts[3*i + 2].len = sizeof(rows[i]);
+        int const parts_num((i % 37 == 36) ? 1 + (i % 2) : 3);
+        kds.push_back(KeyData(ws_ver, &parts[3*i], parts_num,
+                              types[i % 3], false));
+    }
+
+    for (int v(KeySet::FLAT8); v <= KeySet::MAX_VERSION; ++v)
+    {
+        /* 1: one by one, 7: crossing batch boundaries, n: all at once */
+        size_t const chunks[] = { 1, 7, size_t(n) };
+
+        std::vector<gu::byte_t> exp;
+        size_t exp_total(0);
+
+        for (size_t c(0); c < sizeof(chunks)/sizeof(chunks[0]); ++c)
+        {
+            union { gu::byte_t buf[1024]; gu_word_t align; } res;
+            TestBaseName const str("batch_append");
+            KeySetOut kso(res.buf, sizeof(res.buf), str, KeySet::Version(v),
+                          gu::RecordSet::VER2, ws_ver);
+            size_t total(0);
+
+            for (size_t k(0); k < kds.size(); k += chunks[c])
+            {
+                size_t const m(std::min(chunks[c], kds.size() - k));
+                total += (1 == chunks[c] ?
+                          kso.append(kds[k]) : kso.append(&kds[k], m));
+            }
+
+            std::vector<gu::byte_t> const got(gather_keys(kso));
+
+            if (0 == c)
+            {
+                exp = got;
+                exp_total = total;
+            }
+            else
+            {
+                ck_assert_msg(exp == got,
+                              "Version %d: key set differs with chunk %zu",
+                              v, chunks[c]);
+                ck_assert_int_eq(exp_total, total);
+            }
+        }
+    }
+}
+END_TEST
+
 Suite* key_set_suite ()
 {
     TCase* t = tcase_create ("KeySet");
@@ -825,6 +1082,12 @@ Suite* key_set_suite ()
     tcase_add_test (t, ver2_3);
     tcase_add_test (t, ver2_4);
     tcase_add_test (t, ver2_5);
+    tcase_add_test (t, ver3_5);
+    tcase_add_test (t, tree8);
+    tcase_add_test (t, tree8_size);
+    tcase_add_test (t, many_keys);
+    tcase_add_test (t, many_keys_reserve);
+    tcase_add_test (t, batch_append);
     tcase_set_timeout(t, 60);
 
 
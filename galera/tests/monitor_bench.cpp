@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+/**
+ * This is to benchmark galera::Monitor enter()/leave() throughput with
+ * many concurrent threads, like appliers going through apply and commit
+ * monitors. Threads pick up consecutive seqnos, enter the monitor, spin
+ * for a given time to emulate work and leave.
+ *
+ * Usage: monitor_bench [apply|commit] [threads] [seqnos] [window] [work ns]
+ *
+ * apply  - seqno may enter when its dependency has left, dependencies are
+ *          random within the last 'threads' seqnos
+ * commit - strictly ordered, seqno may enter when the previous has left
+ */
+
+#include "monitor.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+class Order
+{
+public:
+
+    Order(wsrep_seqno_t const seqno, wsrep_seqno_t const depends)
+        : seqno_(seqno), depends_(depends),
+          cond_(gu::get_cond_key(gu::GU_COND_KEY_APPLY_MONITOR))
+    {}
+
+    Order(const Order& o)
+        : seqno_(o.seqno_), depends_(o.depends_),
+          cond_(gu::get_cond_key(gu::GU_COND_KEY_APPLY_MONITOR))
+    {}
+
+    Order() : seqno_(0), depends_(0),
+              cond_(gu::get_cond_key(gu::GU_COND_KEY_APPLY_MONITOR))
+    {}
+
+    wsrep_seqno_t seqno() const { return seqno_; }
+    gu::Cond*     cond()        { return &cond_; }
+
+    bool condition(wsrep_seqno_t, wsrep_seqno_t const last_left) const
+    {
+        return (last_left >= depends_);
+    }
+
+    int           deps_count() const { return 0; }
+    wsrep_seqno_t dep(int)     const { return WSREP_SEQNO_UNDEFINED; }
+
+#ifdef GU_DBUG_ON
+    void debug_sync(gu::Mutex&) {}
+#endif // GU_DBUG_ON
+
+private:
+
+    Order& operator=(const Order&);
+
+    wsrep_seqno_t seqno_;
+    wsrep_seqno_t depends_;
+    gu::Cond      cond_;
+};
+
+static void
+work(long long const ns)
+{
+    long long const start(gu_time_monotonic());
+    while (gu_time_monotonic() - start < ns) {}
+}
+
+template <typename T> void
+read_arg(char* argv[], int position, T& var)
+{
+    std::string arg(argv[position]);
+    std::istringstream is(arg);
+    is >> var;
+}
+
+int main(int argc, char* argv[])
+{
+    static const char* const APPLY  = "apply";
+    static const char* const COMMIT = "commit";
+
+    std::string mode(APPLY);
+    int       threads(32);
+    long      seqnos(1 << 20);
+    size_t    window(galera::Monitor<Order>::DEFAULT_SIZE);
+    long long work_ns(1000);
+
+    if (argc >= 2) read_arg(argv, 1, mode);
+    if (argc >= 3) read_arg(argv, 2, threads);
+    if (argc >= 4) read_arg(argv, 3, seqnos);
+    if (argc >= 5) read_arg(argv, 4, window);
+    if (argc >= 6) read_arg(argv, 5, work_ns);
+
+    if (mode != APPLY && mode != COMMIT)
+    {
+        std::cerr << "First option should be either '" << APPLY << "' or '"
+                  << COMMIT << "'" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Running with parameters: mode = " << mode
+              << ", threads = " << threads << ", seqnos = " << seqnos
+              << ", window = " << window << ", work = " << work_ns << " ns"
+              << std::endl;
+
+    galera::Monitor<Order> mon(gu::GU_MUTEX_KEY_APPLY_MONITOR,
+                               gu::GU_COND_KEY_APPLY_MONITOR, window);
+    mon.set_initial_position(WSREP_UUID_UNDEFINED, 0);
+
+    /* dependencies are precomputed to keep the generator off the path */
+    std::vector<wsrep_seqno_t> depends(seqnos + 1);
+    std::mt19937_64 rng(seqnos);
+    for (long s(1); s <= seqnos; ++s)
+    {
+        depends[s] = (mode == COMMIT ? s - 1 :
+                      std::max<long>(0, s - 1 - rng() % threads));
+    }
+
+    std::atomic<long> next(1);
+    std::vector<std::thread> pool;
+
+    long long const start(gu_time_monotonic());
+
+    for (int t(0); t < threads; ++t)
+    {
+        pool.push_back(std::thread([&]()
+        {
+            long s;
+            while ((s = next++) <= seqnos)
+            {
+                Order o(s, depends[s]);
+                mon.enter(o);
+                work(work_ns);
+                mon.leave(o);
+            }
+        }));
+    }
+
+    for (size_t t(0); t < pool.size(); ++t) pool[t].join();
+
+    double const secs((gu_time_monotonic() - start) * 1.0e-9);
+
+    double oooe, oool, win;
+    long long waits;
+    mon.get_stats(&oooe, &oool, &win, &waits);
+
+    std::cout << "================" << std::endl;
+    std::cout << "seqnos/s:\t"  << seqnos / secs << std::endl;
+    std::cout << "waits:\t\t"   << waits << std::endl;
+    std::cout << "window:\t\t"  << win << std::endl;
+    std::cout << "wait hist:\t" << mon.wait_histogram() << std::endl;
+    std::cout << "----------------" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+#include "../src/monitor.hpp"
+
+#include <check.h>
+
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+    class Order
+    {
+    public:
+
+        explicit Order(wsrep_seqno_t const seqno)
+            : seqno_(seqno),
+              cond_(gu::get_cond_key(gu::GU_COND_KEY_COMMIT_MONITOR))
+        {}
+
+        Order(const Order& o)
+            : seqno_(o.seqno_),
+              cond_(gu::get_cond_key(gu::GU_COND_KEY_COMMIT_MONITOR))
+        {}
+
+        Order() : seqno_(0),
+                  cond_(gu::get_cond_key(gu::GU_COND_KEY_COMMIT_MONITOR))
+        {}
+
+        wsrep_seqno_t seqno() const { return seqno_; }
+        gu::Cond*     cond()        { return &cond_; }
+
+        bool condition(wsrep_seqno_t, wsrep_seqno_t const last_left) const
+        {
+            return (last_left + 1 == seqno_);
+        }
+
+        int           deps_count() const { return 0; }
+        wsrep_seqno_t dep(int)     const { return WSREP_SEQNO_UNDEFINED; }
+
+#ifdef GU_DBUG_ON
+        void debug_sync(gu::Mutex&) {}
+#endif // GU_DBUG_ON
+
+    private:
+
+        Order& operator=(const Order&);
+
+        wsrep_seqno_t seqno_;
+        gu::Cond      cond_;
+    };
+
+    typedef galera::Monitor<Order> Monitor;
+
+    /* enters the monitor, returns the error if canceled */
+    void enter(Monitor& mon, Order& o, int& err)
+    {
+        try
+        {
+            mon.enter(o);
+            err = 0;
+        }
+        catch (gu::Exception& e)
+        {
+            err = e.get_errno();
+        }
+    }
+}
+
+/* The waiter is interrupted while it spins with the monitor mutex
+ * released. It must notice the cancellation instead of parking for good:
+ * interrupt() does not signal a waiter which is not parked yet. */
+START_TEST(monitor_interrupt_spinning)
+{
+    Monitor mon(gu::GU_MUTEX_KEY_COMMIT_MONITOR,
+                gu::GU_COND_KEY_COMMIT_MONITOR, Monitor::MIN_SIZE);
+    mon.set_initial_position(WSREP_UUID_UNDEFINED, 0);
+    mon.force_spin(50000000); // 50ms
+
+    Order o1(1);
+    mon.enter(o1);
+
+    Order o2(2);
+    int err(-1);
+    std::thread waiter(enter, std::ref(mon), std::ref(o2), std::ref(err));
+
+    usleep(5000);
+    ck_assert(mon.interrupt(o2));
+    waiter.join();
+    ck_assert_int_eq(err, EINTR);
+
+    mon.leave(o1);
+    mon.self_cancel(o2);
+    ck_assert_int_eq(mon.last_left(), 2);
+}
+END_TEST
+
+/* The previous seqno leaves while the waiter spins. Short spins make it
+ * likely that some leave() calls land between the last check of the spin
+ * and locking the mutex again, where the waiter is made to enter without
+ * being signaled. */
+START_TEST(monitor_leave_spinning)
+{
+    Monitor mon(gu::GU_MUTEX_KEY_COMMIT_MONITOR,
+                gu::GU_COND_KEY_COMMIT_MONITOR, Monitor::MIN_SIZE);
+    mon.set_initial_position(WSREP_UUID_UNDEFINED, 0);
+
+    for (wsrep_seqno_t s(1); s <= 2000; s += 2)
+    {
+        mon.force_spin(s % 4 == 1 ? 1 : 20000);
+
+        Order o1(s);
+        mon.enter(o1);
+
+        Order o2(s + 1);
+        int err(-1);
+        std::thread waiter(enter, std::ref(mon), std::ref(o2),
+                           std::ref(err));
+
+        mon.leave(o1);
+        waiter.join();
+        ck_assert_int_eq(err, 0);
+        mon.leave(o2);
+    }
+
+    ck_assert_int_eq(mon.last_left(), 2000);
+}
+END_TEST
+
+Suite* monitor_suite()
+{
+    Suite* s = suite_create("monitor");
+    TCase* t = tcase_create("monitor");
+    tcase_add_test(t, monitor_interrupt_spinning);
+    tcase_add_test(t, monitor_leave_spinning);
+    suite_add_tcase(s, t);
+    return s;
+}
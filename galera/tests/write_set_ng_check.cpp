@@ -1,4 +1,4 @@
-/* Copyright (C) 2013-2024 Codership Oy <info@codership.com>
+/* Copyright (C) 2013-2026 Codership Oy <info@codership.com>
  *
  * $Id$
  */
@@ -298,6 +298,13 @@ START_TEST (ver3_basic_rsv2_wsv4)
 }
 END_TEST
 
+START_TEST (ver3_basic_rsv3_wsv4)
+{
+    gu_crc32c_configure(); // select CRC-32C implementation
+    ver3_basic(gu::RecordSet::VER3, WriteSetNG::VER4);
+}
+END_TEST
+
 static void ver3_annotation(gu::RecordSet::Version const rsv)
 {
     int const alignment(rsv >= gu::RecordSet::VER2 ? GU_MIN_ALIGNMENT : 1);
@@ -393,6 +400,140 @@ START_TEST (ver3_annotation_rsv2)
 }
 END_TEST
 
+START_TEST (ver6_compressed)
+{
+    wsrep_uuid_t source;
+    gu_uuid_generate (reinterpret_cast<gu_uuid_t*>(&source), NULL, 0);
+
+    std::string const dir(".");
+    WriteSetOut wso (dir, 1, KeySet::FLAT16, 0, 0, 0, gu::RecordSet::VER2,
+                     WriteSetNG::VER6, DataSet::VER2, DataSet::VER2,
+                     WriteSetNG::MAX_SIZE, 256 /* compression threshold */);
+
+    TestKey tk0(KeySet::MAX_VERSION, WSREP_KEY_EXCLUSIVE, true, "key0");
+    wso.append_key(tk0());
+
+    std::string data;
+    for (int i(0); i < 100; ++i) data += "INSERT INTO t VALUES (1, 'abc');";
+    std::string const unrd("short unordered");
+    std::string const annotation("annotation");
+
+    wso.append_data (data.data(), data.size(), false);
+    wso.append_unordered (unrd.data(), unrd.size(), true);
+    wso.append_annotation (annotation.data(), annotation.size(), true);
+
+    WriteSetNG::GatherVector out;
+    size_t const out_size(wso.gather(source, 1, 1, out));
+    ck_assert_msg(out_size < data.size(), "out size %zu, data size %zu",
+                  out_size, data.size());
+    wso.finalize(1, 0);
+
+    std::vector<gu::byte_t> in;
+    for (size_t i(0); i < out->size(); ++i)
+    {
+        const gu::byte_t* ptr(static_cast<const gu::byte_t*>(out[i].ptr));
+        in.insert (in.end(), ptr, ptr + out[i].size);
+    }
+    ck_assert(in.size() == out_size);
+
+    gu::Buf const in_buf = { in.data(), static_cast<ssize_t>(in.size()) };
+    WriteSetIn wsi(in_buf);
+    wsi.verify_checksum();
+
+    const DataSetIn& dsi(wsi.dataset());
+    ck_assert(dsi.count() == 1);
+    gu::Buf const d(dsi.next());
+    ck_assert(size_t(d.size) == data.size());
+    ck_assert(0 == ::memcmp(d.ptr, data.data(), data.size()));
+
+    /* below threshold, not compressed */
+    const DataSetIn& usi(wsi.unrdset());
+    ck_assert(usi.count() == 1);
+    gu::Buf const u(usi.next());
+    ck_assert(size_t(u.size) == unrd.size());
+    ck_assert(0 == ::memcmp(u.ptr, unrd.data(), unrd.size()));
+
+    std::ostringstream os;
+    wsi.write_annotation(os);
+    ck_assert(os.str() == annotation);
+
+    /* compressed sets should be forwarded as received */
+    WriteSetIn::GatherVector fwd;
+    ck_assert(wsi.gather(fwd, true, false) <= in.size());
+}
+END_TEST
+
+START_TEST (ver6_checksum_pool)
+{
+    wsrep_uuid_t source;
+    gu_uuid_generate (reinterpret_cast<gu_uuid_t*>(&source), NULL, 0);
+
+    std::string const dir(".");
+    WriteSetOut wso (dir, 1, KeySet::FLAT16, 0, 0, 0, gu::RecordSet::VER2,
+                     WriteSetNG::VER6);
+
+    TestKey tk0(KeySet::MAX_VERSION, WSREP_KEY_EXCLUSIVE, true, "key0");
+    wso.append_key(tk0());
+
+    std::vector<gu::byte_t> data(1 << 16);
+    for (size_t i(0); i < data.size(); ++i) data[i] = i;
+    wso.append_data (data.data(), data.size(), false);
+    wso.append_unordered (data.data(), data.size() / 2, false);
+
+    WriteSetNG::GatherVector out;
+    wso.gather(source, 1, 1, out);
+    wso.finalize(1, 0);
+
+    std::vector<gu::byte_t> in;
+    for (size_t i(0); i < out->size(); ++i)
+    {
+        const gu::byte_t* ptr(static_cast<const gu::byte_t*>(out[i].ptr));
+        in.insert (in.end(), ptr, ptr + out[i].size);
+    }
+
+    gu::Buf const in_buf = { in.data(), static_cast<ssize_t>(in.size()) };
+
+    {
+        ChecksumPool::Ref const pool(2);
+
+        /* threshold of 1 makes every writeset go to the pool */
+        WriteSetIn wsi(in_buf, 1);
+        wsi.verify_checksum();
+        ck_assert(wsi.dataset().count() == 1);
+        ck_assert(wsi.unrdset().count() == 1);
+
+        /* corrupt the data set payload */
+        in[in.size() - data.size()] ^= 0xff;
+
+        WriteSetIn bad(in_buf, 1);
+        try
+        {
+            bad.verify_checksum();
+            ck_abort_msg("Corruption not detected in background");
+        }
+        catch (gu::Exception& e)
+        {
+            ck_assert(e.get_errno() == EINVAL);
+        }
+
+        /* destructor must wait for pending jobs */
+        WriteSetIn unchecked(in_buf, 1);
+    }
+
+    /* without the pool the check happens in foreground */
+    try
+    {
+        WriteSetIn bad(in_buf, 1);
+        bad.verify_checksum();
+        ck_abort_msg("Corruption not detected in foreground");
+    }
+    catch (gu::Exception& e)
+    {
+        ck_assert(e.get_errno() == EINVAL);
+    }
+}
+END_TEST
+
 Suite* write_set_ng_suite ()
 {
     Suite* s = suite_create ("WriteSet");
@@ -403,6 +544,7 @@ Suite* write_set_ng_suite ()
 #endif
     tcase_add_test (t, ver3_basic_rsv2_wsv3);
     tcase_add_test (t, ver3_basic_rsv2_wsv4);
+    tcase_add_test (t, ver3_basic_rsv3_wsv4);
     tcase_set_timeout(t, 60);
     suite_add_tcase (s, t);
 
@@ -414,5 +556,13 @@ Suite* write_set_ng_suite ()
     tcase_set_timeout(t, 60);
     suite_add_tcase (s, t);
 
+    t = tcase_create ("WriteSet checksum pool");
+    tcase_add_test (t, ver6_checksum_pool);
+    suite_add_tcase (s, t);
+
+    t = tcase_create ("WriteSet compression");
+    tcase_add_test (t, ver6_compressed);
+    suite_add_tcase (s, t);
+
     return s;
 }
@@ -10,16 +10,231 @@
 #include "gu_assert.hpp"
 #include "gu_arch.h"
 #include "gu_limits.h"
+#include "gu_time.h"
 
+#include <atomic>
 #include <sstream>
+#include <algorithm> // std::transform()
+#include <cctype>    // toupper()
 #include <iomanip> // for std::setfill() and std::setw()
+#include <pthread.h>
+#include <sys/mman.h>
 
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
 
-gu::Allocator::HeapPage::HeapPage (page_size_type const size) :
-    Page (static_cast<byte_t*>(::malloc(size)), size)
+namespace
 {
+    /* Per-thread free list of released arena heap pages. Pages are matched
+     * by exact size: with geometric page growth there are only a few size
+     * classes, so the same sizes are asked for by consecutive trxs.
+     * Memory kept by all threads together is capped, so that many mostly
+     * idle connection threads can't pin much of it, and pages which have
+     * not been reused for a while are released on the next put(). */
+    class PageCache
+    {
+    public:
+
+        static size_t    const MAX_PAGES = 16;
+        static size_t    const MAX_BYTES = 2 * gu::Allocator::HUGE_PAGE_SIZE;
+        static size_t    const TOTAL_MAX_BYTES =
+            32 * gu::Allocator::HUGE_PAGE_SIZE;
+        static long long const MAX_IDLE = 1000000000LL; // 1s
+
+        PageCache() : n_(0), bytes_(0) {}
+
+        ~PageCache()
+        {
+            for (size_t i(0); i < n_; ++i) release(pages_[i]);
+            total_ -= bytes_;
+        }
+
+        void* get(size_t const size, bool& mapped)
+        {
+            for (size_t i(n_); i > 0; --i) // LIFO: most recent is hot
+            {
+                if (pages_[i - 1].size == size)
+                {
+                    Entry const e(pages_[i - 1]);
+                    pages_[i - 1] = pages_[--n_];
+                    bytes_ -= size;
+                    total_ -= size;
+                    mapped  = e.mapped;
+                    return e.ptr;
+                }
+            }
+
+            return NULL;
+        }
+
+        bool put(void* const ptr, size_t const size, bool const mapped)
+        {
+            long long const now(gu_time_monotonic());
+
+            trim(now);
+
+            if (n_ < MAX_PAGES && bytes_ + size <= MAX_BYTES)
+            {
+                if (total_.fetch_add(size) + size > TOTAL_MAX_BYTES)
+                {
+                    total_ -= size;
+                    return false;
+                }
+
+                Entry const e = { ptr, size, mapped, now };
+                pages_[n_++] = e;
+                bytes_ += size;
+                return true;
+            }
+
+            return false;
+        }
+
+        /* total size of pages kept by all threads */
+        static size_t total() { return total_; }
+
+        static void release(void* const ptr, size_t const size,
+                            bool const mapped)
+        {
+            if (mapped) ::munmap(ptr, size); else ::free(ptr);
+        }
+
+        /* returns free list of the calling thread, creates if necessary */
+        static PageCache* local(bool create)
+        {
+            pthread_once(&key_once_, key_create);
+
+            PageCache* ret(static_cast<PageCache*>(pthread_getspecific(key_)));
+
+            if (NULL == ret && create)
+            {
+                ret = new PageCache;
+                if (pthread_setspecific(key_, ret))
+                {
+                    delete ret;
+                    ret = NULL;
+                }
+            }
+
+            return ret;
+        }
+
+    private:
+
+        struct Entry
+        {
+            void*     ptr;
+            size_t    size;
+            bool      mapped;
+            long long time; // when released to the cache
+        };
+
+        Entry  pages_[MAX_PAGES];
+        size_t n_;
+        size_t bytes_;
+
+        static std::atomic<size_t> total_;
+
+        static void release(const Entry& e) { release(e.ptr, e.size, e.mapped); }
+
+        /* releases pages which have been idle for more than MAX_IDLE */
+        void trim(long long const now)
+        {
+            for (size_t i(n_); i > 0; --i)
+            {
+                if (now - pages_[i - 1].time > MAX_IDLE)
+                {
+                    Entry const e(pages_[i - 1]);
+                    pages_[i - 1] = pages_[--n_];
+                    bytes_ -= e.size;
+                    total_ -= e.size;
+                    release(e);
+                }
+            }
+        }
+
+        static void key_destroy(void* c) { delete static_cast<PageCache*>(c); }
+        static void key_create() { pthread_key_create(&key_, key_destroy); }
+
+        static pthread_key_t  key_;
+        static pthread_once_t key_once_;
+    };
+
+    std::atomic<size_t> PageCache::total_(0);
+    pthread_key_t  PageCache::key_;
+    pthread_once_t PageCache::key_once_ = PTHREAD_ONCE_INIT;
+
+    void* huge_page_alloc(size_t const size, gu::Allocator::Arena const arena,
+                          bool& mapped)
+    {
+        void* ret(NULL);
+#if defined(MAP_HUGETLB)
+        if (gu::Allocator::ARENA_HUGETLB == arena)
+        {
+            ret = ::mmap(NULL, size, PROT_READ|PROT_WRITE,
+                         MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+            if (MAP_FAILED != ret)
+            {
+                mapped = true;
+                return ret;
+            }
+
+            ret = NULL; // hugetlb pool exhausted or not configured, use THP
+        }
+#endif /* MAP_HUGETLB */
+        if (::posix_memalign(&ret, gu::Allocator::HUGE_PAGE_SIZE, size))
+        {
+            return NULL;
+        }
+#if defined(MADV_HUGEPAGE)
+        (void)::madvise(ret, size, MADV_HUGEPAGE); // best effort
+#endif /* MADV_HUGEPAGE */
+        return ret;
+    }
+}
+
+gu::Allocator::HeapPage::HeapPage (page_size_type const size,
+                                   Arena          const arena) :
+    Page    (NULL, size),
+    size_   (size),
+    mapped_ (false),
+    cached_ (ARENA_NONE != arena)
+{
+    if (cached_)
+    {
+        PageCache* const cache(PageCache::local(false));
+        if (cache) base_ptr_ = static_cast<byte_t*>(cache->get(size,mapped_));
+
+        if (NULL == base_ptr_ && 0 == size % HUGE_PAGE_SIZE)
+        {
+            base_ptr_ = static_cast<byte_t*>
+                (huge_page_alloc(size, arena, mapped_));
+        }
+    }
+
+    if (NULL == base_ptr_) base_ptr_ = static_cast<byte_t*>(::malloc(size));
+
     assert(0 == (uintptr_t(base_ptr_) % GU_WORD_BYTES));
     if (0 == base_ptr_) gu_throw_error (ENOMEM);
+    ptr_ = base_ptr_;
+}
+
+size_t
+gu::Allocator::cached_size()
+{
+    return PageCache::total();
+}
+
+gu::Allocator::HeapPage::~HeapPage ()
+{
+    if (cached_)
+    {
+        PageCache* const cache(PageCache::local(true));
+        if (cache && cache->put(base_ptr_, size_, mapped_)) return;
+    }
+
+    PageCache::release(base_ptr_, size_, mapped_);
 }
 
 
@@ -31,14 +246,39 @@ gu::Allocator::HeapStore::my_new_page (page_size_type const size)
         /* to avoid too frequent allocation, make it (at least) 64K */
         static page_size_type const PAGE_SIZE(gu_page_size_multiple(1 << 16));
 
-        page_size_type const page_size
-            (std::min(std::max(size, PAGE_SIZE), left_));
+        Arena const a(arena());
+        page_size_type page_size(std::max(size, PAGE_SIZE));
+
+        if (ARENA_NONE != a)
+        {
+            /* grow pages geometrically up to huge page size and keep bigger
+             * ones huge page multiples, so that big trxs are made of few
+             * huge pages and page sizes repeat from trx to trx */
+            page_size_type grow(PAGE_SIZE);
+            for (unsigned int i(0); i < n_ && grow < HUGE_PAGE_SIZE; ++i)
+            {
+                grow <<= 1;
+            }
+
+            page_size = std::max(size, grow);
+
+            if (page_size > HUGE_PAGE_SIZE)
+            {
+                page_size = (page_size / HUGE_PAGE_SIZE +
+                             (page_size % HUGE_PAGE_SIZE != 0))
+                    * HUGE_PAGE_SIZE;
+                if (page_size < size) page_size = size; // overflow
+            }
+        }
+
+        page_size = std::min(page_size, left_);
 
-        Page* ret = new HeapPage (page_size);
+        Page* ret = new HeapPage (page_size, a);
 
         assert (ret != 0);
 
         left_ -= page_size;
+        ++n_;
 
         return ret;
     }
@@ -48,11 +288,12 @@ gu::Allocator::HeapStore::my_new_page (page_size_type const size)
 
 
 gu::Allocator::FilePage::FilePage (const std::string& name,
-                                   page_size_type const size)
+                                   page_size_type const size,
+                                   bool const           prefault)
     :
     Page (0, 0),
-    fd_  (name, size, false, false),
-    mmap_(fd_, true)
+    fd_  (name, size, prefault, false),
+    mmap_(fd_, true, prefault)
 {
     base_ptr_ = static_cast<byte_t*>(mmap_.ptr);
     assert(0 == (uintptr_t(base_ptr_) % GU_WORD_BYTES));
@@ -72,7 +313,8 @@ gu::Allocator::FileStore::my_new_page (page_size_type const size)
         fname << base_name_
               << '.' << std::dec << std::setfill('0') << std::setw(6) << n_;
 
-        ret = new FilePage(fname.str(), std::max(size, page_size_));
+        ret = new FilePage(fname.str(), std::max(size, page_size_),
+                           ARENA_NONE != arena());
 
         assert (ret != 0);
 
@@ -169,6 +411,25 @@ gu::Allocator::alloc (page_size_type const size, bool& new_page)
 
 gu::Allocator::BaseNameDefault const gu::Allocator::BASE_NAME_DEFAULT;
 
+gu::Atomic<int> gu::Allocator::arena_(gu::Allocator::ARENA_NONE);
+
+static const char* arena_str[] = { "NONE", "THP", "HUGETLB" };
+
+gu::Allocator::Arena
+gu::Allocator::arena (const std::string& str)
+{
+    std::string tmp(str);
+    std::transform(tmp.begin(), tmp.end(), tmp.begin(), ::toupper);
+
+    for (int i(ARENA_NONE); i <= ARENA_HUGETLB; ++i)
+    {
+        if (tmp == arena_str[i]) return Arena(i);
+    }
+
+    gu_throw_error(EINVAL) << "Unrecognized allocator arena: '" << str << "'";
+    throw;
+}
+
 gu::Allocator::Allocator (const BaseName&         base_name,
                           void*                   reserved,
                           page_size_type          reserved_size,
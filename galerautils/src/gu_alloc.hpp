@@ -13,6 +13,7 @@
 #include "gu_mmap.hpp"
 #include "gu_buf.hpp"
 #include "gu_vector.hpp"
+#include "gu_atomic.hpp"
 
 #include "gu_macros.h" // gu_likely()
 
@@ -68,6 +69,29 @@ public:
      * be an issue. */
     static size_t const INITIAL_VECTOR_SIZE = 4;
 
+    /*! Page arena mode, process-wide. In THP and HUGETLB modes heap pages
+     *  grow geometrically up to the huge page size, huge page sized ones
+     *  are backed by transparent or explicit (with THP fallback) huge pages,
+     *  and released pages are kept in a per-thread free list for reuse
+     *  by the next allocator. File pages are preallocated and prefaulted. */
+    enum Arena
+    {
+        ARENA_NONE,    /* plain malloc()/sparse file pages */
+        ARENA_THP,
+        ARENA_HUGETLB
+    };
+
+    static void  arena (Arena a) { arena_ = a; }
+    static Arena arena () { return Arena(arena_()); }
+
+    /*! @throws Exception (EINVAL) if str does not name an arena mode */
+    static Arena arena (const std::string& str);
+
+    static page_size_type const HUGE_PAGE_SIZE = (1U << 21); /* 2M */
+
+    /*! @return size of released arena pages kept for reuse by all threads */
+    static size_t cached_size();
+
 private:
 
     class Page /* base class for memory and file pages */
@@ -113,16 +137,24 @@ private:
     {
     public:
 
-        HeapPage (page_size_type max_size);
+        HeapPage (page_size_type max_size, Arena arena = ARENA_NONE);
+
+        ~HeapPage ();
 
-        ~HeapPage () { free (base_ptr_); }
+    private:
+
+        page_size_type const size_;
+        bool                 mapped_; /* MAP_HUGETLB page */
+        bool const           cached_; /* return to thread free list */
     };
 
     class FilePage : public Page
     {
     public:
 
-        FilePage (const std::string& name, page_size_type size);
+        /*! @param prefault - preallocate file space and prefault mapping */
+        FilePage (const std::string& name, page_size_type size,
+                  bool prefault = false);
 
         ~FilePage () { fd_.unlink(); }
 
@@ -151,13 +183,14 @@ private:
     {
     public:
 
-        HeapStore (heap_size_type max) : PageStore(), left_(max) {}
+        HeapStore (heap_size_type max) : PageStore(), left_(max), n_(0) {}
 
         ~HeapStore () {}
 
     private:
 
         heap_size_type left_;
+        unsigned int   n_;    /* pages allocated so far */
 
         Page* my_new_page (page_size_type const size);
     };
@@ -220,6 +253,8 @@ private:
 
     static BaseNameDefault const BASE_NAME_DEFAULT;
 
+    static gu::Atomic<int> arena_;
+
 }; /* class Allocator */
 
 inline
@@ -445,6 +445,21 @@ namespace gu
          */
         virtual size_t read(const AsioMutableBuffer& buffer) = 0;
 
+        /**
+         * Write count bytes of file fd starting from offset into socket
+         * without copying them through user space (sendfile()). Blocks
+         * until all data has been written or error occurs.
+         *
+         * @return Number of bytes written or 0 if the socket does not
+         *         support it (e.g. encrypted), write() should be used then.
+         * @throw gu::Exception in case of error.
+         */
+        virtual size_t sendfile(int /* fd */, off_t /* offset */,
+                                size_t /* count */)
+        {
+            return 0;
+        }
+
         // Utility operations.
 
         /**
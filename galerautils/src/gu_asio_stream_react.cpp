@@ -21,6 +21,10 @@
 
 #include <boost/bind.hpp>
 
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
 static bool is_isolated()
 {
     const auto mode
@@ -245,6 +249,40 @@ catch (const asio::system_error& e)
     gu_throw_error(e.code().value()) << "Failed to write: " << e.what();
 }
 
+size_t gu::AsioStreamReact::sendfile(int const fd, off_t offset,
+                                     size_t const count)
+{
+#if defined(__linux__)
+    // Data must go through the engine unless it is plain TCP
+    if (engine_->scheme() != gu::scheme::tcp) return 0;
+
+    set_non_blocking(false);
+    size_t sent(0);
+    while (sent < count)
+    {
+        ssize_t const n(::sendfile(socket_.native_handle(), fd, &offset,
+                                   count - sent));
+        if (n > 0)
+        {
+            sent += n;
+        }
+        else if (n < 0 && EINTR == errno)
+        {
+            continue;
+        }
+        else
+        {
+            int const err(n < 0 ? errno : EINVAL); // 0 - past end of file
+            gu_throw_error(err) << "Failed to sendfile " << count - sent
+                                << " bytes at offset " << offset;
+        }
+    }
+    return sent;
+#else
+    return 0;
+#endif /* __linux__ */
+}
+
 size_t gu::AsioStreamReact::read(const AsioMutableBuffer& buf) try
 {
     set_non_blocking(false);
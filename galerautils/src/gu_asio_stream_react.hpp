@@ -60,6 +60,7 @@ namespace gu
         virtual void connect(const gu::URI&) GALERA_OVERRIDE;
         virtual size_t write(const AsioConstBuffer&) GALERA_OVERRIDE;
         virtual size_t read(const AsioMutableBuffer&) GALERA_OVERRIDE;
+        virtual size_t sendfile(int, off_t, size_t) GALERA_OVERRIDE;
         virtual std::string local_addr() const GALERA_OVERRIDE;
         virtual std::string remote_addr() const GALERA_OVERRIDE;
         virtual void set_receive_buffer_size(size_t) GALERA_OVERRIDE;
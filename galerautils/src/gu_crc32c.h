@@ -81,6 +81,9 @@ gu_crc32c_x86(gu_crc32c_t state, const void* data, size_t length);
 #if defined(GU_CRC32C_X86_64)
 extern gu_crc32c_t
 gu_crc32c_x86_64(gu_crc32c_t state, const void* data, size_t length);
+/* needs tables initialized by gu_crc32c_hardware() */
+extern gu_crc32c_t
+gu_crc32c_x86_64_3way(gu_crc32c_t state, const void* data, size_t length);
 #endif /* GU_CRC32C_X86_64 */
 #endif /* GU_CRC32C_X86 */
 
@@ -143,6 +143,129 @@ gu_crc32c_x86_64(gu_crc32c_t state, const void* data, size_t len)
 
     return crc32c_x86(state, ptr, len);
 }
+
+/*
+ * Three-way interleaved CRC-32C.
+ *
+ * A single chain of crc32 instructions is bound by their latency while the
+ * CPU can issue three at once. So large buffers are split into three adjacent
+ * streams, which are checksummed independently and then combined: CRC of
+ * a concatenation is the CRC of the first part "shifted" over the length of
+ * the second part, XOR the CRC of the second part computed from zero state.
+ * Shifting is multiplication by x^(8*len) modulo the CRC polynomial, which is
+ * tabulated for the stream lengths used.
+ */
+
+#define CRC32C_POLY  0x82f63b78 /* reversed 0x1EDC6F41 */
+#define CRC32C_LONG  4096       /* bytes per stream for long buffers */
+#define CRC32C_SHORT 256        /* bytes per stream for short buffers */
+
+static uint32_t crc32c_long [4][256];
+static uint32_t crc32c_short[4][256];
+
+/* multiplication of polynomials modulo CRC polynomial (reflected) */
+static uint32_t
+crc32c_multmodp(uint32_t const a, uint32_t b)
+{
+    uint32_t m = (uint32_t)1 << 31;
+    uint32_t p = 0;
+
+    assert(a != 0);
+
+    for (;;)
+    {
+        if (a & m)
+        {
+            p ^= b;
+            if ((a & (m - 1)) == 0) break;
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+    }
+
+    return p;
+}
+
+/* fills the tables to shift CRC over len zero bytes, byte by byte */
+static void
+crc32c_zeros(uint32_t zeros[4][256], size_t const len)
+{
+    uint32_t op = (uint32_t)1 << 31; /* x^0 */
+    size_t n;
+
+    for (n = 8 * len; n > 0; --n) /* x^(8*len) */
+    {
+        op = (op & 1) ? (op >> 1) ^ CRC32C_POLY : op >> 1;
+    }
+
+    for (n = 0; n < 256; ++n)
+    {
+        zeros[0][n] = crc32c_multmodp(op, (uint32_t)n);
+        zeros[1][n] = crc32c_multmodp(op, (uint32_t)n << 8);
+        zeros[2][n] = crc32c_multmodp(op, (uint32_t)n << 16);
+        zeros[3][n] = crc32c_multmodp(op, (uint32_t)n << 24);
+    }
+}
+
+static inline uint64_t
+crc32c_shift(uint32_t zeros[4][256], uint64_t const crc)
+{
+    return zeros[0][crc & 0xff]         ^ zeros[1][(crc >> 8) & 0xff] ^
+           zeros[2][(crc >> 16) & 0xff] ^ zeros[3][(crc >> 24) & 0xff];
+}
+
+/* processes 3*len bytes */
+static inline uint64_t
+crc32c_3way(uint64_t crc0, const uint8_t* ptr, size_t const len,
+            uint32_t zeros[4][256])
+{
+    const uint8_t* const end = ptr + len;
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+
+    do
+    {
+        crc0 = __builtin_ia32_crc32di(crc0, *(const uint64_t*)(ptr));
+        crc1 = __builtin_ia32_crc32di(crc1, *(const uint64_t*)(ptr + len));
+        crc2 = __builtin_ia32_crc32di(crc2, *(const uint64_t*)(ptr + 2*len));
+        ptr += sizeof(uint64_t);
+    }
+    while (ptr < end);
+
+    crc0 = crc32c_shift(zeros, crc0) ^ crc1;
+    return crc32c_shift(zeros, crc0) ^ crc2;
+}
+
+gu_crc32c_t
+gu_crc32c_x86_64_3way(gu_crc32c_t state, const void* data, size_t len)
+{
+    const uint8_t* ptr = (const uint8_t*)data;
+
+    if (len < 3*CRC32C_SHORT) return gu_crc32c_x86_64(state, ptr, len);
+
+    size_t align_offset = ((uintptr_t)ptr) % sizeof(uint64_t);
+    if (align_offset)
+    {
+        align_offset = sizeof(uint64_t) - align_offset;
+        state = crc32c_x86(state, ptr, align_offset);
+        len -= align_offset;
+        ptr += align_offset;
+    }
+
+    uint64_t state64 = state;
+
+    for (; len >= 3*CRC32C_LONG; len -= 3*CRC32C_LONG, ptr += 3*CRC32C_LONG)
+    {
+        state64 = crc32c_3way(state64, ptr, CRC32C_LONG, crc32c_long);
+    }
+
+    for (; len >= 3*CRC32C_SHORT; len -= 3*CRC32C_SHORT, ptr += 3*CRC32C_SHORT)
+    {
+        state64 = crc32c_3way(state64, ptr, CRC32C_SHORT, crc32c_short);
+    }
+
+    return gu_crc32c_x86_64((gu_crc32c_t)state64, ptr, len);
+}
 #endif /* GU_CRC32C_X86_64 */
 
 #include <cpuid.h>
@@ -167,8 +290,10 @@ gu_crc32c_hardware()
     if (SSE42_present)
     {
 #if defined(GU_CRC32C_X86_64)
-        gu_info ("CRC-32C: using 64-bit x86 acceleration.");
-        return gu_crc32c_x86_64;
+        crc32c_zeros(crc32c_long,  CRC32C_LONG);
+        crc32c_zeros(crc32c_short, CRC32C_SHORT);
+        gu_info ("CRC-32C: using 3-way interleaved 64-bit x86 acceleration.");
+        return gu_crc32c_x86_64_3way;
 #else
         gu_info ("CRC-32C: using 32-bit x86 acceleration.");
         return gu_crc32c_x86;
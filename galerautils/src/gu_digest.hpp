@@ -74,6 +74,21 @@ public:
 
     void     gather16 (void* const buf) const { gu_mmh128_get (&ctx_, buf); }
 
+    /* gathers 16-byte hashes of n objects at once, possibly in SIMD lanes,
+     * same as gather16() on each of them */
+    static void gather16 (const MMH3* h, size_t n, void* const buf)
+    {
+        static size_t const chunk(16);
+        const gu_mmh128_ctx_t* ctx[chunk];
+        byte_t* out(static_cast<byte_t*>(buf));
+
+        for (size_t i(0); n > 0; n -= i, h += i, out += i*16)
+        {
+            for (i = 0; i < std::min(n, chunk); ++i) ctx[i] = &h[i].ctx_;
+            gu_mmh128_get_batch (ctx, i, out);
+        }
+    }
+
     uint64_t gather8() const { return gu_mmh128_get64 (&ctx_); }
 
     uint32_t gather4() const { return gu_mmh128_get32 (&ctx_); }
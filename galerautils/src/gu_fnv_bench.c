@@ -7,7 +7,7 @@
  * To compile on Ubuntu:
   g++ -DHAVE_ENDIAN_H -DHAVE_BYTESWAP_H -DGALERA_LOG_H_ENABLE_CXX \
   -O3 -march=native -msse4 -Wall -Werror -I../.. gu_fnv_bench.c \
-  gu_mmh3.c gu_spooky.c gu_log.c gu_crc32c.c gu_crc32c_x86.c \
+  gu_mmh3.c gu_mmh3_x86.c gu_spooky.c gu_log.c gu_crc32c.c gu_crc32c_x86.c \
   -lssl -lcrypto -lcrypto++ -o gu_fnv_bench
  *
  * on CentOS some play with -lcrypto++ may be needed (also see includes below)
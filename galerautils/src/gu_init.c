@@ -8,6 +8,7 @@
 #include "gu_limits.h"
 #include "gu_abort.h"
 #include "gu_crc32c.h"
+#include "gu_mmh3.h"
 
 void
 gu_init (gu_log_cb_t log_cb)
@@ -23,4 +24,5 @@ gu_init (gu_log_cb_t log_cb)
     }
 
     gu_crc32c_configure();
+    gu_mmh128_configure();
 }
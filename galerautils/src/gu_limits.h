@@ -59,4 +59,7 @@ static inline size_t gu_avphys_bytes()
 
 #define GU_MIN_ALIGNMENT 8
 
+/* assumed CPU cache line size, for aligning frequently accessed data */
+#define GU_CACHE_LINE_SIZE 64
+
 #endif /* _gu_limits_h_ */
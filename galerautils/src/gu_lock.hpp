@@ -24,6 +24,8 @@ namespace gu
         Lock (const Lock&);
         Lock& operator=(const Lock&);
 
+        friend class Unlock;
+
     public:
 
         Lock (const Mutex& mtx) : mtx_(mtx)
@@ -77,6 +79,27 @@ namespace gu
         }
 #endif // defined(GU_DEBUG_MUTEX) || defined(GU_MUTEX_DEBUG)
     };
+
+    /* Releases the mutex held by lock for the lifetime of the object */
+    class Unlock
+    {
+        const Mutex& mtx_;
+
+        Unlock (const Unlock&);
+        Unlock& operator=(const Unlock&);
+
+    public:
+
+        explicit Unlock (Lock& lock) : mtx_(lock.mtx_)
+        {
+            mtx_.unlock();
+        }
+
+        ~Unlock ()
+        {
+            mtx_.lock();
+        }
+    };
 }
 
 #endif /* __GU_LOCK__ */
@@ -0,0 +1,223 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+#include "gu_lz.hpp"
+#include "gu_throw.hpp"
+#include "gu_macros.h"
+
+#include <cstring>
+#include <stdint.h>
+
+namespace
+{
+    using gu::byte_t;
+
+    static int     const HASH_LOG   = 12;
+    static size_t  const MIN_MATCH  = 4;
+    static size_t  const MAX_OFFSET = 0xffff;
+    static size_t  const RUN_MASK   = 15;
+    /* last bytes of input are always emitted as literals, that saves the
+     * decoder some bounds checks */
+    static size_t  const LAST_LITERALS = 5;
+    static size_t  const MATCH_LIMIT   = 12; // no match may start after that
+
+    inline uint32_t read32(const byte_t* const p)
+    {
+        uint32_t ret;
+        ::memcpy(&ret, p, sizeof(ret));
+        return ret;
+    }
+
+    inline uint32_t hash(uint32_t const v)
+    {
+        return (v * 2654435761U) >> (32 - HASH_LOG);
+    }
+
+    inline byte_t* write_length(byte_t* op, size_t len)
+    {
+        for (; len >= 255; len -= 255) *op++ = 255;
+        *op++ = byte_t(len);
+        return op;
+    }
+
+    /* returns NULL if sequence does not fit in the output */
+    inline byte_t* write_sequence(byte_t*             op,
+                                  const byte_t* const oend,
+                                  const byte_t* const lit,
+                                  size_t        const lit_len,
+                                  size_t        const offset,
+                                  size_t        const match_len)
+    {
+        size_t const mlen(match_len ? match_len - MIN_MATCH : 0);
+
+        if (gu_unlikely(size_t(oend - op) <
+                        1 + lit_len + lit_len/255 + 1 + 2 + mlen/255 + 1))
+            return NULL;
+
+        byte_t* const token(op++);
+
+        if (lit_len >= RUN_MASK)
+        {
+            *token = RUN_MASK << 4;
+            op = write_length(op, lit_len - RUN_MASK);
+        }
+        else
+        {
+            *token = byte_t(lit_len << 4);
+        }
+
+        ::memcpy(op, lit, lit_len);
+        op += lit_len;
+
+        if (0 == match_len) return op; // last literals
+
+        *op++ = byte_t(offset);
+        *op++ = byte_t(offset >> 8);
+
+        if (mlen >= RUN_MASK)
+        {
+            *token |= RUN_MASK;
+            op = write_length(op, mlen - RUN_MASK);
+        }
+        else
+        {
+            *token |= byte_t(mlen);
+        }
+
+        return op;
+    }
+
+    inline size_t read_length(const byte_t*& ip, const byte_t* const iend)
+    {
+        size_t ret(0);
+        byte_t b;
+
+        do
+        {
+            if (gu_unlikely(ip >= iend))
+                gu_throw_error(EINVAL) << "Truncated LZ stream";
+            b = *ip++;
+            ret += b;
+        }
+        while (255 == b);
+
+        return ret;
+    }
+}
+
+size_t
+gu::lz_compress(const void* const src_ptr, size_t const src_size,
+                void*       const dst_ptr, size_t const dst_size)
+{
+    const byte_t* const base(static_cast<const byte_t*>(src_ptr));
+    const byte_t* const iend(base + src_size);
+    byte_t*             op  (static_cast<byte_t*>(dst_ptr));
+    const byte_t* const oend(op + dst_size);
+
+    const byte_t* ip    (base);
+    const byte_t* anchor(base);
+
+    if (src_size > MATCH_LIMIT)
+    {
+        const byte_t* const mflimit(iend - MATCH_LIMIT);
+        const byte_t* const mlimit (iend - LAST_LITERALS);
+
+        uint32_t table[1 << HASH_LOG];
+        ::memset(table, 0, sizeof(table));
+
+        while (ip <= mflimit)
+        {
+            uint32_t const seq(read32(ip));
+            uint32_t const h(hash(seq));
+            const byte_t* const ref(base + table[h]);
+
+            table[h] = uint32_t(ip - base);
+
+            if (ref < ip && size_t(ip - ref) <= MAX_OFFSET &&
+                read32(ref) == seq)
+            {
+                size_t len(MIN_MATCH);
+                while (ip + len < mlimit && ref[len] == ip[len]) ++len;
+
+                op = write_sequence(op, oend, anchor, ip - anchor,
+                                    ip - ref, len);
+                if (gu_unlikely(NULL == op)) return 0;
+
+                ip    += len;
+                anchor = ip;
+            }
+            else
+            {
+                ++ip;
+            }
+        }
+    }
+
+    op = write_sequence(op, oend, anchor, iend - anchor, 0, 0);
+    if (gu_unlikely(NULL == op)) return 0;
+
+    return op - static_cast<byte_t*>(dst_ptr);
+}
+
+size_t
+gu::lz_decompress(const void* const src_ptr, size_t const src_size,
+                  void*       const dst_ptr, size_t const dst_size)
+{
+    const byte_t*       ip  (static_cast<const byte_t*>(src_ptr));
+    const byte_t* const iend(ip + src_size);
+    byte_t* const       dst (static_cast<byte_t*>(dst_ptr));
+    byte_t*             op  (dst);
+    const byte_t* const oend(dst + dst_size);
+
+    while (ip < iend)
+    {
+        byte_t const token(*ip++);
+
+        size_t lit_len(token >> 4);
+        if (RUN_MASK == lit_len) lit_len += read_length(ip, iend);
+
+        if (gu_unlikely(lit_len > size_t(iend - ip) ||
+                        lit_len > size_t(oend - op)))
+            gu_throw_error(EINVAL) << "LZ literal run of " << lit_len
+                                   << " bytes overflows the buffer";
+
+        ::memcpy(op, ip, lit_len);
+        op += lit_len;
+        ip += lit_len;
+
+        if (ip == iend) break; // last literals
+
+        if (gu_unlikely(iend - ip < 2))
+            gu_throw_error(EINVAL) << "Truncated LZ stream";
+
+        size_t const offset(ip[0] | (size_t(ip[1]) << 8));
+        ip += 2;
+
+        if (gu_unlikely(0 == offset || offset > size_t(op - dst)))
+            gu_throw_error(EINVAL) << "Invalid LZ match offset " << offset;
+
+        size_t match_len(token & RUN_MASK);
+        if (RUN_MASK == match_len) match_len += read_length(ip, iend);
+        match_len += MIN_MATCH;
+
+        if (gu_unlikely(match_len > size_t(oend - op)))
+            gu_throw_error(EINVAL) << "LZ match of " << match_len
+                                   << " bytes overflows the buffer";
+
+        const byte_t* ref(op - offset);
+
+        if (offset >= match_len)
+        {
+            ::memcpy(op, ref, match_len);
+            op += match_len;
+        }
+        else /* overlapping match, replicates the pattern */
+        {
+            for (const byte_t* const end(op + match_len); op < end;)
+                *op++ = *ref++;
+        }
+    }
+
+    return op - dst;
+}
@@ -0,0 +1,66 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+/*!
+ * @file Minimalistic LZ77-class codec for replication payload compression.
+ *
+ * The stream is a sequence of the following elements:
+ *
+ *   token:    bits 4-7: literal run length, bits 0-3: match length - 4,
+ *             value 15 in either field means that it is continued by a series
+ *             of 255-valued bytes terminated by a byte < 255
+ *   literals: literal run bytes
+ *   offset:   2 bytes, little-endian, match distance back from the output
+ *   match length continuation (see token)
+ *
+ * The last element carries only literals and ends with the input. It has
+ * no offset and no match length. The encoding was chosen for decoding
+ * speed, and it will grow incompressible input only marginally.
+ */
+
+#ifndef GU_LZ_HPP
+#define GU_LZ_HPP
+
+#include "gu_types.hpp"
+
+#include <cstddef>
+
+namespace gu
+{
+    /*! @return maximum size of the compressed representation of @param size
+     *          bytes of incompressible input */
+    inline size_t lz_bound(size_t const size)
+    {
+        return size + size/255 + 16;
+    }
+
+    /*! @return maximum size that @param size bytes of compressed input can
+     *          decompress to (every byte of a length continuation yields at
+     *          most 255 output bytes) */
+    inline uint64_t lz_max_decompressed(size_t const size)
+    {
+        return uint64_t(size) * 255;
+    }
+
+    /*!
+     * Compresses src_size bytes from src into dst.
+     *
+     * @return compressed size or 0 if it does not fit in dst_size bytes
+     *         (which makes it possible to abandon compression of poorly
+     *         compressible data early by passing dst_size < src_size)
+     */
+    size_t lz_compress(const void* src, size_t src_size,
+                       void* dst, size_t dst_size);
+
+    /*!
+     * Decompresses src_size bytes from src into dst.
+     *
+     * @return decompressed size
+     * @throws EINVAL if the input is malformed or does not fit in dst_size
+     */
+    size_t lz_decompress(const void* src, size_t src_size,
+                         void* dst, size_t dst_size);
+}
+
+#endif /* GU_LZ_HPP */
@@ -12,9 +12,18 @@
 
 #include "gu_limits.h" // GU_PAGE_SIZE
 
+#include <algorithm>
 #include <cerrno>
+#include <cstdlib>  // strtoul()
+#include <fstream>
+#include <vector>
 #include <sys/mman.h>
 
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #if defined(__FreeBSD__) && defined(MAP_NORESERVE)
 /* FreeBSD has never implemented this flags and will deprecate it. */
 #undef MAP_NORESERVE
@@ -24,17 +33,60 @@
 #define MAP_NORESERVE 0
 #endif
 
+#ifndef MAP_POPULATE
+#define MAP_POPULATE 0
+#endif
+
+#if defined(__linux__)
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23 /* Linux 5.14 */
+#endif
+/* from linux/mempolicy.h, to avoid dependency on libnuma */
+#define GU_MPOL_PREFERRED 1
+#define GU_MPOL_MF_MOVE   (1 << 1)
+
+namespace
+{
+    /* node mask for mbind()/set_mempolicy(), up to 1024 nodes */
+    struct NumaMask
+    {
+        static size_t const BITS = 1024;
+        static size_t const WORD_BITS = 8 * sizeof(unsigned long);
+
+        unsigned long mask[BITS / WORD_BITS];
+
+        explicit NumaMask(int const node) : mask()
+        {
+            mask[node / WORD_BITS] = 1UL << (node % WORD_BITS);
+        }
+
+        static bool valid(int const node)
+        {
+            if (node >= 0 && size_t(node) < BITS) return true;
+            log_warn << "Bad NUMA node: " << node;
+            return false;
+        }
+
+        /* the kernel reads maxnode - 1 bits */
+        static unsigned long maxnode() { return BITS + 1; }
+    };
+}
+#endif /* __linux__ */
+
 // to avoid -Wold-style-cast
 extern "C" { static const void* const GU_MAP_FAILED = MAP_FAILED; }
 
 namespace gu
 {
-    MMap::MMap (const FileDescriptor& fd, bool const sequential)
+    MMap::MMap (const FileDescriptor& fd, bool const sequential,
+                bool const populate)
         :
         size   (fd.size()),
         ptr    (mmap (NULL, size, PROT_READ|PROT_WRITE,
-                      MAP_SHARED|MAP_NORESERVE, fd.get(), 0)),
-        mapped (ptr != GU_MAP_FAILED)
+                      MAP_SHARED|MAP_NORESERVE|(populate ? MAP_POPULATE : 0),
+                      fd.get(), 0)),
+        mapped (ptr != GU_MAP_FAILED),
+        locked_(false)
     {
         if (!mapped)
         {
@@ -119,6 +171,211 @@ namespace gu
         log_debug << "Memory unmapped: " << ptr << " (" << size <<" bytes)";
     }
 
+    bool
+    MMap::advise_hugepages() const
+    {
+#if defined(MADV_HUGEPAGE)
+        if (::madvise(ptr, size, MADV_HUGEPAGE))
+        {
+            int const err(errno);
+            log_warn << "Failed to set MADV_HUGEPAGE on " << ptr << ": "
+                     << err << " (" << strerror(err) << ')';
+            return false;
+        }
+        return true;
+#else
+        log_warn << "Transparent huge pages are not supported on this system";
+        return false;
+#endif /* MADV_HUGEPAGE */
+    }
+
+    bool
+    MMap::populate() const
+    {
+#if defined(__linux__)
+        if (0 == ::madvise(ptr, size, MADV_POPULATE_WRITE)) return true;
+
+        if (EINVAL != errno)
+        {
+            int const err(errno);
+            log_warn << "Failed to prefault " << ptr << ": " << err << " ("
+                     << strerror(err) << ')';
+            return false;
+        }
+#endif /* __linux__ */
+        /* older kernel, read-fault every page */
+        const volatile uint8_t* const p(static_cast<uint8_t*>(ptr));
+        for (size_t off(0); off < size; off += GU_PAGE_SIZE) (void)p[off];
+        return true;
+    }
+
+    bool
+    MMap::lock()
+    {
+        if (!locked_ && ::mlock(ptr, size))
+        {
+            int const err(errno);
+            log_warn << "Failed to lock " << size << " bytes at " << ptr
+                     << " in memory: " << err << " (" << strerror(err)
+                     << "), check RLIMIT_MEMLOCK";
+            return false;
+        }
+        locked_ = true;
+        return true;
+    }
+
+    bool
+    MMap::bind(int const node) const
+    {
+#if defined(__linux__) && defined(SYS_mbind)
+        if (!NumaMask::valid(node)) return false;
+
+        NumaMask const nm(node);
+
+        /* for shared file mappings the policy itself is ignored by the kernel
+         * (page cache follows the policy of the faulting thread, see
+         * numa_prefer()), but MPOL_MF_MOVE still migrates resident pages */
+        if (::syscall(SYS_mbind, ptr, size, GU_MPOL_PREFERRED, nm.mask,
+                      NumaMask::maxnode(), GU_MPOL_MF_MOVE))
+        {
+            int const err(errno);
+            log_warn << "Failed to bind " << ptr << " to NUMA node " << node
+                     << ": " << err << " (" << strerror(err) << ')';
+            return false;
+        }
+        return true;
+#else
+        log_warn << "NUMA binding is not supported on this system";
+        return false;
+#endif
+    }
+
+    size_t
+    mem_resident(const void* const ptr, size_t const size)
+    {
+        /* big ranges are queried in chunks to bound the vector size */
+        static size_t const CHUNK_PAGES(1 << 16);
+#if defined(__linux__)
+        typedef unsigned char mincore_vec_t;
+#else
+        typedef char mincore_vec_t;
+#endif
+        std::vector<unsigned char> vec
+            (std::min<size_t>((size + GU_PAGE_SIZE - 1)/GU_PAGE_SIZE,
+                              CHUNK_PAGES));
+        const char* const begin(static_cast<const char*>(ptr));
+        size_t ret(0);
+
+        for (size_t off(0); off < size; off += CHUNK_PAGES * GU_PAGE_SIZE)
+        {
+            size_t const len(std::min(size - off, CHUNK_PAGES*GU_PAGE_SIZE));
+
+            if (::mincore(const_cast<char*>(begin + off), len,
+                          reinterpret_cast<mincore_vec_t*>(vec.data())))
+            {
+                return 0; /* unmapped meanwhile */
+            }
+
+            size_t const pages((len + GU_PAGE_SIZE - 1)/GU_PAGE_SIZE);
+            for (size_t i(0); i < pages; ++i) ret += (vec[i] & 1);
+        }
+
+        return std::min(ret * GU_PAGE_SIZE, size);
+    }
+
+    void
+    mem_will_need(const void* const ptr, size_t const size)
+    {
+        static uintptr_t const PAGE_SIZE_MASK(~(GU_PAGE_SIZE - 1));
+
+        uintptr_t const begin(reinterpret_cast<uintptr_t>(ptr)
+                              & PAGE_SIZE_MASK);
+        uintptr_t const end(reinterpret_cast<uintptr_t>(ptr) + size);
+
+        if (posix_madvise(reinterpret_cast<void*>(begin), end - begin,
+                          POSIX_MADV_WILLNEED))
+        {
+            log_debug << "Failed to set MADV_WILLNEED on " << ptr << ": "
+                      << errno << " (" << strerror(errno) << ')';
+        }
+    }
+
+    size_t
+    mem_huge(const MemRanges& ranges)
+    {
+        std::ifstream smaps("/proc/self/smaps");
+        bool   in_range(false);
+        size_t ret(0);
+        std::string line;
+
+        while (std::getline(smaps, line))
+        {
+            size_t const colon(line.find(':'));
+            size_t const dash(line.find('-'));
+
+            if (dash != std::string::npos &&
+                (colon == std::string::npos || dash < colon))
+            {
+                /* VMA header: "begin-end perms offset dev inode path" */
+                uintptr_t const begin(strtoul(line.c_str(), NULL, 16));
+                uintptr_t const end(strtoul(line.c_str() + dash + 1, NULL,16));
+
+                in_range = false;
+                for (size_t i(0); !in_range && i < ranges.size(); ++i)
+                {
+                    uintptr_t const b(uintptr_t(ranges[i].first));
+                    in_range = b < end && b + ranges[i].second > begin;
+                }
+            }
+            else if (in_range && colon != std::string::npos)
+            {
+                std::string const key(line, 0, colon);
+
+                if (key == "AnonHugePages"   || key == "ShmemPmdMapped" ||
+                    key == "FilePmdMapped"   || key == "Shared_Hugetlb" ||
+                    key == "Private_Hugetlb")
+                {
+                    ret += strtoul(line.c_str() + colon + 1, NULL, 10) << 10;
+                }
+            }
+        }
+
+        return ret;
+    }
+
+    int
+    numa_node()
+    {
+#if defined(__linux__) && defined(SYS_getcpu)
+        unsigned int cpu, node;
+        if (0 == ::syscall(SYS_getcpu, &cpu, &node, NULL)) return node;
+#endif
+        return -1;
+    }
+
+    bool
+    numa_prefer(int const node)
+    {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+        if (!NumaMask::valid(node)) return false;
+
+        NumaMask const nm(node);
+
+        if (0 == ::syscall(SYS_set_mempolicy, GU_MPOL_PREFERRED, nm.mask,
+                           NumaMask::maxnode()))
+        {
+            return true;
+        }
+
+        int const err(errno);
+        log_warn << "Failed to set preferred NUMA node " << node << ": "
+                 << err << " (" << strerror(err) << ')';
+#else
+        log_warn << "NUMA binding is not supported on this system";
+#endif
+        return false;
+    }
+
     MMap::~MMap ()
     {
         if (mapped)
@@ -9,6 +9,9 @@
 
 #include "gu_fdesc.hpp"
 
+#include <utility>
+#include <vector>
+
 namespace gu
 {
 
@@ -20,7 +23,9 @@ public:
     size_t const size;
     void*  const ptr;
 
-    MMap (const FileDescriptor& fd, bool sequential = false);
+    /*! @param populate - prefault the mapping (MAP_POPULATE) */
+    MMap (const FileDescriptor& fd, bool sequential = false,
+          bool populate = false);
 
     ~MMap ();
 
@@ -29,15 +34,50 @@ public:
     void sync() const;
     void unmap();
 
+    /* Placement hints. These are best effort: on failure a warning is
+     * logged and false is returned, the mapping stays usable. */
+
+    /*! ask for transparent huge pages (MADV_HUGEPAGE) */
+    bool advise_hugepages() const;
+    /*! prefault the whole mapping for writing */
+    bool populate() const;
+    /*! lock the mapping in RAM (mlock()) */
+    bool lock();
+    /*! prefer NUMA node for the mapping and migrate pages already there */
+    bool bind(int node) const;
+
+    bool locked() const { return locked_; }
+
 private:
 
     bool mapped;
+    bool locked_;
 
     // This class is definitely non-copyable
     MMap (const MMap&);
     MMap& operator = (const MMap);
 };
 
+typedef std::vector<std::pair<const void*, size_t> > MemRanges;
+
+/*! @return number of bytes of the range currently resident in RAM */
+size_t mem_resident(const void* ptr, size_t size);
+
+/*! start asynchronous readahead of the range (MADV_WILLNEED), the range
+ *  is extended to page boundaries, best effort */
+void mem_will_need(const void* ptr, size_t size);
+
+/*! @return number of bytes of the ranges mapped by huge pages,
+ *  reads /proc/self/smaps once, so it is better to query ranges in bulk */
+size_t mem_huge(const MemRanges& ranges);
+
+/*! @return NUMA node of the CPU the calling thread runs on or -1 */
+int  numa_node();
+
+/*! make calling thread allocate memory (including file pages it faults
+ *  in) preferably on the given NUMA node, best effort */
+bool numa_prefer(int node);
+
 } /* namespace gu */
 
 #endif /* __GCACHE_MMAP__ */
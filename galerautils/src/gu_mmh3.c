@@ -10,6 +10,7 @@
 #include "gu_mmh3.h"
 
 #include "gu_byteswap.h"
+#include "gu_log.h"
 
 #include <string.h> // for memset() and memcpy()
 
@@ -376,6 +377,38 @@ gu_mmh128_get32 (const gu_mmh128_ctx_t* const mmh)
     return (uint32_t)res[0];
 }
 
+void
+gu_mmh128_get_batch_scalar (const gu_mmh128_ctx_t* const* const mmh,
+                            size_t const n, void* const res)
+{
+    size_t i;
+    for (i = 0; i < n; ++i)
+    {
+        gu_mmh128_get (mmh[i], (uint8_t*)res + i*16);
+    }
+}
+
+gu_mmh128_get_batch_func_t gu_mmh128_get_batch_func =
+    gu_mmh128_get_batch_scalar;
+
+void
+gu_mmh128_configure()
+{
+    gu_mmh128_get_batch_func_t ret = NULL;
+
+#if defined(GU_MMH3_X86_64)
+    ret = gu_mmh128_get_batch_hardware();
+#endif
+
+    if (!ret)
+    {
+        gu_info ("MMH3: using scalar batch hashing.");
+        ret = gu_mmh128_get_batch_scalar;
+    }
+
+    gu_mmh128_get_batch_func = ret;
+}
+
 void
 gu_mmh3_32 (const void* const key, int const len, uint32_t const seed, void* const out)
 {
@@ -69,6 +69,42 @@ gu_mmh128_get64(const gu_mmh128_ctx_t* mmh);
 extern uint32_t
 gu_mmh128_get32(const gu_mmh128_ctx_t* mmh);
 
+/*
+ * Batch finalization of several hash contexts, e.g. of many short keys.
+ * Depending on the CPU, contexts are processed in parallel SIMD lanes.
+ */
+
+typedef void (*gu_mmh128_get_batch_func_t) (const gu_mmh128_ctx_t* const* mmh,
+                                            size_t n, void* res);
+
+extern gu_mmh128_get_batch_func_t gu_mmh128_get_batch_func;
+
+/*! Call this to configure batch hashing to use the best available
+ *  implementation */
+extern void
+gu_mmh128_configure();
+
+/*! Get the hashes of n contexts, same as gu_mmh128_get() on each of them.
+ *  res should have room for n 16-byte hashes. */
+static inline void
+gu_mmh128_get_batch(const gu_mmh128_ctx_t* const* const mmh, size_t const n,
+                    void* const res)
+{
+    gu_mmh128_get_batch_func(mmh, n, res);
+}
+
+/* Portable implementation for gu_mmh128_get_batch_func */
+extern void
+gu_mmh128_get_batch_scalar(const gu_mmh128_ctx_t* const* mmh, size_t n,
+                           void* res);
+
+#if defined(__x86_64) && defined(__GNUC__)
+#define GU_MMH3_X86_64
+/* returns the best SIMD implementation available on the CPU or NULL */
+extern gu_mmh128_get_batch_func_t
+gu_mmh128_get_batch_hardware();
+#endif /* GU_MMH3_X86_64 */
+
 /*
  * Below are fuctions with reference signatures for implementation verification
  */
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ *
+ * @file SIMD batch finalization of 128-bit MurmurHash3 contexts on x86_64.
+ *
+ * Finalizes 8 contexts in parallel 64-bit AVX-512 lanes, the result is
+ * bit-identical to gu_mmh128_get(). AVX-512 is required for native 64-bit
+ * multiplication: with AVX2 it has to be composed of 32-bit ones and turns
+ * out slower than the scalar code. Vector code is enabled with function
+ * target attributes, so this file does not need special compiler flags
+ * and the code is used only if the CPU supports it.
+ *
+ * Defines gu_mmh128_get_batch_hardware() that returns pointer to
+ * gu_mmh128_get_batch_func_t if available on a given CPU.
+ */
+
+#include "gu_mmh3.h"
+
+#if defined(GU_MMH3_X86_64)
+
+#include "gu_log.h"
+
+#include <immintrin.h>
+#include <stddef.h> // offsetof()
+
+#define MMH3_C1 0x87c37b91114253d5ULL
+#define MMH3_C2 0x4cf5ad432745937fULL
+
+/* Context fields are gathered straight to lanes: the context pointers are
+ * used as gather indices with zero base. */
+#define MMH3_FIELD(field) offsetof(gu_mmh128_ctx_t, field)
+
+#define MMH3_AVX512 __attribute__((target("avx512f,avx512dq")))
+
+static MMH3_AVX512 inline __m512i
+mmh3_mix_avx512(__m512i k, uint64_t const m1, int const r, uint64_t const m2)
+{
+    k = _mm512_mullo_epi64(k, _mm512_set1_epi64(m1));
+    k = _mm512_rolv_epi64(k, _mm512_set1_epi64(r));
+    return _mm512_mullo_epi64(k, _mm512_set1_epi64(m2));
+}
+
+static MMH3_AVX512 inline __m512i
+mmh3_fmix64_avx512(__m512i k)
+{
+    k = _mm512_xor_si512(k, _mm512_srli_epi64(k, 33));
+    k = _mm512_mullo_epi64(k, _mm512_set1_epi64(0xff51afd7ed558ccdULL));
+    k = _mm512_xor_si512(k, _mm512_srli_epi64(k, 33));
+    k = _mm512_mullo_epi64(k, _mm512_set1_epi64(0xc4ceb9fe1a85ec53ULL));
+    return _mm512_xor_si512(k, _mm512_srli_epi64(k, 33));
+}
+
+static MMH3_AVX512 void
+mmh3_get8_avx512(const gu_mmh128_ctx_t* const* const mmh, void* const res)
+{
+    __m512i const ptr = _mm512_loadu_si512(mmh);
+#define MMH3_GATHER(field)                                                   \
+    _mm512_i64gather_epi64(_mm512_add_epi64(ptr,                             \
+        _mm512_set1_epi64(MMH3_FIELD(field))), NULL, 1)
+    __m512i h1  = MMH3_GATHER(hash[0]);
+    __m512i h2  = MMH3_GATHER(hash[1]);
+    __m512i k1  = MMH3_GATHER(tail[0]);
+    __m512i k2  = MMH3_GATHER(tail[1]);
+    __m512i const len = MMH3_GATHER(length);
+#undef MMH3_GATHER
+
+    /* mask off the bytes beyond the tail: n1 = min(n, 8), n2 = max(n - 8, 0),
+     * shift counts of 64 give empty masks */
+    __m512i const ones  = _mm512_set1_epi64(-1);
+    __m512i const eight = _mm512_set1_epi64(8);
+    __m512i const n     = _mm512_and_si512(len, _mm512_set1_epi64(15));
+    __m512i const n1    = _mm512_min_epu64(n, eight);
+    __m512i const n2    = _mm512_sub_epi64(_mm512_max_epu64(n, eight), eight);
+    __m512i const c64   = _mm512_set1_epi64(64);
+    k1 = _mm512_and_si512(k1, _mm512_srlv_epi64(ones,
+        _mm512_sub_epi64(c64, _mm512_slli_epi64(n1, 3))));
+    k2 = _mm512_and_si512(k2, _mm512_srlv_epi64(ones,
+        _mm512_sub_epi64(c64, _mm512_slli_epi64(n2, 3))));
+
+    /* zero k mixes to zero, so empty tails need no special treatment */
+    h1 = _mm512_xor_si512(h1, mmh3_mix_avx512(k1, MMH3_C1, 31, MMH3_C2));
+    h2 = _mm512_xor_si512(h2, mmh3_mix_avx512(k2, MMH3_C2, 33, MMH3_C1));
+
+    h1 = _mm512_xor_si512(h1, len);
+    h2 = _mm512_xor_si512(h2, len);
+    h1 = _mm512_add_epi64(h1, h2);
+    h2 = _mm512_add_epi64(h2, h1);
+    h1 = mmh3_fmix64_avx512(h1);
+    h2 = mmh3_fmix64_avx512(h2);
+    h1 = _mm512_add_epi64(h1, h2);
+    h2 = _mm512_add_epi64(h2, h1);
+
+    /* interleave lanes to h1[0], h2[0], h1[1], h2[1], ... (x86 is
+     * little-endian, so this is already the canonical byte order) */
+    __m512i const lo = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0);
+    __m512i const hi = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+    _mm512_storeu_si512(res, _mm512_permutex2var_epi64(h1, lo, h2));
+    _mm512_storeu_si512((uint8_t*)res + 64,
+                        _mm512_permutex2var_epi64(h1, hi, h2));
+}
+
+static MMH3_AVX512 void
+mmh128_get_batch_avx512(const gu_mmh128_ctx_t* const* mmh, size_t n,
+                        void* const res)
+{
+    uint8_t* out = (uint8_t*)res;
+
+    for (; n >= 8; n -= 8, mmh += 8, out += 8*16)
+    {
+        mmh3_get8_avx512(mmh, out);
+    }
+
+    gu_mmh128_get_batch_scalar(mmh, n, out);
+}
+
+gu_mmh128_get_batch_func_t
+gu_mmh128_get_batch_hardware()
+{
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+    {
+        gu_info ("MMH3: using AVX-512 batch hashing.");
+        return mmh128_get_batch_avx512;
+    }
+
+    return NULL;
+}
+
+#endif /* GU_MMH3_X86_64 */
@@ -35,6 +35,7 @@ RecordSet::check_size (RecordSet::CheckType const ct)
     case RecordSet::CHECK_MMH32:  return 4;
     case RecordSet::CHECK_MMH64:  return 8;
     case RecordSet::CHECK_MMH128: return 16;
+    case RecordSet::CHECK_CRC32C: return 8; /* 64-bit for VER2+ alignment */
 #define MAX_CHECKSUM_SIZE                16
     }
 
@@ -80,6 +81,7 @@ RecordSetOutBase::header_size_max() const
     case VER1:
         return header_size_max_v1();
     case VER2:
+    case VER3:
         return header_size_max_v2();
     }
 
@@ -197,6 +199,7 @@ RecordSetOutBase::header_size() const
     case VER1:
         return header_size_v1(size_, count_);
     case VER2:
+    case VER3:
         return header_size_v2(size_, count_);
     }
 
@@ -232,6 +235,7 @@ RecordSetOutBase::write_header (byte_t* const buf, ssize_t const size)
     switch (version())
     {
     case VER2:
+    case VER3:
         if (VER2_REDUCTION == off) /* 4 byte header version */
         {
             /* comparison above is a valid condition only if VER2_SIZE_MAX is
@@ -272,7 +276,13 @@ RecordSetOutBase::write_header (byte_t* const buf, ssize_t const size)
     assert(header_size_max() == off);
 
     /* append payload checksum */
-    if (check_type() != CHECK_NONE)
+    if (CHECK_CRC32C == check_type())
+    {
+        assert (csize <= size - off);
+        crc_.append (buf + hdr_offset, off - hdr_offset); /* append header */
+        gu::serialize8(uint64_t(crc_.get()), buf, off);
+    }
+    else if (check_type() != CHECK_NONE)
     {
         assert (csize <= size - off);
         check_.append (buf + hdr_offset, off - hdr_offset); /* append header */
@@ -295,7 +305,7 @@ RecordSetOutBase::gather (GatherVector& out)
 #endif /* NDEBUG */
         unsigned int pad_size(0);
 
-        if (gu_likely(VER2 == version()))
+        if (gu_likely(version() >= VER2))
         {
             /* make sure size_ is padded to multiple of VER2_ALIGNMENT */
             int const dangling_bytes(size_ % VER2_ALIGNMENT);
@@ -378,6 +388,7 @@ RecordSetOutBase::RecordSetOutBase (byte_t*                 reserved,
 #endif
     alloc_      (base_name, reserved, reserved_size, max_heap),
     check_      (),
+    crc_        (),
     bufs_       (),
     prev_stored_(true)
 {
@@ -420,16 +431,19 @@ header_check_type(RecordSet::Version const ver,
     case RecordSet::EMPTY: assert(0); return RecordSet::CHECK_NONE;
     case RecordSet::VER1:
     case RecordSet::VER2:
+    case RecordSet::VER3:
     {
         int const ct(ptr[0] & 0x07);
 
         switch (ct)
         {
         case RecordSet::CHECK_NONE:   return RecordSet::CHECK_NONE;
-        case RecordSet::CHECK_MMH32:  if (RecordSet::VER2 == ver) break;
+        case RecordSet::CHECK_MMH32:  if (RecordSet::VER2 <= ver) break;
             return RecordSet::CHECK_MMH32;
         case RecordSet::CHECK_MMH64:  return RecordSet::CHECK_MMH64;
         case RecordSet::CHECK_MMH128: return RecordSet::CHECK_MMH128;
+        case RecordSet::CHECK_CRC32C: if (RecordSet::VER3 > ver) break;
+            return RecordSet::CHECK_CRC32C;
         }
 
         gu_throw_error (EPROTO) << "Unsupported RecordSet checksum type: " << ct;
@@ -485,7 +499,7 @@ RecordSetInBase::parse_header_v1_2 (size_t const size)
 
     size_t off;
 
-    if (VER2 == version() && (head_[0] & VER2_SHORT_FLAG))
+    if (version() >= VER2 && (head_[0] & VER2_SHORT_FLAG))
     {
         off = read_size_count_v2_short(head_, size_, count_);
     }
@@ -536,7 +550,25 @@ RecordSetInBase::checksum() const
 {
     int const cs(check_size(check_type()));
 
-    if (cs > 0) /* checksum records */
+    if (CHECK_CRC32C == check_type())
+    {
+        CRC32C check;
+
+        check.append (head_ + begin_, serial_size() - begin_); /* records */
+        check.append (head_, begin_ - cs);                     /* header  */
+
+        uint64_t stored_checksum;
+        gu::unserialize8(head_, begin_ - cs, stored_checksum);
+
+        if (gu_unlikely(check.get() != stored_checksum))
+        {
+            gu_throw_error(EINVAL)
+                << "RecordSet checksum does not match:"
+                << std::hex << "\ncomputed: " << check.get()
+                << "\nfound:    " << stored_checksum << std::dec;
+        }
+    }
+    else if (cs > 0) /* checksum records */
     {
         Hash check;
 
@@ -606,6 +638,7 @@ RecordSetInBase::init (const byte_t* const ptr,
     case EMPTY: return;
     case VER1:
     case VER2:
+    case VER3:
         assert(0 != alignment());
         if (alignment() > 1) assert((uintptr_t(head_) % GU_WORD_BYTES) == 0);
         parse_header_v1_2(size); // should set begin_
@@ -16,6 +16,7 @@
 #include "gu_vector.hpp"
 #include "gu_alloc.hpp"
 #include "gu_digest.hpp"
+#include "gu_crc.hpp"
 
 #include "gu_limits.h" // GU_MIN_ALIGNMENT
 
@@ -35,10 +36,11 @@ public:
     {
         EMPTY = 0,
         VER1,
-        VER2
+        VER2,
+        VER3  /* VER2 which may be checksummed with CRC-32C */
     };
 
-    static Version const MAX_VERSION    = VER2;
+    static Version const MAX_VERSION    = VER3;
     static int     const VER2_ALIGNMENT = GU_MIN_ALIGNMENT;
 
     enum CheckType
@@ -46,11 +48,18 @@ public:
         CHECK_NONE   = 0,
         CHECK_MMH32,
         CHECK_MMH64,
-        CHECK_MMH128
+        CHECK_MMH128,
+        CHECK_CRC32C  /* since VER3 */
     };
 
     static int check_size(CheckType ct);
 
+    /*! the fastest payload checksum supported by the given version */
+    static CheckType payload_check_type(Version ver)
+    {
+        return (ver >= VER3 ? CHECK_CRC32C : CHECK_MMH128);
+    }
+
     /*! return net, payload size of a RecordSet */
     size_t size() const  { return size_; }
 
@@ -236,6 +245,7 @@ private:
 #endif
     Allocator     alloc_;
     Hash          check_;
+    CRC32C        crc_;     /* for CHECK_CRC32C */
     Vector<Buf, Allocator::INITIAL_VECTOR_SIZE> bufs_;
     bool          prev_stored_;
 
@@ -273,7 +283,11 @@ private:
                  const byte_t* const ptr,
                  ssize_t const       size)
     {
-        check_.append (ptr, size);
+        if (CHECK_CRC32C == check_type())
+            crc_.append (ptr, size);
+        else
+            check_.append (ptr, size);
+
         post_alloc (new_page, ptr, size);
     }
 
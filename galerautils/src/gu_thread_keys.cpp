@@ -35,6 +35,12 @@ static struct ThreadKeysVecInitializer
             std::make_pair("gcs_recv", (wsrep_thread_key_t*)(0)));
         thread_keys_vec.push_back(
             std::make_pair("gcs_gcomm", (wsrep_thread_key_t*)(0)));
+        thread_keys_vec.push_back(
+            std::make_pair("gcache_page", (wsrep_thread_key_t*)(0)));
+        thread_keys_vec.push_back(
+            std::make_pair("gcache_prescan", (wsrep_thread_key_t*)(0)));
+        thread_keys_vec.push_back(
+            std::make_pair("gcache_rb_index", (wsrep_thread_key_t*)(0)));
         assert(thread_keys_vec.size() == gu::GU_THREAD_KEY_MAX);
     }
     const char* name;
@@ -110,6 +116,16 @@ public:
             std::make_pair("writeset_waiter_map", (wsrep_mutex_key_t*)(0)));
         mutex_keys_vec.push_back(
             std::make_pair("writeset_waiter", (wsrep_mutex_key_t*)(0)));
+        mutex_keys_vec.push_back(
+            std::make_pair("write_set_check", (wsrep_mutex_key_t*)(0)));
+        mutex_keys_vec.push_back(
+            std::make_pair("gcache_page_store", (wsrep_mutex_key_t*)(0)));
+        mutex_keys_vec.push_back(
+            std::make_pair("gcache_prescan", (wsrep_mutex_key_t*)(0)));
+        mutex_keys_vec.push_back(
+            std::make_pair("gcache_map_status", (wsrep_mutex_key_t*)(0)));
+        mutex_keys_vec.push_back(
+            std::make_pair("gcache_rb_index", (wsrep_mutex_key_t*)(0)));
         assert(mutex_keys_vec.size() == gu::GU_MUTEX_KEY_MAX);
     }
     const char* name;
@@ -172,6 +188,16 @@ static struct CondKeysVecInitializer
             std::make_pair("gcache", (wsrep_cond_key_t*)(0)));
         cond_keys_vec.push_back(
             std::make_pair("write_set_waiter", (wsrep_cond_key_t*)(0)));
+        cond_keys_vec.push_back(
+            std::make_pair("write_set_check", (wsrep_cond_key_t*)(0)));
+        cond_keys_vec.push_back(
+            std::make_pair("write_set_check_done", (wsrep_cond_key_t*)(0)));
+        cond_keys_vec.push_back(
+            std::make_pair("gcache_page_store", (wsrep_cond_key_t*)(0)));
+        cond_keys_vec.push_back(
+            std::make_pair("gcache_prescan", (wsrep_cond_key_t*)(0)));
+        cond_keys_vec.push_back(
+            std::make_pair("gcache_rb_index", (wsrep_cond_key_t*)(0)));
         assert(cond_keys_vec.size() == gu::GU_COND_KEY_MAX);
     }
     const char* name;
@@ -22,6 +22,9 @@ namespace gu
         GU_THREAD_KEY_WRITE_SET_CHECK,
         GU_THREAD_KEY_GCS_RECV,
         GU_THREAD_KEY_GCS_GCOMM,
+        GU_THREAD_KEY_GCACHE_PAGE,
+        GU_THREAD_KEY_GCACHE_PRESCAN,
+        GU_THREAD_KEY_GCACHE_RB_INDEX,
         GU_THREAD_KEY_MAX // must be the last
     };
 
@@ -60,6 +63,11 @@ namespace gu
         GU_MUTEX_KEY_GCS_MEMBERSHIP,
         GU_MUTEX_KEY_WRITESET_WAITER_MAP,
         GU_MUTEX_KEY_WRITESET_WAITER,
+        GU_MUTEX_KEY_WRITE_SET_CHECK,
+        GU_MUTEX_KEY_GCACHE_PAGE_STORE,
+        GU_MUTEX_KEY_GCACHE_PRESCAN,
+        GU_MUTEX_KEY_GCACHE_MAP_STATUS,
+        GU_MUTEX_KEY_GCACHE_RB_INDEX,
         GU_MUTEX_KEY_MAX /* This must always be the last */
     };
 
@@ -92,6 +100,11 @@ namespace gu
         GU_COND_KEY_GCS_CORE_CAUSED,
         GU_COND_KEY_GCACHE,
         GU_COND_KEY_WRITESET_WAITER,
+        GU_COND_KEY_WRITE_SET_CHECK,
+        GU_COND_KEY_WRITE_SET_CHECK_DONE,
+        GU_COND_KEY_GCACHE_PAGE_STORE,
+        GU_COND_KEY_GCACHE_PRESCAN,
+        GU_COND_KEY_GCACHE_RB_INDEX,
         GU_COND_KEY_MAX /* This must always be the last */
     };
 
@@ -107,6 +107,7 @@ one_length(size_t const len, size_t const reps)
     run_bench_with_impl(gu_crc32c_x86,          len, reps, "GU x86_32  ");
 #if defined(GU_CRC32C_X86_64)
     run_bench_with_impl(gu_crc32c_x86_64,       len, reps, "GU x86_64  ");
+    run_bench_with_impl(gu_crc32c_x86_64_3way,  len, reps, "GU x86_64x3");
 #endif /* GU_CRC32C_X86_64 */
 #endif /* GU_CRC32C_X86 */
 
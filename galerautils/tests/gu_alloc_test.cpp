@@ -3,9 +3,16 @@
 // $Id$
 
 #include "../src/gu_alloc.hpp"
+#include "../src/gu_arch.h" // GU_WORD_BYTES
 
 #include "gu_alloc_test.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 class TestBaseName : public gu::Allocator::BaseName
 {
     std::string str_;
@@ -82,10 +89,136 @@ START_TEST (basic)
 }
 END_TEST
 
+static void
+test_arena(gu::Allocator::Arena const arena)
+{
+    gu::Allocator::Arena const old(gu::Allocator::arena());
+    gu::Allocator::arena(arena);
+
+    TestBaseName test_name("gu_alloc_test");
+    size_t const rec(1 << 12);
+    size_t const total(1 << 20);
+    std::vector<gu::byte_t*> first_pages;
+
+    for (int trx(0); trx < 2; ++trx)
+    {
+        gu::Allocator a(test_name, NULL, 0, total * 2, 1 << 16);
+        std::vector<gu::byte_t*> pages;
+
+        for (size_t s(0); s < total; s += rec)
+        {
+            bool n;
+            gu::byte_t* const p(a.alloc(rec, n));
+            ck_assert(0 != p);
+            ck_assert(0 == (uintptr_t(p) % GU_WORD_BYTES));
+            memset(p, trx, rec);
+            if (n) pages.push_back(p);
+        }
+
+        ck_assert(a.size() == total);
+        /* first page + 64K, 128K, 256K, 512K, 1M instead of 16 64K pages */
+        ck_assert_msg(a.count() == 6, "count: %zu", a.count());
+
+        if (0 == trx)
+        {
+            first_pages = pages;
+        }
+        else
+        {
+            /* page of each size class must have been reused */
+            for (size_t i(0); i < pages.size(); ++i)
+            {
+                ck_assert(std::find(first_pages.begin(), first_pages.end(),
+                                    pages[i]) != first_pages.end());
+            }
+        }
+    }
+
+    gu::Allocator::arena(old);
+}
+
+START_TEST (arena)
+{
+    ck_assert(gu::Allocator::arena("thp") == gu::Allocator::ARENA_THP);
+    ck_assert(gu::Allocator::arena("NONE") == gu::Allocator::ARENA_NONE);
+    try
+    {
+        gu::Allocator::arena("huge");
+        ck_abort_msg("exception expected");
+    }
+    catch (gu::Exception& e)
+    {
+        ck_assert(EINVAL == e.get_errno());
+    }
+
+    test_arena(gu::Allocator::ARENA_THP);
+    test_arena(gu::Allocator::ARENA_HUGETLB); // falls back to THP
+}
+END_TEST
+
+/* pages kept by many threads must not exceed the global cap */
+START_TEST (arena_cap)
+{
+    gu::Allocator::Arena const old(gu::Allocator::arena());
+    gu::Allocator::arena(gu::Allocator::ARENA_THP);
+
+    size_t const base(gu::Allocator::cached_size());
+    size_t const threads(24); /* 4M each, exceeds the cap */
+    size_t released(0);
+    bool   done(false);
+    std::mutex mtx;
+    std::condition_variable cond;
+
+    std::vector<std::thread> thr;
+    for (size_t i(0); i < threads; ++i)
+    {
+        thr.push_back(std::thread([&]()
+        {
+            {
+                TestBaseName test_name("gu_alloc_test");
+                size_t const total(4 << 20);
+                gu::Allocator a(test_name, NULL, 0, total * 2, 1 << 16);
+                for (size_t s(0); s < total; s += (1 << 12))
+                {
+                    bool n;
+                    ck_assert(0 != a.alloc(1 << 12, n));
+                }
+            }
+            std::unique_lock<std::mutex> lock(mtx);
+            ++released;
+            cond.notify_all();
+            while (!done) cond.wait(lock);
+        }));
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (released < threads) cond.wait(lock);
+
+        size_t const cached(gu::Allocator::cached_size());
+        ck_assert_msg(cached > base, "cached: %zu", cached);
+        ck_assert_msg(cached <= 32 * gu::Allocator::HUGE_PAGE_SIZE,
+                      "cached: %zu", cached);
+
+        done = true;
+        cond.notify_all();
+    }
+
+    for (size_t i(0); i < thr.size(); ++i) thr[i].join();
+
+    /* released at thread exit */
+    ck_assert(gu::Allocator::cached_size() == base);
+
+    gu::Allocator::arena(old);
+}
+END_TEST
+
 Suite* gu_alloc_suite ()
 {
     TCase* t = tcase_create ("Allocator");
     tcase_add_test (t, basic);
+    tcase_add_test (t, arena);
+    tcase_add_test (t, arena_cap);
 
     Suite* s = suite_create ("gu::Allocator");
     suite_add_tcase (s, t);
@@ -12,6 +12,7 @@
 
 #include <iterator>
 #include <sys/socket.h> // recv(), send(), etc.
+#include <unistd.h>     // write(), unlink()
 
 //
 // Helper classes
@@ -1055,6 +1056,37 @@ START_TEST(test_tcp_get_tcp_info)
 }
 END_TEST
 
+START_TEST(test_tcp_sendfile)
+{
+    gu::AsioIoService io_service;
+    gu::URI uri("tcp://127.0.0.1:0");
+    auto acceptor(io_service.make_acceptor(uri));
+    acceptor->listen(uri);
+    auto socket(io_service.make_socket(acceptor->listen_addr()));
+    socket->connect(acceptor->listen_addr());
+    auto accepted_socket(acceptor->accept());
+
+    char name[] = "gu_asio_test_sendfile.XXXXXX";
+    int const fd(::mkstemp(name));
+    ck_assert(fd >= 0);
+    ::unlink(name);
+    const char* data("hdrdata");
+    ck_assert(::write(fd, data, strlen(data)) == ssize_t(strlen(data)));
+
+    size_t const sent(socket->sendfile(fd, 3, 4));
+#if defined(__linux__)
+    ck_assert(sent == 4);
+    char read_buf[4] = {0};
+    ck_assert(accepted_socket->read(
+                  gu::AsioMutableBuffer(read_buf, sizeof(read_buf))) == 4);
+    ck_assert(strncmp(read_buf, "data", sizeof(read_buf)) == 0);
+#else
+    ck_assert(sent == 0);
+#endif
+    ::close(fd);
+}
+END_TEST
+
 #ifdef GALERA_HAVE_SSL
 
 #include <openssl/bn.h>
@@ -2563,6 +2595,10 @@ Suite* gu_asio_suite()
     tcase_add_test(tc, test_tcp_get_tcp_info);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_tcp_sendfile");
+    tcase_add_test(tc, test_tcp_sendfile);
+    suite_add_tcase(s, tc);
+
 #ifdef GALERA_HAVE_SSL
     //
     // SSL
@@ -138,6 +138,46 @@ START_TEST(test_gu_crc32c_x86_64)
     test_function();
 }
 END_TEST
+
+/* compares gu_crc32c_func to slicing-by-8 on buffers long enough for
+ * interleaved implementations */
+static void
+test_long_function(void)
+{
+    static uint8_t input[3*3*4096 + 3*3*256 + 64];
+    static size_t const lengths[] =
+    {
+        0, 1, 767, 768, 769, 3*4096 - 1, 3*4096, 3*4096 + 1,
+        3*4096 + 3*256 + 7, sizeof(input) - 8
+    };
+    size_t i, off;
+
+    for (i = 0; i < sizeof(input); ++i) input[i] = (uint8_t)(i * 131 + 7);
+
+    for (i = 0; i < sizeof(lengths)/sizeof(lengths[0]); ++i)
+    {
+        for (off = 0; off < 8; ++off)
+        {
+            gu_crc32c_t const exp =
+                gu_crc32c_slicing_by_8(GU_CRC32C_INIT, input + off, lengths[i]);
+            gu_crc32c_t const got =
+                gu_crc32c_func(GU_CRC32C_INIT, input + off, lengths[i]);
+
+            ck_assert_msg(exp == got,
+                          "Length %zu, offset %zu: got %#08x, expected %#08x",
+                          lengths[i], off, got, exp);
+        }
+    }
+}
+
+START_TEST(test_gu_crc32c_x86_64_3way)
+{
+    /* tables are initialized by gu_crc32c_configure() in the suite */
+    gu_crc32c_func = gu_crc32c_x86_64_3way;
+    test_function();
+    test_long_function();
+}
+END_TEST
 #endif /* GU_CRC32C_X86_64 */
 #endif /* GU_CRC32C_X86 */
 
@@ -174,6 +214,7 @@ Suite *gu_crc32c_suite(void)
     tcase_add_test  (t, test_gu_crc32c_x86);
 #if defined(GU_CRC32C_X86_64)
     tcase_add_test  (t, test_gu_crc32c_x86_64);
+    tcase_add_test  (t, test_gu_crc32c_x86_64_3way);
 #endif /* GU_CRC32C_X86_64 */
 #endif /* GU_CRC32C_X86 */
 
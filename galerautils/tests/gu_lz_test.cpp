@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+#include "../src/gu_lz.hpp"
+#include "../src/gu_exception.hpp"
+#include "../src/gu_logger.hpp"
+
+#include "gu_lz_test.hpp"
+
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+static void
+lz_round_trip(const std::vector<gu::byte_t>& src, bool const compressible)
+{
+    std::vector<gu::byte_t> cmp(gu::lz_bound(src.size()));
+
+    size_t const csize(gu::lz_compress(&src[0], src.size(),
+                                       &cmp[0], cmp.size()));
+    ck_assert(csize > 0);
+    ck_assert(csize <= cmp.size());
+    if (compressible) ck_assert_msg(csize < src.size() / 2,
+                                    "%zu not compressed enough: %zu",
+                                    src.size(), csize);
+
+    std::vector<gu::byte_t> dcmp(src.size() + 1);
+    size_t const dsize(gu::lz_decompress(&cmp[0], csize,
+                                         &dcmp[0], dcmp.size()));
+    ck_assert_msg(dsize == src.size(), "expected %zu, got %zu",
+                  src.size(), dsize);
+    ck_assert(0 == ::memcmp(&src[0], &dcmp[0], dsize));
+
+    /* too small output buffer must be detected */
+    if (src.size() > 0)
+    {
+        try
+        {
+            gu::lz_decompress(&cmp[0], csize, &dcmp[0], src.size() - 1);
+            ck_abort_msg("Overflow not detected");
+        }
+        catch (gu::Exception& e) {}
+    }
+}
+
+START_TEST(test_lz_round_trip)
+{
+    std::vector<gu::byte_t> buf;
+
+    /* short inputs are stored as literals */
+    for (size_t i(0); i < 20; ++i)
+    {
+        buf.resize(i + 1, 'a' + i);
+        lz_round_trip(buf, false);
+    }
+
+    /* repetitive input with short and long period */
+    buf.resize(100000);
+    for (size_t i(0); i < buf.size(); ++i) buf[i] = i % 3;
+    lz_round_trip(buf, true);
+
+    for (size_t i(0); i < buf.size(); ++i) buf[i] = "row data, id="[i % 13];
+    lz_round_trip(buf, true);
+
+    /* random input should grow at most by lz_bound() */
+    ::srand(42);
+    for (size_t i(0); i < buf.size(); ++i) buf[i] = ::rand();
+    lz_round_trip(buf, false);
+
+    /* incompressible input should be rejected with smaller output */
+    std::vector<gu::byte_t> cmp(buf.size());
+    ck_assert(0 == gu::lz_compress(&buf[0], buf.size(), &cmp[0], cmp.size()));
+}
+END_TEST
+
+START_TEST(test_lz_corrupt)
+{
+    std::vector<gu::byte_t> buf(4096);
+    for (size_t i(0); i < buf.size(); ++i) buf[i] = i % 7;
+
+    std::vector<gu::byte_t> cmp(gu::lz_bound(buf.size()));
+    size_t const csize(gu::lz_compress(&buf[0], buf.size(),
+                                       &cmp[0], cmp.size()));
+    ck_assert(csize > 0);
+
+    std::vector<gu::byte_t> dcmp(buf.size());
+
+    /* truncated stream must never produce the original size silently */
+    for (size_t i(1); i < csize; ++i)
+    {
+        try
+        {
+            size_t const ret(gu::lz_decompress(&cmp[0], i,
+                                               &dcmp[0], dcmp.size()));
+            ck_assert(ret < buf.size());
+        }
+        catch (gu::Exception& e) {}
+    }
+
+    /* offset pointing before the beginning of the output */
+    gu::byte_t const bad[] = { 0x10, 'x', 0x02, 0x00 };
+    try
+    {
+        gu::lz_decompress(bad, sizeof(bad), &dcmp[0], dcmp.size());
+        ck_abort_msg("Invalid offset not detected");
+    }
+    catch (gu::Exception& e) {}
+}
+END_TEST
+
+Suite* gu_lz_suite()
+{
+    TCase* t = tcase_create ("test_lz");
+    tcase_add_test (t, test_lz_round_trip);
+    tcase_add_test (t, test_lz_corrupt);
+
+    Suite* s = suite_create ("gu::lz");
+    suite_add_tcase (s, t);
+
+    return s;
+}
@@ -0,0 +1,12 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+#ifndef __gu_lz_test__
+#define __gu_lz_test__
+
+#include <check.h>
+
+extern Suite *gu_lz_suite(void);
+
+#endif // __gu_lz_test__
@@ -229,6 +229,59 @@ START_TEST (gu_mmh128_partial)
 }
 END_TEST
 
+/* Tests that batch hashing is identical to hashing contexts one by one */
+START_TEST (gu_mmh128_batch)
+{
+#define NUM_BATCH_CTX 37 /* several SIMD batches and a remainder */
+    gu_mmh128_ctx_t ctx[NUM_BATCH_CTX];
+    const gu_mmh128_ctx_t* ptr[NUM_BATCH_CTX];
+    hash128_t exp[NUM_BATCH_CTX];
+    hash128_t got[NUM_BATCH_CTX];
+    uint8_t   msg[2 * NUM_BATCH_CTX];
+    int i, n;
+
+    for (i = 0; i < (int)sizeof(msg); ++i) msg[i] = (uint8_t)(i * 37 + 11);
+
+    for (i = 0; i < NUM_BATCH_CTX; ++i)
+    {
+        /* all tail lengths, with leftovers of longer tails in the context */
+        gu_mmh128_init (&ctx[i]);
+        gu_mmh128_append (&ctx[i], msg, 15);
+        gu_mmh128_init (&ctx[i]);
+        gu_mmh128_append (&ctx[i], msg + i, i / 2);
+        gu_mmh128_append (&ctx[i], msg + i + i / 2, i - i / 2);
+        ptr[i] = &ctx[i];
+        gu_mmh128_get (&ctx[i], &exp[i]);
+    }
+
+    gu_mmh128_configure();
+
+    for (n = 0; n <= NUM_BATCH_CTX; ++n)
+    {
+        memset (got, 0, sizeof(got));
+        gu_mmh128_get_batch (ptr, n, got);
+        for (i = 0; i < n; ++i)
+        {
+            ck_assert_msg(!check(&exp[i], &got[i], sizeof(got[i])),
+                          "gu_mmh128_get_batch() failed at %d of %d", i, n);
+        }
+
+        /* unaligned start */
+        if (n < NUM_BATCH_CTX)
+        {
+            gu_mmh128_get_batch (ptr + 1, n, got);
+            for (i = 0; i < n; ++i)
+            {
+                ck_assert_msg(!check(&exp[i + 1], &got[i], sizeof(got[i])),
+                              "gu_mmh128_get_batch() failed at %d of %d+1",
+                              i, n);
+            }
+        }
+    }
+#undef NUM_BATCH_CTX
+}
+END_TEST
+
 Suite *gu_mmh3_suite(void)
 {
   Suite *s  = suite_create("MurmurHash3");
@@ -239,6 +292,7 @@ Suite *gu_mmh3_suite(void)
 //  tcase_add_test (tc, gu_mmh128_x86_test);
   tcase_add_test (tc, gu_mmh128_x64_test);
   tcase_add_test (tc, gu_mmh128_partial);
+  tcase_add_test (tc, gu_mmh128_batch);
 
   return s;
 }
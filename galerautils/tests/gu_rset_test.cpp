@@ -126,9 +126,10 @@ START_TEST (empty)
 END_TEST
 
 static void
-test_version (gu::RecordSet::Version version)
+test_version (gu::RecordSet::Version version,
+              gu::RecordSet::CheckType ct = gu::RecordSet::CHECK_MMH64)
 {
-    int const alignment(gu::RecordSet::VER2 == version ?
+    int const alignment(gu::RecordSet::VER2 <= version ?
                         gu::RecordSet::VER2_ALIGNMENT : 1);
     size_t const MB = 1 << 20;
 
@@ -158,7 +159,7 @@ test_version (gu::RecordSet::Version version)
     os << "gu_rset_test_ver" << version;
     TestBaseName str(os.str().c_str());
     gu::RecordSetOut<TestRecord> rset_out(reserved.buf, sizeof(reserved), str,
-                                          gu::RecordSet::CHECK_MMH64, version);
+                                          ct, version);
 
     size_t offset(rset_out.size());
     ck_assert(1 == rset_out.page_count());
@@ -424,6 +425,19 @@ START_TEST (ver2)
 }
 END_TEST
 
+START_TEST (ver3)
+{
+    test_version(gu::RecordSet::VER3);
+}
+END_TEST
+
+START_TEST (ver3_crc32c)
+{
+    gu_crc32c_configure(); // select CRC-32C implementation
+    test_version(gu::RecordSet::VER3, gu::RecordSet::CHECK_CRC32C);
+}
+END_TEST
+
 /* This test is to test how padding mixes with persistent (stored outside)
  * pages. In this case new padding buf needs to be allocated */
 static void
@@ -608,5 +622,10 @@ Suite* gu_rset_suite ()
     suite_add_tcase (s, t);
 //    tcase_set_timeout(t, 60);
 
+    t = tcase_create("RecordSet v3");
+    tcase_add_test (t, ver3);
+    tcase_add_test (t, ver3_crc32c);
+    suite_add_tcase (s, t);
+
     return s;
 }
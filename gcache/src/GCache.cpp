@@ -7,9 +7,12 @@
 
 #include <gu_logger.hpp>
 #include "gu_thread_keys.hpp"
+#include <gu_utils.hpp> // gu::to_string()
+#include <gu_time.h>
 
 #include <cerrno>
 #include <unistd.h>
+#include <sys/resource.h> // getrusage()
 
 namespace gcache
 {
@@ -66,7 +69,8 @@ namespace gcache
         gid       (),
         mem       (params.mem_size(), seqno2ptr, params.debug()),
         rb        (pcb, params.rb_name(), params.rb_size(), seqno2ptr, gid,
-                   params.debug(), recover_rb(encrypt_cb, params.recover())),
+                   params.debug(), recover_rb(encrypt_cb, params.recover()),
+                   params.map_opts()),
         ps        (params.dir_name(),
                    encrypt_cb,
                    app_ctx,
@@ -75,7 +79,9 @@ namespace gcache
                    params.keep_plaintext_size(),
                    params.debug(),
                    /* keep last page if PS is the only storage */
-                   !((params.mem_size() + params.rb_size()) > 0)),
+                   !((params.mem_size() + params.rb_size()) > 0),
+                   params.page_prealloc(),
+                   params.map_opts()),
         mallocs   (0),
         reallocs  (0),
         frees     (0),
@@ -84,11 +90,22 @@ namespace gcache
         seqno_released(seqno_max),
         seqno_locked  (SEQNO_MAX),
         seqno_locked_count(0),
-        encrypt_cache (NULL != encrypt_cb)
+        encrypt_cache (NULL != encrypt_cb),
+        recv_thread   (),
+        recv_thread_set(false),
+        recv_mallocs  (0),
+        recv_faults_minor(0),
+        recv_faults_major(0),
+        map_status_mtx(gu::get_mutex_key(gu::GU_MUTEX_KEY_GCACHE_MAP_STATUS)),
+        map_status_time(0),
+        resident_bytes(0),
+        hugepage_bytes(0)
 #ifndef NDEBUG
         ,buf_tracker()
 #endif
-    {}
+    {
+        mem.set_rb(&rb);
+    }
 
     GCache::~GCache ()
     {
@@ -108,6 +125,122 @@ namespace gcache
         ps.set_enc_key(k);
     }
 
+    void GCache::recv_thread_init()
+    {
+        {
+            gu::Lock lock(mtx);
+            recv_thread     = pthread_self();
+            recv_thread_set = true;
+        }
+
+        if (!params.numa_bind()) return;
+
+        int const node(gu::numa_node());
+        if (node < 0)
+        {
+            log_warn << "GCache: failed to determine NUMA node of the "
+                     << "receive thread, not binding.";
+            return;
+        }
+
+        /* new page cache pages follow the policy of the faulting thread */
+        gu::numa_prefer(node);
+
+        {
+            gu::Lock lock(mtx);
+            ps.set_numa_node(node);
+        }
+
+        /* Ring buffer is mapped for the lifetime of GCache, so migration of
+         * its (possibly many gigabytes of) resident pages does not need to
+         * block other users of the cache. */
+        rb.mmap().bind(node);
+
+        log_info << "GCache: bound to NUMA node " << node;
+    }
+
+    void GCache::sample_recv_faults()
+    {
+        assert(mtx.locked() && mtx.owned());
+
+#if defined(RUSAGE_THREAD)
+        if (0 == (++recv_mallocs % RECV_FAULTS_INTERVAL))
+        {
+            struct rusage ru;
+            if (0 == ::getrusage(RUSAGE_THREAD, &ru))
+            {
+                recv_faults_minor = ru.ru_minflt;
+                recv_faults_major = ru.ru_majflt;
+            }
+        }
+#endif /* RUSAGE_THREAD */
+    }
+
+    void GCache::map_status(gu::Status& status) const
+    {
+        gu::MemRanges ranges;
+        size_t locked(0);
+        long long faults_minor, faults_major;
+        bool recv_set;
+        {
+            gu::Lock lock(mtx);
+
+            faults_minor = recv_faults_minor;
+            faults_major = recv_faults_major;
+            recv_set     = recv_thread_set;
+
+            const gu::MMap& rb_map(rb.mmap());
+            ranges.push_back(gu::MemRanges::value_type(rb_map.ptr,
+                                                       rb_map.size));
+            if (rb_map.locked()) locked += rb_map.size;
+
+            ps.mem_ranges(ranges, locked);
+        }
+
+        size_t mapped(0);
+        for (size_t i(0); i < ranges.size(); ++i) mapped += ranges[i].second;
+
+        status.insert("gcache_mapped_bytes", gu::to_string(mapped));
+        status.insert("gcache_locked_bytes", gu::to_string(locked));
+
+        if (recv_set)
+        {
+            status.insert("gcache_recv_faults_minor",
+                          gu::to_string(faults_minor));
+            status.insert("gcache_recv_faults_major",
+                          gu::to_string(faults_major));
+        }
+
+        const MapOptions& mo(params.map_opts());
+        if (mo.hugepages || mo.populate || mo.lock || params.numa_bind())
+        {
+            gu::Lock lock(map_status_mtx);
+
+            long long const now(gu_time_monotonic());
+            if (0 == map_status_time ||
+                now - map_status_time >= MAP_STATUS_INTERVAL)
+            {
+                /* pages may get unmapped meanwhile, then they just don't
+                 * count */
+                size_t resident(0);
+                for (size_t i(0); i < ranges.size(); ++i)
+                {
+                    resident += gu::mem_resident(ranges[i].first,
+                                                 ranges[i].second);
+                }
+
+                resident_bytes  = resident;
+                hugepage_bytes  = gu::mem_huge(ranges);
+                map_status_time = now;
+            }
+
+            status.insert("gcache_resident_bytes",
+                          gu::to_string(resident_bytes));
+            status.insert("gcache_hugepage_bytes",
+                          gu::to_string(hugepage_bytes));
+        }
+    }
+
     std::string GCache::meta(const void* ptr)
     {
         std::ostringstream os;
@@ -180,3 +313,9 @@ int64_t gcache_seqno_min (gcache_t* gc)
     gcache::GCache* gcache = reinterpret_cast<gcache::GCache*>(gc);
     return gcache->seqno_min ();
 }
+
+void gcache_recv_thread_init (gcache_t* gc)
+{
+    gcache::GCache* gcache = reinterpret_cast<gcache::GCache*>(gc);
+    gcache->recv_thread_init ();
+}
@@ -15,6 +15,7 @@
 #include <gu_lock.hpp> // for gu::Mutex and gu::Cond
 #include <gu_config.hpp>
 #include <gu_gtid.hpp>
+#include <gu_status.hpp>
 
 #include <wsrep_api.h> // encryption declarations
 
@@ -24,6 +25,7 @@
 #include <set>
 #endif
 #include <stdint.h>
+#include <pthread.h>
 
 namespace gcache
 {
@@ -59,6 +61,24 @@ namespace gcache
         /* Sets encryption key */
         void set_enc_key(const wsrep_enc_key_t& key);
 
+        /* Whether cache contents are encrypted */
+        bool encrypted() const { return encrypt_cache; }
+
+        /*!
+         * Called by the thread that receives actions into the cache (GCS
+         * receive thread) on start. If gcache.numa_bind is set, makes the
+         * thread prefer its NUMA node and migrates memory maps there.
+         */
+        void recv_thread_init();
+
+        /*!
+         * Adds memory map placement status: mapped, resident, locked and
+         * huge page backed bytes. Resident and huge page bytes are costly
+         * to compute, so they are reported only if any of gcache.hugepages,
+         * gcache.populate, gcache.mlock or gcache.numa_bind is set.
+         */
+        void map_status(gu::Status& status) const;
+
         /*!
          * Memory allocation methods
          *
@@ -168,7 +188,8 @@ namespace gcache
         {
         public:
 
-            Buffer() : seqno_g_(), ptr_(), size_(), skip_(), type_() { }
+            Buffer() : seqno_g_(), ptr_(), size_(), skip_(), type_(),
+                       fd_(-1), offset_(-1) { }
 
             Buffer (const Buffer& other)
                 :
@@ -176,7 +197,9 @@ namespace gcache
                 ptr_    (other.ptr_),
                 size_   (other.size_),
                 skip_   (other.skip_),
-                type_   (other.type_)
+                type_   (other.type_),
+                fd_     (other.fd_),
+                offset_ (other.offset_)
             { }
 
             Buffer& operator= (const Buffer& other)
@@ -186,6 +209,8 @@ namespace gcache
                 size_    = other.size_;
                 skip_    = other.skip_;
                 type_    = other.type_;
+                fd_      = other.fd_;
+                offset_  = other.offset_;
                 return *this;
             }
 
@@ -195,6 +220,12 @@ namespace gcache
             bool              skip()    const { return skip_;    }
             uint8_t           type()    const { return type_;    }
 
+            /* file that backs the buffer and the offset of ptr() in it,
+             * -1 if buffer contents can't be read from file directly
+             * (e.g. encrypted cache) */
+            int               fd()      const { return fd_;      }
+            off_t             offset()  const { return offset_;  }
+
         protected:
 
             void set_ptr   (const void* p)
@@ -208,6 +239,8 @@ namespace gcache
                 seqno_g_ = g; size_ = s; skip_ = skp, type_ = t;
             }
 
+            void set_file  (int fd, off_t off) { fd_ = fd; offset_ = off; }
+
         private:
 
             seqno_t           seqno_g_;
@@ -215,6 +248,8 @@ namespace gcache
             ssize_type        size_;
             bool              skip_;
             uint8_t           type_;
+            int               fd_;
+            off_t             offset_;
 
             friend class GCache;
         };
@@ -223,6 +258,8 @@ namespace gcache
          * Fills a vector with Buffer objects starting with seqno start
          * until either vector length or seqno map is exhausted.
          * Moves seqno lock to start.
+         * Unless the cache is encrypted, buffers stored in files get fd()
+         * and offset() set and readahead of them is started.
          *
          * @retval number of buffers filled (<= v.size())
          */
@@ -265,13 +302,17 @@ namespace gcache
             size_t page_size()           const { return page_size_;       }
             size_t keep_pages_size()     const { return keep_pages_size_; }
             size_t keep_plaintext_size() const { return keep_plaintext_size_;}
+            size_t page_prealloc()       const { return page_prealloc_;   }
             int    debug()               const { return debug_;           }
             bool   recover()             const { return recover_;         }
+            bool   numa_bind()           const { return numa_bind_;       }
+            const MapOptions& map_opts() const { return map_opts_;        }
 
             void mem_size        (size_t s) { mem_size_        = s; }
             void page_size       (size_t s) { page_size_       = s; }
             void keep_pages_size (size_t s) { keep_pages_size_ = s; }
             void keep_plaintext_size (size_t s) { keep_plaintext_size_ = s; }
+            void page_prealloc   (size_t n) { page_prealloc_   = n; }
 #ifndef NDEBUG
             void debug           (int    d) { debug_           = d; }
 #endif
@@ -285,8 +326,11 @@ namespace gcache
             size_t            page_size_;
             size_t            keep_pages_size_;
             size_t            keep_plaintext_size_;
+            size_t            page_prealloc_;
             int               debug_;
             bool        const recover_;
+            bool        const numa_bind_;
+            MapOptions        map_opts_;
         }
             params;
 
@@ -311,6 +355,27 @@ namespace gcache
 
         bool const      encrypt_cache;
 
+        /* page faults taken by the receive thread, these are mostly first
+         * touches of cache memory, sampled every RECV_FAULTS_INTERVAL
+         * receive thread mallocs */
+        static int const RECV_FAULTS_INTERVAL = 64;
+        pthread_t       recv_thread;
+        bool            recv_thread_set;
+        long long       recv_mallocs;
+        long long       recv_faults_minor;
+        long long       recv_faults_major;
+
+        void sample_recv_faults();
+
+        /* resident and huge page sizes take a walk over all cache memory
+         * to compute, so they are refreshed at most every
+         * MAP_STATUS_INTERVAL and cached values are reported in between */
+        static long long const MAP_STATUS_INTERVAL = 10000000000LL; // 10s
+        gu::Mutex mutable map_status_mtx;
+        long long mutable map_status_time;
+        size_t    mutable resident_bytes;
+        size_t    mutable hugepage_bytes;
+
 #ifndef NDEBUG
         std::set<const void*> buf_tracker;
 #endif
@@ -330,7 +395,8 @@ namespace gcache
         /* change == true will mark plaintext as changed */
         BufferHeader* get_BH(const void* ptr, bool change = false)
         {
-            return encrypt_cache ? ps.get_BH(ptr, change) : ptr2BH(ptr);
+            return encrypt_cache ? ps.get_BH(ptr, change) :
+                rb.revive(ptr2BH(ptr));
         }
 
         void discard_buffer (BufferHeader* bh, const void* ptr);
@@ -348,6 +414,15 @@ namespace gcache
         /* discards all seqnos greater than s */
         void discard_tail (seqno_t s);
 
+        /* sets file and offset of the first found buffers that are in maps,
+         * must be called under mtx */
+        static void set_files (std::vector<Buffer>& v, size_t found,
+                               const FileMaps& maps);
+
+        /* starts readahead of the first found buffers set by set_files() */
+        static void will_need (const std::vector<Buffer>& v, size_t found,
+                               const FileMaps& maps);
+
         // disable copying
         GCache (const GCache&);
         GCache& operator = (const GCache&);
@@ -182,6 +182,11 @@ namespace gcache
 
             mallocs++;
 
+            if (recv_thread_set && pthread_equal(recv_thread, pthread_self()))
+            {
+                sample_recv_faults();
+            }
+
             if (!encrypt_cache)
             {
                 ptr = mem.malloc(size);
@@ -7,6 +7,7 @@
 
 #include <cerrno>
 #include <cassert>
+#include <algorithm>
 
 #include <sched.h> // sched_yeild()
 
@@ -362,6 +363,7 @@ namespace gcache
         assert (max > 0);
 
         size_t found(0);
+        FileMaps maps;
 
         {
             gu::Lock lock(mtx);
@@ -381,8 +383,21 @@ namespace gcache
                 while (++found < max && ++p != seqno2ptr.end() && *p);
                 /* the last condition ensures seqno continuty, #643 */
             }
+
+            /* Encrypted buffers are decrypted into plaintext cache,
+             * file contents are of no use to the reader then. Maps must be
+             * matched under the lock: pages may be discarded and their
+             * addresses reused once it is released. */
+            if (found > 0 && !encrypt_cache)
+            {
+                maps.push_back(FileMap(rb.mmap(), rb.fd()));
+                ps.file_maps(maps);
+                set_files(v, found, maps);
+            }
         }
 
+        if (!maps.empty()) will_need(v, found, maps);
+
         // the following may cause IO
         for (size_t i(0); i < found; ++i)
         {
@@ -400,6 +415,74 @@ namespace gcache
         return found;
     }
 
+    void
+    GCache::set_files(std::vector<Buffer>& v, size_t const found,
+                      const FileMaps& maps)
+    {
+        size_t m(0); // consecutive buffers are likely to be in the same map
+
+        for (size_t i(0); i < found; ++i)
+        {
+            const gu::byte_t* const ptr(v[i].ptr());
+
+            if (!maps[m].contains(ptr))
+            {
+                for (m = 0; m < maps.size() && !maps[m].contains(ptr); ++m) {}
+
+                if (m == maps.size()) // BUFFER_IN_MEM
+                {
+                    m = 0;
+                    continue;
+                }
+            }
+
+            v[i].set_file(maps[m].fd, ptr - maps[m].ptr);
+        }
+    }
+
+    void
+    GCache::will_need(const std::vector<Buffer>& v, size_t const found,
+                      const FileMaps& maps)
+    {
+        /* Buffer sizes are not known yet, so the last buffer of a run gets
+         * a fixed tail. Runs are cut at map boundaries and where addresses
+         * go back (ring buffer wrap), total advice is capped to not evict
+         * what has not been sent yet. */
+        static size_t const TAIL (1 << 16);
+        static size_t const LIMIT(1 << 27);
+
+        size_t total(0);
+        size_t i(0);
+
+        while (i < found && total < LIMIT)
+        {
+            if (v[i].fd() < 0) { ++i; continue; }
+
+            const gu::byte_t* const begin(v[i].ptr() - sizeof(BufferHeader));
+            const gu::byte_t* last(v[i].ptr());
+
+            for (++i; i < found && v[i].fd() == v[i - 1].fd() &&
+                     v[i].offset() > v[i - 1].offset(); ++i)
+            {
+                last = v[i].ptr();
+            }
+
+            const gu::byte_t* end(last + TAIL);
+            for (size_t m(0); m < maps.size(); ++m)
+            {
+                if (maps[m].contains(last))
+                {
+                    end = std::min(end, maps[m].ptr + maps[m].size);
+                    break;
+                }
+            }
+
+            size_t const size(std::min<size_t>(end - begin, LIMIT - total));
+            gu::mem_will_need(begin, size);
+            total += size;
+        }
+    }
+
     /*!
      * Releases any history locks present.
      */
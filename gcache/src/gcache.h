@@ -34,6 +34,8 @@ extern       void  gcache_drop_plaintext  (gcache_t* gc, const void* ptr);
 
 extern int64_t gcache_seqno_min (gcache_t* gc);
 
+extern void    gcache_recv_thread_init (gcache_t* gc);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+/*! @file memory map placement options shared by ring buffer and pages */
+
+#ifndef _gcache_map_opts_hpp_
+#define _gcache_map_opts_hpp_
+
+#include <gu_mmap.hpp>
+
+#include <vector>
+
+namespace gcache
+{
+    struct MapOptions
+    {
+        MapOptions() : hugepages(false), populate(false), lock(false),
+                       node(-1)
+        {}
+
+        bool hugepages; /* MADV_HUGEPAGE */
+        bool populate;  /* prefault on creation */
+        bool lock;      /* mlock() */
+        int  node;      /* preferred NUMA node, -1 - none */
+
+        /* Applies options to a fresh map. Huge page advice must precede
+         * prefaulting, otherwise the map is populated with small pages. */
+        void apply(gu::MMap& mmap) const
+        {
+            if (hugepages) mmap.advise_hugepages();
+            if (node >= 0) mmap.bind(node);
+            if (lock)      mmap.lock(); /* faults in the whole map */
+            else if (populate) mmap.populate();
+        }
+    };
+
+    /* file backed map, lets readers go to the file directly */
+    struct FileMap
+    {
+        FileMap(const gu::MMap& mmap, int const f)
+            : ptr(static_cast<const uint8_t*>(mmap.ptr)), size(mmap.size),
+              fd(f)
+        {}
+
+        bool contains(const void* const p) const
+        {
+            const uint8_t* const b(static_cast<const uint8_t*>(p));
+            return (b >= ptr && b < ptr + size);
+        }
+
+        const uint8_t* ptr;
+        size_t         size;
+        int            fd;
+    };
+
+    typedef std::vector<FileMap> FileMaps;
+}
+
+#endif /* _gcache_map_opts_hpp_ */
@@ -4,6 +4,7 @@
 
 #include "gcache_mem_store.hpp"
 #include "gcache_page_store.hpp"
+#include "gcache_rb_store.hpp"
 
 #include <gu_logger.hpp>
 
@@ -18,6 +19,8 @@ MemStore::have_free_space (size_type size)
         /* try to free some released bufs */
         BufferHeader* const bh(ptr2BH(seqno2ptr_.front()));
 
+        if (rb_) rb_->revive(bh);
+
         if (BH_is_released(bh)) /* discard buffer */
         {
             seqno2ptr_.pop_front();
@@ -17,6 +17,8 @@
 
 namespace gcache
 {
+    class RingBuffer;
+
     class MemStore : public MemOps
     {
     public:
@@ -26,9 +28,13 @@ namespace gcache
               size_     (0),
               allocd_   (),
               seqno2ptr_(seqno2ptr),
+              rb_       (NULL),
               debug_    (dbg & DEBUG)
         {}
 
+        /* ring buffer to take over its buffers found in seqno2ptr */
+        void set_rb(RingBuffer* const rb) { rb_ = rb; }
+
         void reset ()
         {
             for (std::set<void*>::iterator buf(allocd_.begin());
@@ -166,6 +172,7 @@ namespace gcache
         size_t          size_;
         std::set<void*> allocd_;
         seqno2ptr_t&    seqno2ptr_;
+        RingBuffer*     rb_;
         int             debug_;
     };
 }
@@ -100,7 +100,8 @@ gcache::Page::Page (void*              ps,
                     const EncKey&      key,
                     const Nonce&       nonce,
                     size_t size,
-                    int dbg)
+                    int dbg,
+                    const MapOptions& map_opts)
     :
     fd_   (name, aligned_size(size), true, false),
     mmap_ (fd_),
@@ -112,6 +113,8 @@ gcache::Page::Page (void*              ps,
     used_ (0),
     debug_(dbg)
 {
+    map_opts.apply(mmap_);
+
     size_type const nonce_size(Page::aligned_size(nonce_.write(next_, space_)));
     next_  += nonce_size;
     space_ -= nonce_size;
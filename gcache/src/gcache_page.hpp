@@ -9,6 +9,7 @@
 
 #include "gcache_memops.hpp"
 #include "gcache_bh.hpp"
+#include "gcache_map_opts.hpp"
 
 #include "gu_fdesc.hpp"
 #include "gu_mmap.hpp"
@@ -57,7 +58,8 @@ namespace gcache
               const EncKey&      key,
               const Nonce&       nonce,
               size_t             size,
-              int                dbg);
+              int                dbg,
+              const MapOptions&  map_opts = MapOptions());
 
         ~Page () {}
 
@@ -162,6 +164,10 @@ namespace gcache
 
         void set_debug(int const dbg) { debug_ = dbg; }
 
+        gu::MMap&       mmap()       { return mmap_; }
+        const gu::MMap& mmap() const { return mmap_; }
+        int             fd()   const { return fd_.get(); }
+
         static const size_type ALIGNMENT = 16;
         /* typical encryption block size */
 
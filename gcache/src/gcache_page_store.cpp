@@ -10,17 +10,21 @@
 
 #include <gu_logger.hpp>
 #include <gu_throw.hpp>
+#include <gu_thread_keys.hpp>
 
 #include <cstdio>
 #include <cstring>
-#include <pthread.h>
 
 #include <iomanip>
 
 static const std::string base_name ("gcache.page.");
+/* spare files must not match page file name pattern, so that they are never
+ * mistaken for pages holding data */
+static const std::string spare_base_name ("gcache.spare.");
 
 static std::string
-make_base_name (const std::string& dir_name)
+make_base_name (const std::string& dir_name,
+                const std::string& base_name = ::base_name)
 {
     if (dir_name.empty())
     {
@@ -47,33 +51,20 @@ make_page_name (const std::string& base_name, size_t count)
     return os.str();
 }
 
-static void*
-remove_file (void* __restrict__ arg)
+static void
+remove_file (const std::string& file_name)
 {
-    char* const file_name (static_cast<char*>(arg));
-
-    if (NULL != file_name)
+    if (remove (file_name.c_str()))
     {
-        if (remove (file_name))
-        {
-            int err = errno;
-
-            log_error << "Failed to remove page file '" << file_name << "': "
-                      << err << " (" << strerror(err) << ")";
-        }
-        else
-        {
-            log_info << "Deleted page " << file_name;
-        }
+        int err = errno;
 
-        free (file_name);
+        log_error << "Failed to remove page file '" << file_name << "': "
+                  << err << " (" << strerror(err) << ")";
     }
     else
     {
-        log_error << "Null file name in " << __FUNCTION__;
+        log_info << "Deleted page " << file_name;
     }
-
-    pthread_exit(NULL);
 }
 
 bool
@@ -85,29 +76,169 @@ gcache::PageStore::delete_page ()
 
     pages_.pop_front();
 
-    char* const file_name(strdup(page->name().c_str()));
-
     total_size_ -= page->size();
 
     if (current_ == page) current_ = 0;
 
-    delete page;
+    /* unmapping and file removal are left to the worker */
+    gu::Lock lock(work_mtx_);
+    work_delete_.push_back(page);
+    work_cond_.signal();
 
-#ifdef GCACHE_DETACH_THREAD
-    pthread_t delete_thr_;
-#else
-    if (delete_thr_ != pthread_t(-1)) pthread_join (delete_thr_, NULL);
-#endif /* GCACHE_DETACH_THERAD */
+    return true;
+}
 
-    int err = pthread_create (&delete_thr_, &delete_page_attr_, remove_file,
-                              file_name);
-    if (0 != err)
+void
+gcache::PageStore::claim_spare (const std::string& name)
+{
+    Spare spare;
     {
-        delete_thr_ = pthread_t(-1);
-        gu_throw_error(err) << "Failed to create page file deletion thread";
+        gu::Lock lock(work_mtx_);
+
+        if (!spare_active_)
+        {
+            /* page store is being used, start preparing spares */
+            spare_active_ = true;
+            work_cond_.signal();
+        }
+
+        if (spares_.empty()) return;
+
+        spare = spares_.front();
+        spares_.pop_front();
+        work_cond_.signal(); /* prepare a replacement */
     }
 
-    return true;
+    if (::rename(spare.first.c_str(), name.c_str()))
+    {
+        int const err(errno);
+        log_warn << "Failed to rename spare page file '" << spare.first
+                 << "' to '" << name << "': " << err << " (" << strerror(err)
+                 << ")";
+        ::unlink(spare.first.c_str());
+    }
+    else if (debug_)
+    {
+        log_info << "Using spare page file " << spare.first << " of size "
+                 << spare.second << " for " << name;
+    }
+}
+
+void*
+gcache::PageStore::worker_thread (void* arg)
+{
+    static_cast<PageStore*>(arg)->worker();
+    return NULL;
+}
+
+void
+gcache::PageStore::worker ()
+{
+    int node(-1);
+
+    for (;;)
+    {
+        Page*  page(NULL);
+        Spare  spare;
+        bool   prepare(false);
+        bool   drop(false);
+        int    new_node;
+        {
+            gu::Lock lock(work_mtx_);
+
+            for (;;)
+            {
+                if (!work_delete_.empty())
+                {
+                    page = work_delete_.front();
+                    work_delete_.pop_front();
+                    break;
+                }
+
+                if (work_stop_) return;
+
+                if (spares_.size() > prealloc_)
+                {
+                    spare = spares_.back();
+                    spares_.pop_back();
+                    drop = true;
+                    break;
+                }
+
+                if (spare_active_ && spares_.size() < prealloc_)
+                {
+                    spare.first  = make_page_name(spare_base_name_,
+                                                  spare_count_++);
+                    spare.second = spare_size_;
+                    prepare = true;
+                    break;
+                }
+
+                lock.wait(work_cond_);
+            }
+
+            new_node = spare_node_;
+        }
+
+        if (page)
+        {
+            std::string const file_name(page->name());
+            delete page;
+            remove_file(file_name);
+        }
+        else if (drop)
+        {
+            remove_file(spare.first);
+        }
+        else if (prepare)
+        {
+            if (new_node != node && new_node >= 0 && gu::numa_prefer(new_node))
+            {
+                node = new_node;
+            }
+
+            try
+            {
+                /* reuses a file left over from previous run if possible */
+                gu::FileDescriptor fd(spare.first, spare.second, true, false);
+                if (map_opts_.populate || map_opts_.lock)
+                {
+                    /* allocate page cache while we are at it */
+                    gu::MMap mmap(fd);
+                    mmap.populate();
+                }
+            }
+            catch (gu::Exception& e)
+            {
+                log_warn << "Failed to prepare spare page file: " << e.what();
+                ::unlink(spare.first.c_str());
+
+                gu::Lock lock(work_mtx_);
+                spare_active_ = false; /* retry with the next page */
+                continue;
+            }
+
+            gu::Lock lock(work_mtx_);
+            spares_.push_back(spare);
+        }
+    }
+}
+
+void
+gcache::PageStore::set_page_size (size_t const size)
+{
+    page_size_ = size;
+
+    gu::Lock lock(work_mtx_);
+    spare_size_ = size; /* spares of other sizes are adjusted on claim */
+}
+
+void
+gcache::PageStore::set_prealloc (size_t const n)
+{
+    gu::Lock lock(work_mtx_);
+    prealloc_ = n;
+    work_cond_.signal();
 }
 
 /* Deleting pages only from the beginning kinda means that some free pages
@@ -143,13 +274,17 @@ gcache::PageStore::new_page (size_type const size, const Page::EncKey& new_key)
     size_type const key_buf_size(BH_size(enc_key_.size()));
     size_type const meta_size(Page::meta_size(key_buf_size));
     size_type const min_size(meta_size + Page::aligned_size(size));
+    std::string const name(make_page_name(base_name_, count_));
+
+    claim_spare(name);
 
     Page* const page(new Page(this,
-                              make_page_name(base_name_, count_),
+                              name,
                               new_key,
                               nonce_,
                               page_size_ > min_size ? page_size_ : min_size,
-                              debug_));
+                              debug_,
+                              map_opts_));
 
     pages_.push_back (page);
     total_size_ += page->size();
@@ -202,9 +337,12 @@ gcache::PageStore::PageStore (const std::string&       dir_name,
                               size_t             const page_size,
                               size_t             const keep_plaintext_size,
                               int                const dbg,
-                              bool               const keep_page)
+                              bool               const keep_page,
+                              size_t             const prealloc,
+                              const MapOptions&        map_opts)
     :
     base_name_ (make_base_name(dir_name)),
+    spare_base_name_(make_base_name(dir_name, spare_base_name)),
     encrypt_cb_(encrypt_cb),
     app_ctx_   (app_ctx),
     enc_key_   (),
@@ -218,31 +356,28 @@ gcache::PageStore::PageStore (const std::string&       dir_name,
     total_size_(0),
     enc2plain_ (),
     plaintext_size_(0),
-    delete_page_attr_(),
-#ifndef GCACHE_DETACH_THREAD
-    delete_thr_(pthread_t(-1)),
-#endif /* GCACHE_DETACH_THREAD */
+    work_mtx_  (gu::get_mutex_key(gu::GU_MUTEX_KEY_GCACHE_PAGE_STORE)),
+    work_cond_ (gu::get_cond_key(gu::GU_COND_KEY_GCACHE_PAGE_STORE)),
+    work_delete_(),
+    spares_    (),
+    spare_count_(0),
+    spare_size_(page_size),
+    prealloc_  (prealloc),
+    spare_node_(-1),
+    spare_active_(false),
+    work_stop_ (false),
+    worker_thr_(),
+    map_opts_  (map_opts),
     debug_     (dbg & DEBUG),
     keep_page_ (keep_page)
 {
-    int err = pthread_attr_init (&delete_page_attr_);
-
+    int const err(gu_thread_create(
+                      gu::get_thread_key(gu::GU_THREAD_KEY_GCACHE_PAGE),
+                      &worker_thr_, worker_thread, this));
     if (0 != err)
     {
-        gu_throw_error(err) << "Failed to initialize page file deletion "
-                            << "thread attributes";
+        gu_throw_error(err) << "Failed to create page file worker thread";
     }
-
-#ifdef GCACHE_DETACH_THREAD
-    err = pthread_attr_setdetachstate (&delete_page_attr_,
-                                       PTHREAD_CREATE_DETACHED);
-    if (0 != err)
-    {
-        pthread_attr_destroy (&delete_page_attr_);
-        gu_throw_error(err) << "Failed to set DETACHED attribute to "
-                            << "page file deletion thread";
-    }
-#endif /* GCACHE_DETACH_THREAD */
 }
 
 void
@@ -305,9 +440,20 @@ gcache::PageStore::~PageStore ()
     try
     {
         while (pages_.size() && delete_page()) {};
-#ifndef GCACHE_DETACH_THREAD
-        if (delete_thr_ != pthread_t(-1)) pthread_join (delete_thr_, NULL);
-#endif /* GCACHE_DETACH_THREAD */
+
+        {
+            /* worker completes queued deletions before exiting */
+            gu::Lock lock(work_mtx_);
+            work_stop_ = true;
+            work_cond_.signal();
+        }
+        gu_thread_join(worker_thr_, NULL);
+
+        for (size_t i(0); i < spares_.size(); ++i)
+        {
+            remove_file(spares_[i].first);
+        }
+        spares_.clear();
     }
     catch (gu::Exception& e)
     {
@@ -338,8 +484,6 @@ gcache::PageStore::~PageStore ()
         delete *i;
     }
     pages_.clear();
-
-    pthread_attr_destroy (&delete_page_attr_);
 }
 
 inline void*
@@ -600,3 +744,34 @@ gcache::PageStore::set_debug(int const dbg)
         (*i)->set_debug(debug_);
     }
 }
+
+void
+gcache::PageStore::set_numa_node(int const node)
+{
+    map_opts_.node = node;
+
+    {
+        gu::Lock lock(work_mtx_);
+        spare_node_ = node;
+    }
+}
+
+void
+gcache::PageStore::mem_ranges(gu::MemRanges& ranges, size_t& locked) const
+{
+    for (PageQueue::const_iterator i(pages_.begin()); i != pages_.end(); ++i)
+    {
+        const gu::MMap& mmap((*i)->mmap());
+        ranges.push_back(gu::MemRanges::value_type(mmap.ptr, mmap.size));
+        if (mmap.locked()) locked += mmap.size;
+    }
+}
+
+void
+gcache::PageStore::file_maps(FileMaps& maps) const
+{
+    for (PageQueue::const_iterator i(pages_.begin()); i != pages_.end(); ++i)
+    {
+        maps.push_back(FileMap((*i)->mmap(), (*i)->fd()));
+    }
+}
@@ -12,6 +12,8 @@
 #include "gcache_seqno.hpp"
 
 #include <gu_macros.hpp> // GU_COMPILE_ASSERT
+#include <gu_lock.hpp>
+#include <gu_threads.h>
 
 #include <string>
 #include <deque>
@@ -34,7 +36,9 @@ namespace gcache
                    size_t             page_size,
                    size_t             plaintext_size,
                    int                dbg,
-                   bool               keep_page);
+                   bool               keep_page,
+                   size_t             prealloc = 0,
+                   const MapOptions&  map_opts = MapOptions());
 
         ~PageStore ();
 
@@ -84,7 +88,10 @@ namespace gcache
 
         void  set_enc_key(const Page::EncKey& key);
 
-        void  set_page_size (size_t size) { page_size_ = size; }
+        void  set_page_size (size_t size);
+
+        /* number of spare page files to keep ready */
+        void  set_prealloc  (size_t n);
 
         void  set_keep_size (size_t size) { keep_size_ = size; }
 
@@ -95,10 +102,26 @@ namespace gcache
 
         void  set_debug(int dbg);
 
+        /* binds future pages to NUMA node, existing pages are not migrated:
+         * that would take long under the lock, and they are released as
+         * the cache rolls over anyway */
+        void  set_numa_node(int node);
+
+        /* appends page memory ranges, adds locked bytes to locked */
+        void  mem_ranges(gu::MemRanges& ranges, size_t& locked) const;
+
+        /* appends page file maps */
+        void  file_maps(FileMaps& maps) const;
+
         /* for unit tests */
         size_t count()       const { return count_;        }
         size_t total_pages() const { return pages_.size(); }
         size_t total_size()  const { return total_size_;   }
+        size_t spare_pages() const
+        {
+            gu::Lock lock(work_mtx_);
+            return spares_.size();
+        }
 
         void meta(const void* const ptr, std::ostream& os)
         {
@@ -127,6 +150,7 @@ namespace gcache
         typedef std::pair<const void*, Plain> PlainMapEntry;
 
         std::string const base_name_; /* /.../.../gcache.page. */
+        std::string const spare_base_name_; /* /.../.../gcache.spare. */
         wsrep_encrypt_cb_t const encrypt_cb_;
         void* const       app_ctx_;   /* context for encryption callback */
         Page::EncKey      enc_key_;   /* current key */
@@ -142,15 +166,36 @@ namespace gcache
         typedef std::map<const void*, Plain> PlainMap;
         PlainMap          enc2plain_;
         size_t            plaintext_size_; /* how much plaintext allocated */
-        pthread_attr_t    delete_page_attr_;
-#ifndef GCACHE_DETACH_THREAD
-        pthread_t         delete_thr_;
-#endif /* GCACHE_DETACH_THREAD */
+
+        /* Page file creation and deletion is done by a background worker
+         * thread. It keeps up to prealloc_ spare page files of page_size_
+         * created (and prefaulted with gcache.populate) once the store
+         * starts being used, new_page() just renames one of them. Members
+         * below are protected by work_mtx_. */
+        typedef std::pair<std::string, size_t> Spare; /* file name, size */
+        gu::Mutex mutable work_mtx_;
+        gu::Cond          work_cond_;
+        std::deque<Page*> work_delete_; /* pages to unmap and remove */
+        std::deque<Spare> spares_;      /* ready spare files */
+        size_t            spare_count_; /* counter for spare file names */
+        size_t            spare_size_;  /* page_size_ copy for the worker */
+        size_t            prealloc_;    /* how many spares to keep */
+        int               spare_node_;  /* NUMA node for the worker */
+        bool              spare_active_;/* page store has been used */
+        bool              work_stop_;
+        gu_thread_t       worker_thr_;
+        MapOptions        map_opts_;
         int               debug_;
         bool        const keep_page_; /* whether to keep the last page */
 
         void new_page    (size_type size, const Page::EncKey& k);
 
+        /* renames a ready spare file to name if there is one */
+        void claim_spare (const std::string& name);
+
+        static void* worker_thread(void* arg);
+        void worker();
+
         // returns true if a page could be deleted
         bool delete_page ();
 
@@ -18,12 +18,22 @@ static const std::string GCACHE_PARAMS_KEEP_PAGES_SIZE("gcache.keep_pages_size")
 static const std::string GCACHE_DEFAULT_KEEP_PAGES_SIZE("0");
 static const std::string GCACHE_PARAMS_KEEP_PLAINTEXT_SIZE
     ("gcache.keep_plaintext_size");
+static const std::string GCACHE_PARAMS_PAGE_PREALLOC ("gcache.page_prealloc");
+static const std::string GCACHE_DEFAULT_PAGE_PREALLOC("1");
 #ifndef NDEBUG
 static const std::string GCACHE_PARAMS_DEBUG      ("gcache.debug");
 static const std::string GCACHE_DEFAULT_DEBUG     ("0");
 #endif
 static const std::string GCACHE_PARAMS_RECOVER    ("gcache.recover");
 static const std::string GCACHE_DEFAULT_RECOVER   ("yes");
+static const std::string GCACHE_PARAMS_HUGEPAGES  ("gcache.hugepages");
+static const std::string GCACHE_DEFAULT_HUGEPAGES ("no");
+static const std::string GCACHE_PARAMS_POPULATE   ("gcache.populate");
+static const std::string GCACHE_DEFAULT_POPULATE  ("no");
+static const std::string GCACHE_PARAMS_MLOCK      ("gcache.mlock");
+static const std::string GCACHE_DEFAULT_MLOCK     ("no");
+static const std::string GCACHE_PARAMS_NUMA_BIND  ("gcache.numa_bind");
+static const std::string GCACHE_DEFAULT_NUMA_BIND ("no");
 
 const std::string&
 gcache::GCache::PARAMS_DIR                 (GCACHE_PARAMS_DIR);
@@ -45,11 +55,21 @@ gcache::GCache::Params::register_params(gu::Config& cfg)
             gu::Config::Flag::type_integer);
     cfg.add(GCACHE_PARAMS_KEEP_PLAINTEXT_SIZE,
             gu::Config::Flag::type_integer);
+    cfg.add(GCACHE_PARAMS_PAGE_PREALLOC, GCACHE_DEFAULT_PAGE_PREALLOC,
+            gu::Config::Flag::type_integer);
 #ifndef NDEBUG
     cfg.add(GCACHE_PARAMS_DEBUG,           GCACHE_DEFAULT_DEBUG);
 #endif
     cfg.add(GCACHE_PARAMS_RECOVER, GCACHE_DEFAULT_RECOVER,
             gu::Config::Flag::read_only | gu::Config::Flag::type_bool);
+    cfg.add(GCACHE_PARAMS_HUGEPAGES, GCACHE_DEFAULT_HUGEPAGES,
+            gu::Config::Flag::read_only | gu::Config::Flag::type_bool);
+    cfg.add(GCACHE_PARAMS_POPULATE, GCACHE_DEFAULT_POPULATE,
+            gu::Config::Flag::read_only | gu::Config::Flag::type_bool);
+    cfg.add(GCACHE_PARAMS_MLOCK, GCACHE_DEFAULT_MLOCK,
+            gu::Config::Flag::read_only | gu::Config::Flag::type_bool);
+    cfg.add(GCACHE_PARAMS_NUMA_BIND, GCACHE_DEFAULT_NUMA_BIND,
+            gu::Config::Flag::read_only | gu::Config::Flag::type_bool);
 }
 
 static const std::string
@@ -85,13 +105,20 @@ gcache::GCache::Params::Params (gu::Config& cfg, const std::string& data_dir)
     page_size_(cfg.get<size_t>(GCACHE_PARAMS_PAGE_SIZE)),
     keep_pages_size_(cfg.get<size_t>(GCACHE_PARAMS_KEEP_PAGES_SIZE)),
     keep_plaintext_size_(page_size_), /* default to page_size_ */
+    page_prealloc_(cfg.get<size_t>(GCACHE_PARAMS_PAGE_PREALLOC)),
 #ifndef NDEBUG
     debug_    (cfg.get<int>(GCACHE_PARAMS_DEBUG)),
 #else
     debug_    (0),
 #endif
-    recover_  (cfg.get<bool>(GCACHE_PARAMS_RECOVER))
+    recover_  (cfg.get<bool>(GCACHE_PARAMS_RECOVER)),
+    numa_bind_(cfg.get<bool>(GCACHE_PARAMS_NUMA_BIND)),
+    map_opts_ ()
 {
+    map_opts_.hugepages = cfg.get<bool>(GCACHE_PARAMS_HUGEPAGES);
+    map_opts_.populate  = cfg.get<bool>(GCACHE_PARAMS_POPULATE);
+    map_opts_.lock      = cfg.get<bool>(GCACHE_PARAMS_MLOCK);
+
     try
     {
         keep_plaintext_size_ = cfg.get<size_t>
@@ -174,6 +201,25 @@ gcache::GCache::param_set (const std::string& key, const std::string& val)
         params.keep_plaintext_size(tmp_size);
         ps.set_keep_plaintext_size(params.keep_plaintext_size());
     }
+    else if (key == GCACHE_PARAMS_HUGEPAGES ||
+             key == GCACHE_PARAMS_POPULATE  ||
+             key == GCACHE_PARAMS_MLOCK     ||
+             key == GCACHE_PARAMS_NUMA_BIND)
+    {
+        gu_throw_error(EPERM) << "Can't change '" << key << "' in runtime.";
+    }
+    else if (key == GCACHE_PARAMS_PAGE_PREALLOC)
+    {
+        size_t tmp_n = gu::Config::from_config<size_t>(val);
+
+        gu::Lock lock(mtx);
+        /* locking here serves two purposes: ensures atomic setting of config
+         * and params.page_prealloc and syncs with new_page() on malloc() */
+
+        config.set<size_t>(key, tmp_n);
+        params.page_prealloc(tmp_n);
+        ps.set_prealloc(params.page_prealloc());
+    }
     else if (key == GCACHE_PARAMS_RECOVER)
     {
         gu_throw_error(EINVAL) << "'" << key
@@ -13,8 +13,16 @@
 #include <gu_hexdump.hpp>
 #include <gu_hash.h>
 
+#include <gu_lock.hpp>
+#include <gu_thread_keys.hpp>
+
+#include <algorithm>
 #include <cassert>
+#include <fstream>
 #include <iostream> // std::cerr
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace gcache
 {
@@ -26,15 +34,23 @@ namespace gcache
     void
     RingBuffer::reset()
     {
+        ++generation_;
         write_preamble(false);
 
         for (seqno2ptr_iter_t i = seqno2ptr_.begin(); i != seqno2ptr_.end(); ++i)
         {
-            if (ptr2BH(*i)->ctx == BH_ctx_t(this)) {
+            BufferHeader* const bh(ptr2BH(*i));
+            if (bh->ctx == BH_ctx_t(this) || dormant(bh)) {
                 seqno2ptr_.erase(i);
             }
         }
 
+        dormant_ = false;
+        index_ctx_.clear();
+        index_fresh_.clear();
+        index_log_.clear();
+        index_log(SEQNO_ILL, -1);
+
         first_ = start_;
         next_  = start_;
 
@@ -57,7 +73,8 @@ namespace gcache
                             seqno2ptr_t&       seqno2ptr,
                             gu::UUID&          gid,
                             int const          dbg,
-                            bool const         recover)
+                            bool const         recover,
+                            const MapOptions&  map_opts)
     :
         pcb_       (pcb),
         fd_        (name, check_size(size)),
@@ -77,19 +94,66 @@ namespace gcache
 //        mallocs_   (0),
 //        reallocs_  (0),
         debug_     (dbg & DEBUG),
-        open_      (true)
+        open_      (true),
+        index_name_(name + ".idx"),
+        index_ctx_ (),
+        generation_(0),
+        index_bytes_(0),
+        dormant_   (false),
+        index_fresh_(),
+        index_log_ (),
+        index_mtx_ (gu::get_mutex_key(gu::GU_MUTEX_KEY_GCACHE_RB_INDEX)),
+        index_cond_(gu::get_cond_key(gu::GU_COND_KEY_GCACHE_RB_INDEX)),
+        index_head_(),
+        index_logs_(),
+        index_busy_(false),
+        index_stop_(false),
+        index_thr_ (),
+        index_map_ (SEQNO_NONE)
     {
         assert((uintptr_t(start_) % MemOps::ALIGNMENT) == 0);
         constructor_common ();
+        map_opts.apply(mmap_);
         open_preamble(recover);
         BH_clear (BH_cast(next_));
+
+        /* recovered seqnos for the first checkpoint */
+        index_log_.clear();
+        for (seqno2ptr_t::iterator i(seqno2ptr_.begin());
+             i != seqno2ptr_.end(); ++i)
+        {
+            const uint8_t* const ptr(static_cast<const uint8_t*>(*i));
+
+            if (ptr >= start_ && ptr < end_)
+            {
+                index_log(seqno2ptr_.index(i),
+                          reinterpret_cast<const uint8_t*>(ptr2BH(ptr)) -
+                          start_);
+            }
+        }
+
+        int const err(gu_thread_create(
+                          gu::get_thread_key(gu::GU_THREAD_KEY_GCACHE_RB_INDEX),
+                          &index_thr_, index_thread, this));
+        if (0 != err)
+        {
+            gu_throw_error(err) << "Failed to create seqno index thread";
+        }
     }
 
     RingBuffer::~RingBuffer ()
     {
+        {
+            gu::Lock lock(index_mtx_);
+            index_stop_ = true;
+            index_cond_.broadcast();
+        }
+        gu_thread_join(index_thr_, NULL);
+
         close_preamble();
         open_ = false;
         mmap_.sync();
+        write_index(true);
     }
 
     static inline void
@@ -116,7 +180,7 @@ namespace gcache
             /* advance i to next set element skipping holes */
             do { ++i; } while ( i != i_end && !*i);
 
-            BufferHeader* const bh(ptr2BH(*j));
+            BufferHeader* const bh(revive(ptr2BH(*j)));
 
             if (gu_likely (BH_is_released(bh)))
             {
@@ -194,7 +258,7 @@ namespace gcache
 
         while (size_t(first_ - ret) < size_next) {
             // try to discard first buffer to get more space
-            BufferHeader* bh = BH_cast(first_);
+            BufferHeader* bh = revive(BH_cast(first_));
 
             if (!BH_is_released(bh) /* true also when first_ == next_ */ ||
                 (bh->seqno_g > 0 && !discard_seqno (bh->seqno_g)))
@@ -210,6 +274,11 @@ namespace gcache
             /* buffer is either discarded already, or it must have seqno */
             assert (SEQNO_ILL == bh->seqno_g);
 
+            if (!index_fresh_.empty() && index_fresh_.front() == bh)
+            {
+                index_fresh_.pop_front();
+            }
+
             first_ += BH_offset(bh);
             assert_size_free();
 
@@ -255,6 +324,7 @@ namespace gcache
 
     found_space:
         assert((uintptr_t(ret) % MemOps::ALIGNMENT) == 0);
+        if (ret < next_) ++header_[HEADER_WRAPS]; // rollover
         size_used_ += alloc_size;
         assert (size_used_ <= size_cache_);
         assert (size_free_ >= alloc_size);
@@ -291,7 +361,19 @@ namespace gcache
             BH_assert_clear(BH_cast(next_));
 //            mallocs_++;
 
-            if (gu_likely (0 != bh)) ret = bh + 1;
+            if (gu_likely (0 != bh))
+            {
+                ret = bh + 1;
+
+                index_settle();
+                index_fresh_.push_back(bh);
+
+                index_bytes_ += aligned_size(size);
+                if (gu_unlikely(index_bytes_ > size_cache_ / INDEX_INTERVAL))
+                {
+                    write_index_async();
+                }
+            }
         }
 
         assert_sizes();
@@ -358,6 +440,7 @@ namespace gcache
                 }
                 else // adjacent buffer allocation failed, return it back
                 {
+                    if (adj_buf) --header_[HEADER_WRAPS]; // undo rollover
                     next_ = adj_ptr;
                     BH_clear (BH_cast(next_));
                     size_used_ -= adj_size;
@@ -413,10 +496,37 @@ namespace gcache
     void
     RingBuffer::seqno_reset()
     {
+        ++generation_;
         write_preamble(false);
 
+        /* seqnos are invalidated below */
+        index_log_.clear();
+        index_log(SEQNO_ILL, -1);
+
         if (size_cache_ == size_free_) return;
 
+        if (dormant_)
+        {
+            /* history is going away anyway, take over all the buffers to
+             * proceed as usual */
+            BufferHeader* bh(BH_cast(first_));
+            while (bh != BH_cast(next_))
+            {
+                if (gu_likely(bh->size > 0))
+                {
+                    revive(bh);
+                    bh = BH_next(bh);
+                }
+                else
+                {
+                    bh = BH_cast(start_); // rollover
+                }
+            }
+
+            dormant_ = false;
+            index_ctx_.clear();
+        }
+
         /* Invalidate seqnos for all ordered buffers (so that they can't be
          * recovered on restart. Also find the last seqno'd RB buffer. */
         BufferHeader* bh(0);
@@ -498,6 +608,10 @@ namespace gcache
         long total(1);
         long locked(0);
 
+        /* unordered buffers from the new configuration */
+        index_fresh_.clear();
+        index_fresh_.push_back(bh);
+
         bh = BH_next(bh);
 
         while (bh != BH_cast(next_))
@@ -518,6 +632,7 @@ namespace gcache
                 else
                 {
                     assert(!BH_is_released(bh));
+                    index_fresh_.push_back(bh);
                 }
 
                 bh = BH_next(bh);
@@ -556,6 +671,7 @@ namespace gcache
     std::string const RingBuffer::PR_KEY_SEQNO_MIN = "seqno_min:";
     std::string const RingBuffer::PR_KEY_OFFSET    = "offset:";
     std::string const RingBuffer::PR_KEY_SYNCED    = "synced:";
+    std::string const RingBuffer::PR_KEY_GENERATION= "generation:";
 
     void
     RingBuffer::write_preamble(bool const synced)
@@ -587,6 +703,7 @@ namespace gcache
         }
 
         os << PR_KEY_SYNCED << ' ' << synced << '\n';
+        os << PR_KEY_GENERATION << ' ' << generation_ << '\n';
         os << '\n';
 
         ::memset(preamble_, '\0', PREAMBLE_LEN);
@@ -608,6 +725,7 @@ namespace gcache
         long long seqno_min(SEQNO_ILL);
         off_t offset(-1);
         bool  synced(false);
+        long long generation(0);
 
         {
             std::istringstream iss(preamble_);
@@ -630,6 +748,7 @@ namespace gcache
                 else if (PR_KEY_SEQNO_MIN == key) istr >> seqno_min;
                 else if (PR_KEY_OFFSET    == key) istr >> offset;
                 else if (PR_KEY_SYNCED    == key) istr >> synced;
+                else if (PR_KEY_GENERATION== key) istr >> generation;
             }
         }
 
@@ -654,7 +773,11 @@ namespace gcache
                  << "\nUUID: " << gid_
                  << "\nSeqno: " << seqno_min << " - " << seqno_max
                  << "\nOffset: " << offset
-                 << "\nSynced: " << synced;
+                 << "\nSynced: " << synced
+                 << "\nGeneration: " << generation;
+
+        /* index files of this and previous runs must not be confused */
+        generation_ = generation + 1;
 
         if (do_recover)
         {
@@ -665,7 +788,10 @@ namespace gcache
 
                 try
                 {
-                    recover(offset - (start_ - preamble), version);
+                    if (!load_index(generation))
+                    {
+                        recover(offset - (start_ - preamble), version);
+                    }
                 }
                 catch (gu::Exception& e)
                 {
@@ -709,6 +835,184 @@ namespace gcache
         ProgressCallback* pcb_;
     };
 
+    /* true if ptr points at a valid buffer header followed by another one
+     * within segment_end */
+    static inline bool
+    scan_buffer_test(const uint8_t* const ptr, const uint8_t* const segment_end)
+    {
+        const BufferHeader* const bh(BH_const_cast(ptr));
+        if (!BH_test(bh) || bh->size == 0) return false;
+
+        const uint8_t* const next(ptr + RingBuffer::aligned_size(bh->size));
+        return (next <= segment_end && BH_test(next));
+    }
+
+    size_t RingBuffer::prescan_segment_min_ = (1 << 26); // 64M
+
+    namespace
+    {
+        struct Prescan
+        {
+            Prescan(const uint8_t* const l, int const s)
+                : limit(l), step(s),
+                  mtx(gu::get_mutex_key(gu::GU_MUTEX_KEY_GCACHE_PRESCAN)),
+                  cond(gu::get_cond_key(gu::GU_COND_KEY_GCACHE_PRESCAN)),
+                  done(0), running(0)
+            {}
+
+            const uint8_t* const limit;   // segment_end of the scan
+            int            const step;
+            gu::Mutex            mtx;
+            gu::Cond             cond;    // signaled on progress and exit
+            ptrdiff_t            done;    // bytes covered by all segments
+            int                  running; // threads still running
+
+            void report(ptrdiff_t const bytes, bool const exiting)
+            {
+                gu::Lock lock(mtx);
+                done += bytes;
+                if (exiting) --running;
+                cond.signal();
+            }
+        };
+
+        struct PrescanSegment
+        {
+            Prescan*       ctx;
+            const uint8_t* begin;
+            const uint8_t* end;
+            size_t         buffers;
+            gu_thread_t    thread;
+        };
+
+        /* Resyncs on the first aligned buffer header starting a valid chain
+         * and walks the chain until it leaves the segment or ends. This is
+         * read-only, so it does not matter if the chain is false or gets
+         * into another segment: it only faults the headers in for scan(). */
+        void* prescan_segment(void* const arg)
+        {
+            /* give up on segments that are mostly free space */
+            static ptrdiff_t const RESYNC_MAX(1 << 20);
+            static ptrdiff_t const REPORT_INTERVAL(1 << 22);
+
+            PrescanSegment& s(*static_cast<PrescanSegment*>(arg));
+            Prescan&        p(*s.ctx);
+            const uint8_t*  ptr(s.begin);
+            const uint8_t*  reported(ptr);
+            const uint8_t*  const resync_end
+                (s.end - s.begin > RESYNC_MAX ? s.begin + RESYNC_MAX : s.end);
+
+            while (ptr < resync_end && !scan_buffer_test(ptr, p.limit))
+            {
+                ptr += p.step;
+            }
+
+            if (ptr < resync_end)
+            {
+                while (ptr < s.end && scan_buffer_test(ptr, p.limit))
+                {
+                    ptr += RingBuffer::aligned_size(BH_const_cast(ptr)->size);
+                    s.buffers++;
+
+                    if (ptr - reported >= REPORT_INTERVAL && ptr < s.end)
+                    {
+                        p.report(ptr - reported, false);
+                        reported = ptr;
+                    }
+                }
+            }
+
+            p.report(s.end - reported, true);
+
+            return NULL;
+        }
+    }
+
+    /* With multi-gigabyte ring buffers the recovery scan is dominated by
+     * faulting in the buffer headers. That is done here concurrently in
+     * segments, so that the serial scan() that follows, and that must
+     * process the buffers in order, walks memory that is already mapped.
+     * This is I/O bound, so the number of threads is not limited by CPUs. */
+    void
+    RingBuffer::prescan(int const scan_step) const
+    {
+        static size_t const THREADS_MAX(8);
+
+        size_t const size(end_ - start_);
+        size_t n(std::min(THREADS_MAX, size / prescan_segment_min_));
+
+        if (n < 2) return;
+
+        /* segment boundaries are aligned to scan step */
+        size_t const seg_size((size / n) / scan_step * scan_step);
+        const uint8_t* const limit(end_ - sizeof(BufferHeader));
+
+        Prescan ctx(limit, scan_step);
+
+        std::vector<PrescanSegment> segs(n);
+
+        for (size_t i(0); i < n; ++i)
+        {
+            PrescanSegment& s(segs[i]);
+            s.ctx     = &ctx;
+            s.begin   = start_ + i * seg_size;
+            s.end     = (i + 1 < n ? s.begin + seg_size : limit);
+            s.buffers = 0;
+        }
+
+        recover_progress_callback<ptrdiff_t> prescan_progress_callback(pcb_);
+        gu::Progress<ptrdiff_t> progress(&prescan_progress_callback,
+                                         "GCache::RingBuffer parallel prescan",
+                                         " bytes", limit - start_,
+                                         1<<22/*4Mb*/);
+
+        size_t started(0);
+        for (; started < n; ++started)
+        {
+            {
+                gu::Lock lock(ctx.mtx);
+                ++ctx.running;
+            }
+            int const err(gu_thread_create(
+                              gu::get_thread_key(
+                                  gu::GU_THREAD_KEY_GCACHE_PRESCAN),
+                              &segs[started].thread, prescan_segment,
+                              &segs[started]));
+            if (err)
+            {
+                gu::Lock lock(ctx.mtx);
+                --ctx.running;
+                log_warn << "Failed to start GCache prescan thread: " << err
+                         << " (" << strerror(err) << "). Skipping prescan.";
+                break;
+            }
+        }
+
+        {
+            ptrdiff_t reported(0);
+            gu::Lock lock(ctx.mtx);
+            for (;;)
+            {
+                progress.update(ctx.done - reported);
+                reported = ctx.done;
+                if (0 == ctx.running) break;
+                lock.wait(ctx.cond);
+            }
+        }
+
+        size_t buffers(0);
+        for (size_t i(0); i < started; ++i)
+        {
+            gu_thread_join(segs[i].thread, NULL);
+            buffers += segs[i].buffers;
+        }
+
+        progress.finish();
+
+        log_info << "GCache::RingBuffer prescan: " << buffers
+                 << " buffer headers in " << started << " segments.";
+    }
+
     seqno_t
     RingBuffer::scan(off_t const offset, int const scan_step)
     {
@@ -734,6 +1038,8 @@ namespace gcache
                 segment_scans = 1;
         }
 
+        prescan(scan_step);
+
         recover_progress_callback<ptrdiff_t> scan_progress_callback(pcb_);
         gu::Progress<ptrdiff_t> progress(&scan_progress_callback,
                                          "GCache::RingBuffer initial scan",
@@ -747,10 +1053,7 @@ namespace gcache
             bh = BH_cast(ptr);
             size_type bh_offset(BH_offset(bh));
 
-#define GCACHE_SCAN_BUFFER_TEST                                 \
-            (BH_test(bh) && bh->size > 0 &&                     \
-             ptr + bh_offset <= segment_end &&                  \
-             BH_test(BH_cast(ptr + bh_offset)))
+#define GCACHE_SCAN_BUFFER_TEST scan_buffer_test(ptr, segment_end)
 
 #define GCACHE_SCAN_ADVANCE(amount)             \
             ptr += amount;                      \
@@ -1214,6 +1517,653 @@ namespace gcache
         }
     }
 
+    /* Seqno index checkpoint file layout: IndexHeader, index_ctx_ values,
+     * {seqno, offset} pairs of ordered RB buffers. All values are in host
+     * byte order, offsets are relative to start_. */
+    struct IndexHeader
+    {
+        uint64_t  magic;
+        uint64_t  checksum;   // gu_fast_hash64() of the file with 0 here
+        gu_uuid_t gid;
+        int64_t   generation;
+        uint64_t  boot;       // system boot the file was written in
+        int64_t   clean;      // written on shutdown after syncing the cache
+        int64_t   wraps;      // header_[HEADER_WRAPS] at checkpoint
+        int64_t   first;
+        int64_t   next;
+        int64_t   trail;      // rollover point, -1 if first <= next
+        int64_t   tail;       // first buffer not settled at checkpoint
+        int64_t   n_ctx;
+        int64_t   n_seqnos;
+    };
+
+    static uint64_t const INDEX_MAGIC = 0x3130584449434347ULL; // "GCCIDX01"
+
+    /* buffers written before reboot might have been lost with page cache,
+     * index checkpointed before a crash is trusted only within the same boot */
+    static uint64_t
+    boot_id()
+    {
+        std::ifstream ifs("/proc/sys/kernel/random/boot_id");
+        std::string id;
+
+        if (ifs >> id) return gu_fast_hash64(id.data(), id.length());
+
+        return 0;
+    }
+
+    /* header fields describing the current state of the ring */
+    void
+    RingBuffer::index_header(IndexHeader& h) const
+    {
+        ::memset(&h, 0, sizeof(h));
+        h.magic      = INDEX_MAGIC;
+        h.gid        = *gid_.ptr();
+        h.generation = generation_;
+        h.wraps      = header_[HEADER_WRAPS];
+        h.first      = first_ - start_;
+        h.next       = next_  - start_;
+        h.trail      = first_ > next_ ? (end_ - size_trail_) - start_ : -1;
+        h.tail       = h.next;
+        h.n_ctx      = index_ctx_.size() + 1;
+    }
+
+    /* buf has space for the header in front, then ctx and seqnos */
+    static void
+    write_index_file(const std::string& name, std::vector<int64_t>& buf,
+                     IndexHeader& h, bool const clean, bool const debug)
+    {
+        h.checksum = 0;
+        size_t const size(buf.size() * sizeof(int64_t));
+        ::memcpy(buf.data(), &h, sizeof(h));
+        h.checksum = gu_fast_hash64(buf.data(), size);
+        ::memcpy(buf.data(), &h, sizeof(h));
+
+        std::string const tmp_name(name + ".tmp");
+
+        int const fd(::open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                            S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP));
+        bool ok(fd >= 0);
+
+        if (ok)
+        {
+            ok = (ssize_t(size) == ::write(fd, buf.data(), size)) &&
+                (!clean || 0 == ::fsync(fd));
+            ok = (0 == ::close(fd)) && ok;
+        }
+
+        if (ok && 0 == ::rename(tmp_name.c_str(), name.c_str()))
+        {
+            if (debug)
+            {
+                log_info << "GCache DEBUG: checkpointed " << h.n_seqnos
+                         << " seqnos to " << name;
+            }
+        }
+        else
+        {
+            int const err(errno);
+            ::unlink(tmp_name.c_str());
+            log_warn << "Failed to write GCache ring buffer seqno index '"
+                     << name << "': " << err << " (" << ::strerror(err)
+                     << "). Next recovery may need a full scan.";
+        }
+    }
+
+    /* Writes the index from the live map, only on shutdown */
+    void
+    RingBuffer::write_index(bool const clean)
+    {
+        index_bytes_ = 0;
+
+        /* too many generations of dormant buffers, do full scan next time */
+        if (index_ctx_.size() >= INDEX_CTX_MAX) return;
+
+        IndexHeader h;
+        index_header(h);
+        h.boot  = boot_id();
+        h.clean = clean;
+
+        /* buffers that are not ordered yet may still get a seqno after the
+         * checkpoint, so recovery has to verify everything from the first
+         * of them */
+        int rollovers(0);
+        for (BufferHeader* bh(BH_cast(first_)); bh != BH_cast(next_);)
+        {
+            if (gu_likely(bh->size > 0))
+            {
+                if (SEQNO_NONE == bh->seqno_g && !dormant(bh))
+                {
+                    h.tail = reinterpret_cast<uint8_t*>(bh) - start_;
+                    break;
+                }
+                bh = BH_next(bh);
+            }
+            else
+            {
+                bh = BH_cast(start_); // rollover
+                ++rollovers;
+            }
+
+            if (gu_unlikely(bh >= BH_cast(end_) || rollovers > 1))
+            {
+                log_warn << "Corrupt GCache ring buffer chain, not "
+                    "checkpointing seqno index.";
+                return;
+            }
+        }
+
+        std::vector<int64_t> buf(sizeof(h) / sizeof(int64_t));
+
+        buf.insert(buf.end(), index_ctx_.begin(), index_ctx_.end());
+        buf.push_back(BH_ctx_t(this));
+
+        for (seqno2ptr_t::iterator i(seqno2ptr_.begin());
+             i != seqno2ptr_.end(); ++i)
+        {
+            const uint8_t* const ptr(static_cast<const uint8_t*>(*i));
+
+            if (ptr >= start_ && ptr < end_) // don't touch buffer headers
+            {
+                buf.push_back(seqno2ptr_.index(i));
+                buf.push_back(reinterpret_cast<const uint8_t*>(ptr2BH(ptr)) -
+                              start_);
+                ++h.n_seqnos;
+            }
+        }
+
+        write_index_file(index_name_, buf, h, clean, debug_);
+    }
+
+    /* Hands a snapshot of ring state and the log of seqno changes over to
+     * index_thr_. Takes constant time, called from malloc(). */
+    void
+    RingBuffer::write_index_async()
+    {
+        index_bytes_ = 0;
+
+        IndexHeader h;
+        index_header(h);
+
+        /* recovery verifies everything from the first buffer that may still
+         * get a seqno after the checkpoint */
+        if (!index_fresh_.empty())
+        {
+            h.tail = reinterpret_cast<uint8_t*>(index_fresh_.front()) - start_;
+        }
+
+        std::vector<int64_t> head(sizeof(h) / sizeof(int64_t));
+        ::memcpy(head.data(), &h, sizeof(h));
+        head.insert(head.end(), index_ctx_.begin(), index_ctx_.end());
+        head.push_back(BH_ctx_t(this));
+
+        gu::Lock lock(index_mtx_);
+        index_head_.swap(head);
+        index_logs_.push_back(std::deque<int64_t>());
+        index_logs_.back().swap(index_log_);
+        index_cond_.broadcast();
+    }
+
+    /* moves ordered and discarded buffers from the front of index_fresh_,
+     * a few at a time so that malloc() time stays constant */
+    void
+    RingBuffer::index_settle()
+    {
+        for (int n(0); n < INDEX_SETTLE_STEP && !index_fresh_.empty(); ++n)
+        {
+            const BufferHeader* const bh(index_fresh_.front());
+
+            if (SEQNO_NONE == bh->seqno_g) break;
+
+            if (bh->seqno_g > 0)
+            {
+                index_log(bh->seqno_g,
+                          reinterpret_cast<const uint8_t*>(bh) - start_);
+            }
+
+            index_fresh_.pop_front();
+        }
+    }
+
+    void*
+    RingBuffer::index_thread(void* const arg)
+    {
+        static_cast<RingBuffer*>(arg)->index_worker();
+        return NULL;
+    }
+
+    void
+    RingBuffer::index_worker()
+    {
+        for (;;)
+        {
+            std::vector<int64_t> buf;
+            std::vector<std::deque<int64_t> > logs;
+            {
+                gu::Lock lock(index_mtx_);
+
+                index_busy_ = false;
+                index_cond_.broadcast();
+
+                while (index_head_.empty() && !index_stop_)
+                {
+                    lock.wait(index_cond_);
+                }
+
+                /* pending checkpoint is superseded by the one on shutdown */
+                if (index_stop_) return;
+
+                buf.swap(index_head_);
+                logs.swap(index_logs_);
+                index_busy_ = true;
+            }
+
+            for (size_t l(0); l < logs.size(); ++l)
+            {
+                const std::deque<int64_t>& log(logs[l]);
+
+                for (size_t i(0); i < log.size(); i += 2)
+                {
+                    seqno_t const seqno(log[i]);
+                    int64_t const off(log[i + 1]);
+
+                    if (SEQNO_ILL == seqno)
+                    {
+                        index_map_.clear(SEQNO_NONE);
+                    }
+                    else if (off >= 0)
+                    {
+                        index_map_.insert(seqno, start_ + off);
+                    }
+                    else if (seqno >= index_map_.index_begin() &&
+                             seqno <  index_map_.index_end())
+                    {
+                        index_map_.erase(seqno);
+                    }
+                }
+            }
+
+            IndexHeader h;
+            ::memcpy(&h, buf.data(), sizeof(h));
+
+            /* too many generations of dormant buffers, do full scan next
+             * time */
+            if (h.n_ctx > int64_t(INDEX_CTX_MAX)) continue;
+
+            h.boot = boot_id();
+
+            for (seqno2ptr_t::iterator i(index_map_.begin());
+                 i != index_map_.end(); ++i)
+            {
+                if (!*i) continue;
+
+                buf.push_back(index_map_.index(i));
+                buf.push_back(static_cast<const uint8_t*>(*i) - start_);
+                ++h.n_seqnos;
+            }
+
+            write_index_file(index_name_, buf, h, false, debug_);
+        }
+    }
+
+    void
+    RingBuffer::revive_dormant(BufferHeader* const bh)
+    {
+        assert(dormant(bh));
+
+        bh->ctx    = BH_ctx_t(this);
+        bh->flags |= BUFFER_RELEASED; // on recovery no buffer is used
+
+        if (bh->seqno_g > 0)
+        {
+            seqno2ptr_t::const_iterator const i(seqno2ptr_.find(bh->seqno_g));
+            if (i != seqno2ptr_.end() && *i == bh + 1) return;
+        }
+
+        /* anything that is not in the map must be discarded */
+        empty_buffer(bh);
+        discard(bh);
+    }
+
+    /* true if intervals [b1, e1) and [b2, e2) overlap */
+    static inline bool
+    overlap(const uint8_t* const b1, const uint8_t* const e1,
+            const uint8_t* const b2, const uint8_t* const e2)
+    {
+        return (b1 < e2 && b2 < e1);
+    }
+
+    /*
+     * Recovers ring buffer state from the seqno index instead of scanning it.
+     *
+     * Only the buffers allocated or ordered after the last checkpoint are
+     * walked and verified. The rest are left untouched in the state the
+     * previous process left them (dormant) and are taken over by revive()
+     * when first accessed. Returns false if index can't be used.
+     */
+    bool
+    RingBuffer::load_index(int64_t const generation)
+    {
+        static const char* const diag_prefix ="Recovering GCache ring buffer: ";
+
+        std::vector<int64_t> buf;
+        {
+            std::ifstream ifs(index_name_.c_str(), std::ios::binary);
+            if (!ifs) return false;
+
+            ifs.seekg(0, std::ios::end);
+            std::streamoff const size(ifs.tellg());
+            ifs.seekg(0, std::ios::beg);
+
+            if (size < std::streamoff(sizeof(IndexHeader)) ||
+                size % sizeof(int64_t)) return false;
+
+            buf.resize(size / sizeof(int64_t));
+            if (!ifs.read(reinterpret_cast<char*>(buf.data()), size))
+                return false;
+        }
+
+        IndexHeader h;
+        ::memcpy(&h, buf.data(), sizeof(h));
+        reinterpret_cast<IndexHeader*>(buf.data())->checksum = 0;
+
+        size_t const hdr_len(sizeof(h) / sizeof(int64_t));
+        int64_t const wraps(header_[HEADER_WRAPS] - h.wraps);
+
+        if (h.magic != INDEX_MAGIC ||
+            h.checksum != gu_fast_hash64(buf.data(),
+                                         buf.size() * sizeof(int64_t)) ||
+            h.n_ctx < 1 || h.n_ctx > int64_t(INDEX_CTX_MAX) ||
+            h.n_seqnos < 0 ||
+            buf.size() != hdr_len + h.n_ctx + 2*h.n_seqnos)
+        {
+            log_info << diag_prefix << "ignoring corrupt seqno index.";
+            return false;
+        }
+
+        if (gid_ != h.gid || generation != h.generation)
+        {
+            log_info << diag_prefix << "ignoring stale seqno index.";
+            return false;
+        }
+
+        if (!h.clean && (0 == h.boot || boot_id() != h.boot))
+        {
+            log_info << diag_prefix << "ignoring seqno index from before "
+                "reboot.";
+            return false;
+        }
+
+        std::vector<BH_ctx_t> const ctx(buf.begin() + hdr_len,
+                                        buf.begin() + hdr_len + h.n_ctx);
+        BH_ctx_t const last_ctx(ctx.back()); // checkpointing process
+
+        if (std::find(ctx.begin(), ctx.end(), BH_ctx_t(this)) != ctx.end() ||
+            wraps < 0 || wraps > 1)
+        {
+            /* can't tell dormant buffers from ours or where the new ones are*/
+            return false;
+        }
+
+        int64_t const area(end_ - start_);
+        if (h.first < 0 || h.first >= area || h.next < 0 || h.next >= area ||
+            h.tail  < 0 || h.tail  >= area ||
+            (h.first > h.next && (h.trail <= h.first || h.trail >= area)) ||
+            (h.tail > h.next && h.first <= h.next))
+        {
+            log_info << diag_prefix << "ignoring corrupt seqno index.";
+            return false;
+        }
+
+        uint8_t* const c_next(start_ + h.next);
+        uint8_t* const c_tail(start_ + h.tail);
+        uint8_t* const c_trail(h.first > h.next ? start_ + h.trail : NULL);
+
+        struct Walk
+        {
+            static bool valid(const BufferHeader* const bh,
+                              const uint8_t* const end,
+                              const std::vector<BH_ctx_t>& ctx)
+            {
+                return (BH_test(bh) && !BH_is_clear(bh) &&
+                        reinterpret_cast<const uint8_t*>(BH_next(
+                            const_cast<BufferHeader*>(bh))) +
+                        sizeof(BufferHeader) <= end &&
+                        std::find(ctx.begin(), ctx.end(), bh->ctx) !=
+                        ctx.end());
+            }
+        };
+
+        std::vector<BufferHeader*> ordered; // seqno'd after checkpoint
+        std::vector<BH_ctx_t> const last(1, last_ctx);
+
+        /* walk the buffers that were not settled at checkpoint */
+        uint8_t* ptr(c_tail);
+        bool rolled(h.tail <= h.next); // past the rollover before c_next
+        while (ptr != c_next)
+        {
+            BufferHeader* const bh(BH_cast(ptr));
+
+            if (BH_is_clear(bh) && !rolled && ptr == c_trail)
+            {
+                ptr = start_;
+                rolled = true;
+                continue;
+            }
+
+            if (!Walk::valid(bh, end_, ctx) || (rolled && ptr > c_next))
+                return false;
+
+            if (bh->ctx == last_ctx && bh->seqno_g > 0) ordered.push_back(bh);
+
+            ptr = reinterpret_cast<uint8_t*>(BH_next(bh));
+        }
+
+        /* walk the buffers allocated after checkpoint up to the new next_ */
+        uint8_t* fresh_end(NULL);  // end of the segment before rollover
+        while (true)
+        {
+            BufferHeader* const bh(BH_cast(ptr));
+
+            if (BH_is_clear(bh))
+            {
+                if (wraps > 0 && !fresh_end)
+                {
+                    fresh_end = ptr;
+                    ptr = start_;
+                    continue;
+                }
+                break;
+            }
+
+            if (!Walk::valid(bh, end_, last)) return false;
+
+            if (bh->seqno_g > 0) ordered.push_back(bh);
+
+            ptr = reinterpret_cast<uint8_t*>(BH_next(bh));
+        }
+
+        uint8_t* const next(ptr);
+        if (!fresh_end) fresh_end = next;
+
+        /* new buffers must not have overwritten the ones walked first */
+        uint8_t* const a_end(fresh_end + sizeof(BufferHeader));
+        uint8_t* const b_end(wraps > 0 ? next + sizeof(BufferHeader) : start_);
+
+        if (wraps > 0 && next > c_next) return false;
+
+        if (h.tail <= h.next)
+        {
+            if (overlap(c_tail, c_next, start_, b_end)) return false;
+        }
+        else
+        {
+            if (overlap(c_tail, c_trail, c_next, a_end) ||
+                overlap(start_, c_next, start_, b_end)) return false;
+        }
+
+        /* populate seqno2ptr map: checkpointed seqnos except those which were
+         * overwritten by new buffers, then new seqnos */
+        assert(seqno2ptr_.empty());
+
+        for (size_t i(hdr_len + h.n_ctx); i < buf.size(); i += 2)
+        {
+            seqno_t const seqno(buf[i]);
+            int64_t const off(buf[i + 1]);
+
+            if (seqno <= 0 || off < 0 || off >= area ||
+                (off % MemOps::ALIGNMENT))
+            {
+                seqno2ptr_.clear(SEQNO_NONE);
+                log_info << diag_prefix << "ignoring corrupt seqno index.";
+                return false;
+            }
+
+            uint8_t* const bh(start_ + off);
+            uint8_t* const bh_end(bh + sizeof(BufferHeader));
+
+            if (overlap(bh, bh_end, c_next, a_end) ||
+                overlap(bh, bh_end, start_, b_end)) continue;
+
+            seqno2ptr_.insert(seqno, BH_cast(bh) + 1);
+        }
+
+        for (size_t i(0); i < ordered.size(); ++i)
+        {
+            BufferHeader* const bh(ordered[i]);
+            seqno2ptr_t::iterator const p(seqno2ptr_.find(bh->seqno_g));
+
+            if (p != seqno2ptr_.end() && *p && *p != bh + 1 &&
+                ptr2BH(*p)->seqno_g == bh->seqno_g)
+            {
+                seqno2ptr_.clear(SEQNO_NONE);
+                log_info << diag_prefix << "seqno " << bh->seqno_g
+                         << " collision in seqno index.";
+                return false;
+            }
+
+            seqno2ptr_.insert(bh->seqno_g, bh + 1);
+        }
+
+        /* buffers discarded after checkpoint: seqnos are discarded in order
+         * from the front, and from the back on history rollback */
+        while (!seqno2ptr_.empty() &&
+               ptr2BH(seqno2ptr_.front())->seqno_g != seqno2ptr_.index_front())
+        {
+            seqno2ptr_.pop_front();
+        }
+
+        while (!seqno2ptr_.empty() &&
+               ptr2BH(seqno2ptr_.back())->seqno_g != seqno2ptr_.index_back())
+        {
+            seqno2ptr_.pop_back();
+        }
+
+        if (seqno2ptr_.empty()) return false;
+
+        /* find the last gapless seqno sequence */
+        seqno_t const seqno_max(seqno2ptr_.index_back());
+        seqno_t       seqno_min(seqno_max);
+        seqno2ptr_t::reverse_iterator r(seqno2ptr_.rbegin());
+        for (++r; r != seqno2ptr_.rend() && *r; ++r) --seqno_min;
+
+        if (r != seqno2ptr_.rend())
+        {
+            log_info << diag_prefix << "discarding seqnos "
+                     << seqno2ptr_.index_begin() << '-' << seqno_min - 1;
+            seqno2ptr_.erase(seqno2ptr_.begin(), seqno2ptr_.find(seqno_min));
+        }
+
+        /* trim next_: update to the end of the last seqno'd buffer */
+        BufferHeader* bh(ptr2BH(seqno2ptr_.back()));
+        BufferHeader* last_bh(bh);
+        std::vector<BH_ctx_t> all(ctx);
+        all.push_back(BH_ctx_t(this));
+        for (int rollovers(0); bh != BH_cast(next);)
+        {
+            if (gu_likely(bh->size > 0))
+            {
+                if (!Walk::valid(bh, end_, all))
+                {
+                    seqno2ptr_.clear(SEQNO_NONE);
+                    return false;
+                }
+
+                if (bh->seqno_g > 0) last_bh = bh;
+                bh = BH_next(bh);
+            }
+            else if (++rollovers > 1)
+            {
+                seqno2ptr_.clear(SEQNO_NONE);
+                return false;
+            }
+            else
+            {
+                bh = BH_cast(start_);
+            }
+        }
+
+        next_ = reinterpret_cast<uint8_t*>(BH_next(last_bh));
+
+        /* first_ is the oldest recovered buffer in ring order */
+        size_t min_dist(area);
+        for (seqno2ptr_t::iterator i(seqno2ptr_.begin());
+             i != seqno2ptr_.end(); ++i)
+        {
+            if (!*i) continue;
+
+            uint8_t* const p(reinterpret_cast<uint8_t*>(ptr2BH(*i)));
+            size_t const dist(p >= next_ ? p - next_ : p - start_ +
+                              (end_ - next_));
+            if (dist < min_dist)
+            {
+                min_dist = dist;
+                first_   = p;
+            }
+        }
+
+        if (first_ >= next_)
+        {
+            uint8_t* const trail(wraps > 0 ? fresh_end : c_trail);
+
+            if (!trail || first_ >= trail)
+            {
+                seqno2ptr_.clear(SEQNO_NONE);
+                return false;
+            }
+
+            size_trail_ = end_ - trail;
+        }
+        else
+        {
+            size_trail_ = 0;
+        }
+
+        BH_clear(BH_cast(next_));
+
+        estimate_space();
+        size_used_ = 0; // on recovery no buffer is used, see revive()
+
+        index_ctx_ = ctx;
+        dormant_   = true;
+
+        log_info << diag_prefix << "recovered seqnos " << seqno2ptr_.index_front()
+                 << '-' << seqno2ptr_.index_back() << " from seqno index, "
+                 << "verified " << ordered.size() << " new buffers.";
+        log_info << diag_prefix << "free space: "
+                 << size_free_ << '/' << size_cache_;
+
+        assert_sizes();
+
+        if (debug_)
+        {
+            log_info << *this;
+            dump_map();
+        }
+
+        return true;
+    }
+
     static void
     print_chain(const uint8_t* const rb_start, const uint8_t* const chain_start,
                 const uint8_t* const chain_end, size_t const count,
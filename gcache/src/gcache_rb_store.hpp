@@ -10,15 +10,22 @@
 #include "gcache_memops.hpp"
 #include "gcache_bh.hpp"
 #include "gcache_types.hpp"
+#include "gcache_map_opts.hpp"
 
 #include <gu_fdesc.hpp>
 #include <gu_mmap.hpp>
 #include <gu_uuid.hpp>
+#include <gu_lock.hpp>
+#include <gu_threads.h>
 
+#include <deque>
 #include <string>
+#include <vector>
 
 namespace gcache
 {
+    struct IndexHeader;
+
     class RingBuffer : public MemOps
     {
     public:
@@ -29,7 +36,8 @@ namespace gcache
                     seqno2ptr_t&       seqno2ptr,
                     gu::UUID&          gid,
                     int                dbg,
-                    bool               recover);
+                    bool               recover,
+                    const MapOptions&  map_opts = MapOptions());
 
         ~RingBuffer ();
 
@@ -39,6 +47,22 @@ namespace gcache
 
         void  free    (BufferHeader* bh);
 
+        /* true if bh was left over by a previous process and recovered
+         * from the seqno index without being touched (see load_index()) */
+        bool dormant(const BufferHeader* const bh) const
+        {
+            return (gu_unlikely(dormant_) && bh->size > 0 &&
+                    BUFFER_IN_RB == bh->store &&
+                    bh->ctx != reinterpret_cast<BH_ctx_t>(this));
+        }
+
+        /* takes over dormant buffer header before it is used */
+        BufferHeader* revive(BufferHeader* const bh)
+        {
+            if (dormant(bh)) revive_dormant(bh);
+            return bh;
+        }
+
         void repossess(BufferHeader* bh)
         {
             assert(bh->size >= sizeof(BufferHeader));
@@ -59,6 +83,8 @@ namespace gcache
             size_free_ += aligned_size(bh->size);
             assert (size_free_ <= size_cache_);
 
+            if (bh->seqno_g > 0) index_log(bh->seqno_g, -1);
+
             /* so we know that the buffer is no longer in the map and can be
              * overwritten */
             bh->seqno_g = SEQNO_ILL;
@@ -132,6 +158,10 @@ namespace gcache
 
         void set_debug(int const dbg) { debug_ = dbg & DEBUG; }
 
+        gu::MMap&       mmap()       { return mmap_; }
+        const gu::MMap& mmap() const { return mmap_; }
+        int             fd()   const { return fd_.get(); }
+
 #ifdef GCACHE_RB_UNIT_TEST
         ptrdiff_t offset(const void* const ptr) const
         {
@@ -182,6 +212,30 @@ namespace gcache
 
         bool               open_;
 
+        /* seqno index checkpoint */
+        std::string  const index_name_;
+        std::vector<BH_ctx_t> index_ctx_; // ctx of possibly dormant buffers
+        int64_t            generation_; // invalidates older index files
+        size_t             index_bytes_; // allocated since last checkpoint
+        bool               dormant_;
+
+        /* Periodic checkpoints are written by index_thr_, so that malloc()
+         * walks neither the ring nor the seqno map. Buffers allocated by
+         * malloc() wait in index_fresh_ until they are ordered or discarded,
+         * their seqnos are then logged to index_log_ along with the seqnos
+         * of discarded buffers. The thread applies the log to its own copy
+         * of the ring buffer part of the map. */
+        std::deque<BufferHeader*> index_fresh_; // in allocation order
+        std::deque<int64_t>  index_log_;  // {seqno, offset}, -1: discarded
+        gu::Mutex            index_mtx_;
+        gu::Cond             index_cond_;
+        std::vector<int64_t> index_head_; // header and ctx of next checkpoint
+        std::vector<std::deque<int64_t> > index_logs_; // not applied yet
+        bool                 index_busy_;
+        bool                 index_stop_;
+        gu_thread_t          index_thr_;
+        seqno2ptr_t          index_map_;  // owned by index_thr_
+
         BufferHeader* get_new_buffer (size_type size);
 
         void          constructor_common();
@@ -193,17 +247,54 @@ namespace gcache
         static std::string const PR_KEY_SEQNO_MIN;
         static std::string const PR_KEY_OFFSET;
         static std::string const PR_KEY_SYNCED;
+        static std::string const PR_KEY_GENERATION;
 
         void          write_preamble(bool synced);
         void          open_preamble(bool recover);
         void          close_preamble();
 
+        // minimum size of a segment walked by a separate prescan() thread
+        static size_t prescan_segment_min_;
+
+        // parallel read-only pass over buffer chains ahead of scan()
+        void          prescan(int scan_step) const;
+
         // returns lower bound (not inclusive) of valid seqno range
         seqno_t       scan(off_t offset, int scan_step);
         void          recover(off_t offset, int version);
 
         void          estimate_space();
 
+        /* header_ slot counting ring rollovers, lets load_index() tell where
+         * the buffers allocated after the last checkpoint may be */
+        static size_t const HEADER_WRAPS = 0;
+
+        // maximum number of previous processes with dormant buffers
+        static size_t const INDEX_CTX_MAX = 16;
+
+        // checkpoint seqno index every size_cache_/INDEX_INTERVAL bytes
+        static size_t const INDEX_INTERVAL = 4;
+
+        // max buffers moved out of index_fresh_ by one malloc()
+        static int    const INDEX_SETTLE_STEP = 4;
+
+        void          index_header(IndexHeader& h) const;
+        void          write_index(bool clean);
+        void          write_index_async();
+        static void*  index_thread(void* arg);
+        void          index_worker();
+        void          index_settle();
+
+        /* seqno SEQNO_ILL clears the index */
+        void          index_log(seqno_t const seqno, int64_t const offset)
+        {
+            index_log_.push_back(seqno);
+            index_log_.push_back(offset);
+        }
+
+        bool          load_index(int64_t generation);
+        void          revive_dormant(BufferHeader* bh);
+
         static inline size_type
         BH_offset(const BufferHeader* bh)
         {
@@ -222,6 +313,16 @@ namespace gcache
 #ifdef GCACHE_RB_UNIT_TEST
     public:
         uint8_t* start() const { return start_; }
+        bool recovered_from_index() const { return dormant_; }
+        size_t index_bytes() const { return index_bytes_; }
+
+        /* waits until the pending checkpoint is written */
+        void index_sync()
+        {
+            gu::Lock lock(index_mtx_);
+            while (index_busy_ || !index_head_.empty()) lock.wait(index_cond_);
+        }
+        static void prescan_segment_min(size_t s) { prescan_segment_min_ = s; }
 #endif
     };
 
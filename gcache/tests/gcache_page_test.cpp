@@ -11,6 +11,8 @@
 
 #include <gu_digest.hpp>
 
+#include <unistd.h> // usleep(), access()
+
 using namespace gcache;
 
 /* helper to switch between encryption and non-encryption modes */
@@ -437,6 +439,119 @@ START_TEST(test4) // check that pages linger correctly and get deleted as they
 }
 END_TEST
 
+// checks that page maps are prefaulted and reported with map options
+START_TEST(test5)
+{
+    log_test(5, false);
+
+    const char* const dir_name = "";
+    ssize_t const page_size = 1 << 20;
+
+    MapOptions opts;
+    opts.hugepages = true;
+    opts.populate  = true;
+
+    gcache::PageStore ps(dir_name, NULL, NULL, 0, page_size, page_size,
+                         PageStore::DEBUG, true, 0, opts);
+    ps.set_enc_key(Key);
+
+    int const node(gu::numa_node());
+    if (node >= 0) ps.set_numa_node(node); // best effort, may only warn
+
+    void* ptx;
+    void* const ptr(ps.malloc(1024, ptx));
+    ck_assert(0 != ptr);
+
+    gu::MemRanges ranges;
+    size_t locked(0);
+    ps.mem_ranges(ranges, locked);
+    ck_assert_msg(ranges.size() == ps.total_pages(),
+                  "Expected %zu ranges, got %zu", ps.total_pages(),
+                  ranges.size());
+    ck_assert(0 == locked);
+
+    for (size_t i(0); i < ranges.size(); ++i)
+    {
+        size_t const resident(gu::mem_resident(ranges[i].first,
+                                               ranges[i].second));
+        ck_assert_msg(resident == ranges[i].second,
+                      "Page %zu: resident %zu, expected %zu", i, resident,
+                      ranges[i].second);
+    }
+
+    size_t const huge(gu::mem_huge(ranges));
+    log_info << "Huge page bytes: " << huge;
+    ck_assert(huge <= ranges.size() * page_size);
+
+    ps_free(ps, ptr2BH(ptr), ptr);
+}
+END_TEST
+
+static bool
+wait_spares(const gcache::PageStore& ps, size_t const n)
+{
+    for (int i(0); i < 1000 && ps.spare_pages() != n; ++i) usleep(10000);
+    return ps.spare_pages() == n;
+}
+
+static bool
+file_exists(const char* const name)
+{
+    return 0 == ::access(name, F_OK);
+}
+
+// checks that new pages are made of spare files prepared in background
+START_TEST(test6)
+{
+    log_test(6, false);
+
+    const char* const dir_name = "";
+    ssize_t const page_size = 1 << 16;
+    size_t  const prealloc = 2;
+
+    gcache::PageStore ps(dir_name, NULL, NULL, 0, page_size, page_size,
+                         PageStore::DEBUG, false, prealloc);
+
+    /* spares are prepared only after the store gets used */
+    usleep(10000);
+    ck_assert(0 == ps.spare_pages());
+
+    void* ptx;
+    void* const ptr1(ps.malloc(page_size / 2, ptx));
+    ck_assert(0 != ptr1);
+    ck_assert(1 == ps.count());
+
+    ck_assert_msg(wait_spares(ps, prealloc), "spares: %zu",ps.spare_pages());
+    ck_assert(file_exists("gcache.spare.000000"));
+    ck_assert(file_exists("gcache.spare.000001"));
+
+    /* does not fit into the first page, takes the first spare */
+    void* const ptr2(ps.malloc(page_size / 2, ptx));
+    ck_assert(0 != ptr2);
+    ck_assert(2 == ps.count());
+    ck_assert(!file_exists("gcache.spare.000000"));
+    ck_assert(file_exists("gcache.page.000001"));
+    ck_assert(!file_exists("gcache.page.000002")); /* spares are not pages */
+
+    ck_assert_msg(wait_spares(ps, prealloc), "spares: %zu",ps.spare_pages());
+    ck_assert(file_exists("gcache.spare.000002"));
+
+    /* pages are removed by the worker */
+    ps_free(ps, ptr2BH(ptr1), ptr1);
+    for (int i(0); i < 1000 && file_exists("gcache.page.000000"); ++i)
+        usleep(10000);
+    ck_assert(!file_exists("gcache.page.000000"));
+    ck_assert(1 == ps.total_pages());
+
+    ps.set_prealloc(0);
+    ck_assert_msg(wait_spares(ps, 0), "spares: %zu", ps.spare_pages());
+    ck_assert(!file_exists("gcache.spare.000001"));
+    ck_assert(!file_exists("gcache.spare.000002"));
+
+    ps_free(ps, ptr2BH(ptr2), ptr2);
+}
+END_TEST
+
 Suite* gcache_page_suite()
 {
     Suite* s = suite_create("gcache::PageStore");
@@ -447,6 +562,8 @@ Suite* gcache_page_suite()
     tcase_add_test(tc, test2);
     tcase_add_test(tc, test3);
     tcase_add_test(tc, test4);
+    tcase_add_test(tc, test5);
+    tcase_add_test(tc, test6);
     suite_add_tcase(s, tc);
 
     return s;
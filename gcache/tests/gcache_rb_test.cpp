@@ -13,6 +13,11 @@
 #include <gu_logger.hpp>
 #include <gu_throw.hpp>
 
+#include <new>
+#include <vector>
+
+#include <time.h> // clock_gettime()
+
 using namespace gcache;
 
 static gu::UUID    const GID(NULL, 0);
@@ -120,7 +125,8 @@ START_TEST(test1)
 }
 END_TEST
 
-START_TEST(recovery)
+static void
+test_recovery()
 {
     struct msg
     {
@@ -503,6 +509,220 @@ START_TEST(recovery)
 
     ::unlink(RB_NAME.c_str());
 }
+
+START_TEST(recovery)
+{
+    test_recovery();
+}
+END_TEST
+
+/* ring buffer instances for seqno index recovery tests, each one at a new
+ * address, as in a new process: buffers left by another instance at the same
+ * address can't be told from our own and index recovery is not attempted */
+struct rb_index_ctx
+{
+    seqno2ptr_t  s2p;
+    gu::UUID     gid;
+    RingBuffer   rb;
+
+    rb_index_ctx(size_t const size) :
+        s2p(SEQNO_NONE), gid(GID),
+        rb(NULL, RB_NAME, size, s2p, gid, 0, true)
+    {}
+
+    /* ordered buffer released by the application */
+    void add(seqno_t const g)
+    {
+        void* const ptr(rb.malloc(ALLOC_SIZE(sizeof(g))));
+        ck_assert(NULL != ptr);
+        ::memcpy(ptr, &g, sizeof(g));
+
+        s2p.insert(g, ptr);
+        ptr2BH(ptr)->seqno_g = g;
+        BH_release(ptr2BH(ptr));
+        rb.free(ptr2BH(ptr));
+    }
+
+    /* offsets of the recovered buffers for comparison */
+    std::vector<std::pair<seqno_t, ptrdiff_t> > map() const
+    {
+        std::vector<std::pair<seqno_t, ptrdiff_t> > ret;
+        for (seqno2ptr_t::const_iterator i(s2p.begin()); i != s2p.end(); ++i)
+        {
+            ck_assert(*i);
+            ck_assert(*static_cast<const seqno_t*>(*i) == s2p.index(i));
+            ret.push_back(std::make_pair(s2p.index(i), rb.offset(*i)));
+        }
+        return ret;
+    }
+};
+
+class rb_index_pool
+{
+    std::vector<void*> mem_;
+public:
+    rb_index_pool() : mem_() {}
+    ~rb_index_pool()
+    {
+        for (size_t i(0); i < mem_.size(); ++i) ::operator delete(mem_[i]);
+    }
+
+    rb_index_ctx* open(size_t const size)
+    {
+        mem_.push_back(::operator new(sizeof(rb_index_ctx)));
+        return new (mem_.back()) rb_index_ctx(size);
+    }
+
+    /* memory is not reused until the pool is destroyed */
+    static void close(rb_index_ctx* const ctx) { ctx->~rb_index_ctx(); }
+};
+
+static std::string const RB_INDEX_NAME(RB_NAME + ".idx");
+
+/* recovery from seqno index after clean shutdown and crash must produce
+ * the same state as full ring buffer scan */
+START_TEST(recovery_index)
+{
+    ::unlink(RB_NAME.c_str());
+    ::unlink(RB_INDEX_NAME.c_str());
+
+    size_t const rb_size(ALLOC_SIZE(sizeof(seqno_t)) * 16);
+    rb_index_pool pool;
+
+    /* allocations trigger a checkpoint every 1/4 of the cache size, the
+     * last one is before seqno 10. Leave an unordered buffer and crash. */
+    rb_index_ctx* const crashed(pool.open(rb_size));
+    ck_assert(!crashed->rb.recovered_from_index());
+    for (seqno_t g(1); g <= 12; ++g) crashed->add(g);
+    ck_assert(NULL != crashed->rb.malloc(ALLOC_SIZE(1)));
+    crashed->rb.index_sync();
+
+    rb_index_ctx* ctx(pool.open(rb_size));
+    ck_assert(ctx->rb.recovered_from_index());
+    ck_assert(ctx->s2p.index_front() == 1);
+    ck_assert(ctx->s2p.index_back()  == 12);
+    ck_assert(ctx->map() == crashed->map());
+
+    /* take over dormant buffers: discard them while wrapping around */
+    for (seqno_t g(13); g <= 30; ++g) ctx->add(g);
+    ck_assert(ctx->s2p.index_back() == 30);
+    ck_assert(ctx->s2p.index_front() > 13);
+    std::vector<std::pair<seqno_t, ptrdiff_t> > const closed(ctx->map());
+    pool.close(ctx);
+
+    ctx = pool.open(rb_size);
+    ck_assert(ctx->rb.recovered_from_index());
+    ck_assert(ctx->map() == closed);
+    pool.close(ctx);
+
+    ::unlink(RB_INDEX_NAME.c_str());
+    ctx = pool.open(rb_size);
+    ck_assert(!ctx->rb.recovered_from_index());
+    ck_assert(ctx->map() == closed);
+
+    /* crash after rolling over past the last checkpoint */
+    rb_index_ctx* const crashed_wrapped(ctx);
+    for (seqno_t g(31); g <= 49; ++g) crashed_wrapped->add(g);
+    std::vector<std::pair<seqno_t, ptrdiff_t> > const wrapped(
+        crashed_wrapped->map());
+    crashed_wrapped->rb.index_sync();
+
+    ctx = pool.open(rb_size);
+    ck_assert(ctx->rb.recovered_from_index());
+    ck_assert(ctx->map() == wrapped);
+    pool.close(ctx);
+
+    ::unlink(RB_INDEX_NAME.c_str());
+    ctx = pool.open(rb_size);
+    ck_assert(!ctx->rb.recovered_from_index());
+    ck_assert(ctx->map() == wrapped);
+    pool.close(ctx);
+
+    pool.close(crashed_wrapped);
+    pool.close(crashed);
+    ::unlink(RB_NAME.c_str());
+    ::unlink(RB_INDEX_NAME.c_str());
+}
+END_TEST
+
+/* same as above, but with the ring buffer split into prescan segments of
+ * a couple of buffers, recovered state must be the same */
+START_TEST(recovery_prescan)
+{
+    RingBuffer::prescan_segment_min(ALLOC_SIZE(1) * 2);
+    test_recovery();
+    RingBuffer::prescan_segment_min(1 << 26);
+}
+END_TEST
+
+/* CPU time spent by this thread in the mallocs which start a seqno index
+ * checkpoint: the best of them, to filter out the noise */
+static long long
+checkpoint_cost(size_t const rb_size, size_type const buf_size)
+{
+    ::unlink(RB_NAME.c_str());
+    ::unlink(RB_INDEX_NAME.c_str());
+
+    long long ret(-1);
+    {
+        seqno2ptr_t s2p(SEQNO_NONE);
+        gu::UUID    gid(GID);
+        RingBuffer  rb(NULL, RB_NAME, rb_size, s2p, gid, 0, false);
+
+        /* wrap around a few times to have the map full */
+        seqno_t g(1);
+        for (size_t allocated(0); allocated < 3 * rb_size;
+             allocated += buf_size, ++g)
+        {
+            size_t const before(rb.index_bytes());
+
+            struct timespec t0, t1;
+            ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+            void* const ptr(rb.malloc(buf_size));
+            ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t1);
+
+            ck_assert(NULL != ptr);
+            s2p.insert(g, ptr);
+            ptr2BH(ptr)->seqno_g = g;
+            BH_release(ptr2BH(ptr));
+            rb.free(ptr2BH(ptr));
+
+            if (rb.index_bytes() < before && allocated > rb_size)
+            {
+                long long const cost((t1.tv_sec - t0.tv_sec) * 1000000000LL +
+                                     (t1.tv_nsec - t0.tv_nsec));
+                if (ret < 0 || cost < ret) ret = cost;
+            }
+        }
+
+        ck_assert(ret >= 0);
+        ck_assert(s2p.size() > rb_size / buf_size / 2);
+        rb.index_sync();
+    }
+
+    ::unlink(RB_NAME.c_str());
+    ::unlink(RB_INDEX_NAME.c_str());
+
+    return ret;
+}
+
+/* checkpoint must not walk the ring buffer or the seqno map in malloc() */
+START_TEST(checkpoint_malloc)
+{
+    size_t    const rb_size(1 << 24);
+    size_type const small_buf(rb_size / 16);
+    size_type const large_buf(ALLOC_SIZE(sizeof(seqno_t)));
+    long long const small(checkpoint_cost(rb_size, small_buf));
+    long long const large(checkpoint_cost(rb_size, large_buf));
+
+    log_info << "checkpointing malloc(): " << small << " ns with "
+             << rb_size / small_buf << " seqnos, " << large << " ns with "
+             << rb_size / large_buf << " seqnos";
+
+    ck_assert_msg(large < 10 * small + 200000,
+                  "checkpointing malloc() took %lld ns with a large map vs. "
+                  "%lld ns with a small one", large, small);
+}
 END_TEST
 
 
@@ -519,6 +739,9 @@ Suite* gcache_rb_suite()
 
     tcase_set_timeout(tc, 60);
     tcase_add_test(tc, recovery);
+    tcase_add_test(tc, recovery_prescan);
+    tcase_add_test(tc, recovery_index);
+    tcase_add_test(tc, checkpoint_malloc);
     suite_add_tcase(ts, tc);
 
     return ts;
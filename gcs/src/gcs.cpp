@@ -1445,6 +1445,9 @@ static void *gcs_recv_thread (void *arg)
     gcs_sm_leave(conn->sm);
     gu_cond_destroy (&tmp_cond);
 
+    /* this thread writes received actions to gcache */
+    gcs_gcache_recv_thread_init(conn->gcache);
+
     while (conn->state < GCS_CONN_CLOSED)
     {
         gcs_seqno_t this_act_id = GCS_SEQNO_ILL;
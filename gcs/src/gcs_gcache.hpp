@@ -75,4 +75,12 @@ gcs_gcache_drop_plaintext (gcache_t* gcache, const void* buf)
 #endif
 }
 
+static inline void
+gcs_gcache_recv_thread_init (gcache_t* gcache)
+{
+#ifndef GCS_FOR_GARB
+    if (gu_likely (gcache != NULL)) gcache_recv_thread_init (gcache);
+#endif
+}
+
 #endif /* _gcs_gcache_h_ */